@@ -0,0 +1,565 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../lib/include/variant.hpp"
+#include "../lib/include/match.hpp"
+#include "../lib/include/option.hpp"
+#include "../lib/include/option_vec.hpp"
+#include "../lib/include/result.hpp"
+#include "../lib/include/self_ref.hpp"
+// Last: with NSTD_TEST, test.hpp opens the private members, later std headers would break.
+#include "../lib/include/bench.hpp"
+
+// The nstd vocabulary types against their std and hand-written equivalents: construction, move,
+// error propagation through call levels, and dispatch over 2 to 30 alternatives.
+// Build with -DNSTD_TEST and run like any bench_main() binary, e.g. --filter vocab_dispatch.
+// The object sizes are printed first, once the options are parsed.
+
+namespace {
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VOCAB_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define VOCAB_NOINLINE __declspec(noinline)
+#else
+#define VOCAB_NOINLINE
+#endif
+
+// What std::expected does, written out: a flag and a union.
+template <typename T, typename E>
+class Expected {
+    bool m_ok;
+    union {
+        T m_value;
+        E m_error;
+    };
+
+public:
+    Expected(const T& value) : m_ok(true), m_value(value) {}
+    struct Unexpected {
+        E error;
+    };
+    Expected(Unexpected u) : m_ok(false), m_error(std::move(u.error)) {}
+    Expected(Expected&& other) noexcept : m_ok(other.m_ok)
+    {
+        if(m_ok) { new(&m_value) T(std::move(other.m_value)); }
+        else { new(&m_error) E(std::move(other.m_error)); }
+    }
+    ~Expected()
+    {
+        if(m_ok) { m_value.~T(); }
+        else { m_error.~E(); }
+    }
+    bool has_value() const noexcept { return m_ok; }
+    T& value() noexcept { return m_value; }
+    E& error() noexcept { return m_error; }
+};
+
+// The values are read from volatile, so the compiler can't fold the calls.
+volatile int g_seed = 7;
+
+// ---- Construction and move ----
+
+BENCH(vocab_construct, result_ok)
+{
+    b = [] {
+        auto r = nstd::Result<int, int>::ok(g_seed);
+        nstd::do_not_optimize(r);
+    };
+}
+
+BENCH(vocab_construct, variant_ok)
+{
+    b = [] {
+        std::variant<int, int> r(std::in_place_index<0>, g_seed);
+        nstd::do_not_optimize(r);
+    };
+}
+
+BENCH(vocab_construct, expected_ok)
+{
+    b = [] {
+        const int seed = g_seed;
+        Expected<int, int> r(seed);
+        nstd::do_not_optimize(r);
+    };
+}
+
+BENCH(vocab_construct, option_some)
+{
+    b = [] {
+        auto o = nstd::Option<int>::some(g_seed);
+        nstd::do_not_optimize(o);
+    };
+}
+
+BENCH(vocab_construct, std_optional)
+{
+    b = [] {
+        std::optional<int> o(g_seed);
+        nstd::do_not_optimize(o);
+    };
+}
+
+BENCH(vocab_move, result_string)
+{
+    b = [] {
+        auto r  = nstd::Result<std::string, int>::ok(16, 'x');
+        auto r2 = std::move(r);
+        nstd::do_not_optimize(r2);
+    };
+}
+
+BENCH(vocab_move, variant_string)
+{
+    b = [] {
+        std::variant<std::string, int> r(std::in_place_index<0>, 16, 'x');
+        auto r2 = std::move(r);
+        nstd::do_not_optimize(r2);
+    };
+}
+
+BENCH(vocab_move, expected_string)
+{
+    b = [] {
+        Expected<std::string, int> r(std::string(16, 'x'));
+        auto r2 = std::move(r);
+        nstd::do_not_optimize(r2);
+    };
+}
+
+BENCH(vocab_move, optional_string)
+{
+    b = [] {
+        std::optional<std::string> o(std::in_place, 16, 'x');
+        auto o2 = std::move(o);
+        nstd::do_not_optimize(o2);
+    };
+}
+
+// ---- Propagation through 4 call levels, every level checks and forwards the error ----
+
+template <int Level>
+VOCAB_NOINLINE nstd::Result<int, int> result_chain(int v)
+{
+    if constexpr(Level == 0)
+    {
+        if(v < 0) { return nstd::Result<int, int>::err(v); }
+        return nstd::Result<int, int>::ok(v + 1);
+    }
+    else
+    {
+        auto r = result_chain<Level - 1>(v);
+        if(r.is_err()) { return r; }
+        return nstd::Result<int, int>::ok(r.unwrap() + 1);
+    }
+}
+
+template <int Level>
+VOCAB_NOINLINE Expected<int, int> expected_chain(int v)
+{
+    using U = typename Expected<int, int>::Unexpected;
+    if constexpr(Level == 0)
+    {
+        if(v < 0) { return U{v}; }
+        return v + 1;
+    }
+    else
+    {
+        auto r = expected_chain<Level - 1>(v);
+        if(!r.has_value()) { return U{r.error()}; }
+        return r.value() + 1;
+    }
+}
+
+// The C way: an error code returned, the value through an out parameter.
+template <int Level>
+VOCAB_NOINLINE int code_chain(int v, int& out)
+{
+    if constexpr(Level == 0)
+    {
+        if(v < 0) { return v; }
+        out = v + 1;
+        return 0;
+    }
+    else
+    {
+        int inner = 0;
+        int rc    = code_chain<Level - 1>(v, inner);
+        if(rc != 0) { return rc; }
+        out = inner + 1;
+        return 0;
+    }
+}
+
+BENCH(vocab_propagate, result)
+{
+    b = [] { nstd::do_not_optimize(result_chain<3>(g_seed)); };
+}
+
+BENCH(vocab_propagate, result_err)
+{
+    b = [] { nstd::do_not_optimize(result_chain<3>(-g_seed)); };
+}
+
+BENCH(vocab_propagate, expected)
+{
+    b = [] { nstd::do_not_optimize(expected_chain<3>(g_seed)); };
+}
+
+BENCH(vocab_propagate, expected_err)
+{
+    b = [] { nstd::do_not_optimize(expected_chain<3>(-g_seed)); };
+}
+
+BENCH(vocab_propagate, error_code)
+{
+    b = [] {
+        int out = 0;
+        nstd::do_not_optimize(code_chain<3>(g_seed, out));
+        nstd::do_not_optimize(out);
+    };
+}
+
+// ---- Dispatch over N alternatives, one call dispatches a batch of BATCH mixed values ----
+
+constexpr std::size_t BATCH = 1024;
+
+template <std::size_t I>
+struct Alt {
+    static constexpr int K = int(I) * 7 + 1;
+    int v;
+};
+
+template <typename Seq>
+struct AltVariant;
+template <std::size_t... Is>
+struct AltVariant<std::index_sequence<Is...>> {
+    using type = nstd::variant<Alt<Is>...>;
+};
+template <std::size_t N>
+using AltVariantT = typename AltVariant<std::make_index_sequence<N>>::type;
+
+struct Base {
+    virtual ~Base() = default;
+    virtual int eval() const noexcept = 0;
+};
+template <std::size_t I>
+struct Derived : Base {
+    int v;
+    explicit Derived(int value) : v(value) {}
+    int eval() const noexcept override { return v + Alt<I>::K; }
+};
+
+// A tag and a value, dispatched by a switch written out for up to 30 tags.
+struct Tagged {
+    int tag;
+    int v;
+};
+
+int eval_switch(const Tagged& t) noexcept
+{
+    switch(t.tag)
+    {
+    case 0: return t.v + Alt<0>::K;
+    case 1: return t.v + Alt<1>::K;
+    case 2: return t.v + Alt<2>::K;
+    case 3: return t.v + Alt<3>::K;
+    case 4: return t.v + Alt<4>::K;
+    case 5: return t.v + Alt<5>::K;
+    case 6: return t.v + Alt<6>::K;
+    case 7: return t.v + Alt<7>::K;
+    case 8: return t.v + Alt<8>::K;
+    case 9: return t.v + Alt<9>::K;
+    case 10: return t.v + Alt<10>::K;
+    case 11: return t.v + Alt<11>::K;
+    case 12: return t.v + Alt<12>::K;
+    case 13: return t.v + Alt<13>::K;
+    case 14: return t.v + Alt<14>::K;
+    case 15: return t.v + Alt<15>::K;
+    case 16: return t.v + Alt<16>::K;
+    case 17: return t.v + Alt<17>::K;
+    case 18: return t.v + Alt<18>::K;
+    case 19: return t.v + Alt<19>::K;
+    case 20: return t.v + Alt<20>::K;
+    case 21: return t.v + Alt<21>::K;
+    case 22: return t.v + Alt<22>::K;
+    case 23: return t.v + Alt<23>::K;
+    case 24: return t.v + Alt<24>::K;
+    case 25: return t.v + Alt<25>::K;
+    case 26: return t.v + Alt<26>::K;
+    case 27: return t.v + Alt<27>::K;
+    case 28: return t.v + Alt<28>::K;
+    case 29: return t.v + Alt<29>::K;
+    }
+    return 0;
+}
+
+// The same pseudo random sequence of alternatives for every kind of dispatch.
+inline std::vector<std::size_t> alt_indexes(std::size_t n)
+{
+    std::vector<std::size_t> idx(BATCH);
+    std::uint32_t x = 2463534242u;
+    for(auto& i : idx)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        i = x % n;
+    }
+    return idx;
+}
+
+template <std::size_t N>
+struct Dispatch {
+    static std::vector<AltVariantT<N>> variants;
+    static std::vector<std::unique_ptr<Base>> objects;
+    static std::vector<nstd::SelfRef<Base>> self_refs;
+
+    template <std::size_t... Is>
+    static void fill(std::index_sequence<Is...>)
+    {
+        using MakeVariant = AltVariantT<N> (*)(int);
+        using MakeObject  = std::unique_ptr<Base> (*)(int);
+        using MakeRef     = nstd::SelfRef<Base> (*)(int);
+        static constexpr MakeVariant make_variant[] = {
+            [](int v) { return AltVariantT<N>(Alt<Is>{v}); }...};
+        static constexpr MakeObject make_object[] = {
+            [](int v) { return std::unique_ptr<Base>(new Derived<Is>(v)); }...};
+        static constexpr MakeRef make_ref[] = {
+            [](int v) { return nstd::make_self_ref<Base, Derived<Is>>(v); }...};
+        variants.clear();
+        objects.clear();
+        self_refs.clear();
+        for(std::size_t i : alt_indexes(N))
+        {
+            variants.push_back(make_variant[i](int(i)));
+            objects.push_back(make_object[i](int(i)));
+            self_refs.push_back(make_ref[i](int(i)));
+        }
+    }
+    static void prepare() { fill(std::make_index_sequence<N>{}); }
+
+    static void match()
+    {
+        int sum = 0;
+        for(const auto& v : variants)
+        {
+            sum += nstd::match(v, [](const auto& a) { return a.v + std::decay_t<decltype(a)>::K; });
+        }
+        nstd::do_not_optimize(sum);
+    }
+    static void visit()
+    {
+        int sum = 0;
+        for(const auto& v : variants)
+        {
+            sum += std::visit([](const auto& a) { return a.v + std::decay_t<decltype(a)>::K; }, v);
+        }
+        nstd::do_not_optimize(sum);
+    }
+    static void virtual_call()
+    {
+        int sum = 0;
+        for(const auto& o : objects) { sum += o->eval(); }
+        nstd::do_not_optimize(sum);
+    }
+    static void self_ref()
+    {
+        int sum = 0;
+        for(const auto& r : self_refs) { sum += r->eval(); }
+        nstd::do_not_optimize(sum);
+    }
+};
+template <std::size_t N>
+std::vector<AltVariantT<N>> Dispatch<N>::variants;
+template <std::size_t N>
+std::vector<std::unique_ptr<Base>> Dispatch<N>::objects;
+template <std::size_t N>
+std::vector<nstd::SelfRef<Base>> Dispatch<N>::self_refs;
+
+std::vector<Tagged> g_tagged;
+
+void switch_call()
+{
+    int sum = 0;
+    for(const auto& t : g_tagged) { sum += eval_switch(t); }
+    nstd::do_not_optimize(sum);
+}
+
+// How the alternatives are dispatched.
+enum DispatchKind
+{
+    BY_MATCH,
+    BY_VISIT,
+    BY_VIRTUAL,
+    BY_SELF_REF,
+};
+
+template <std::size_t N>
+nstd::BenchFunc dispatch_func(DispatchKind kind)
+{
+    Dispatch<N>::prepare();
+    switch(kind)
+    {
+    case BY_MATCH: return &Dispatch<N>::match;
+    case BY_VISIT: return &Dispatch<N>::visit;
+    case BY_VIRTUAL: return &Dispatch<N>::virtual_call;
+    case BY_SELF_REF: return &Dispatch<N>::self_ref;
+    }
+    return nullptr;
+}
+
+// {2, 30} makes 2, 4, 8, 16 and 30 alternatives.
+nstd::BenchFunc dispatch_func(std::int64_t n, DispatchKind kind)
+{
+    nstd::bench_items(BATCH);
+    switch(n)
+    {
+    case 2: return dispatch_func<2>(kind);
+    case 4: return dispatch_func<4>(kind);
+    case 8: return dispatch_func<8>(kind);
+    case 16: return dispatch_func<16>(kind);
+    case 30: return dispatch_func<30>(kind);
+    }
+    return nullptr;
+}
+
+BENCH_ARGS(vocab_dispatch, nstd_match, {2, 30})
+{
+    b = dispatch_func(nstd::bench_arg(0), BY_MATCH);
+}
+
+BENCH_ARGS(vocab_dispatch, std_visit, {2, 30})
+{
+    b = dispatch_func(nstd::bench_arg(0), BY_VISIT);
+}
+
+BENCH_ARGS(vocab_dispatch, virtual_call, {2, 30})
+{
+    b = dispatch_func(nstd::bench_arg(0), BY_VIRTUAL);
+}
+
+BENCH_ARGS(vocab_dispatch, self_ref_call, {2, 30})
+{
+    b = dispatch_func(nstd::bench_arg(0), BY_SELF_REF);
+}
+
+BENCH_ARGS(vocab_dispatch, hand_switch, {2, 30})
+{
+    nstd::bench_items(BATCH);
+    g_tagged.clear();
+    for(std::size_t i : alt_indexes(std::size_t(nstd::bench_arg(0))))
+    {
+        g_tagged.push_back(Tagged{int(i), int(i)});
+    }
+    b = &switch_call;
+}
+
+// ---- A nullable column of BATCH ints, a quarter None: rows of Option against an OptionVec ----
+
+std::vector<nstd::Option<int>> g_option_rows;
+nstd::OptionVec<int> g_option_column;
+
+void fill_nullable()
+{
+    nstd::bench_items(BATCH);
+    g_option_rows.clear();
+    g_option_column.clear();
+    for(std::size_t i : alt_indexes(4))
+    {
+        if(i == 0)
+        {
+            g_option_rows.push_back(nstd::None{});
+            g_option_column.push_back(nstd::None{});
+        }
+        else
+        {
+            g_option_rows.push_back(nstd::Option<int>::some(int(i)));
+            g_option_column.push_back(int(i));
+        }
+    }
+}
+
+BENCH(vocab_nullable, rows_count_some)
+{
+    fill_nullable();
+    b = [] {
+        std::size_t n = 0;
+        for(const auto& o : g_option_rows) { n += o.is_some() ? 1 : 0; }
+        nstd::do_not_optimize(n);
+    };
+}
+
+BENCH(vocab_nullable, column_count_some)
+{
+    fill_nullable();
+    b = [] { nstd::do_not_optimize(g_option_column.count_some()); };
+}
+
+BENCH(vocab_nullable, rows_sum)
+{
+    fill_nullable();
+    b = [] {
+        int sum = 0;
+        for(const auto& o : g_option_rows) { sum += o.unwrap_or(0); }
+        nstd::do_not_optimize(sum);
+    };
+}
+
+// The None elements hold 0, so the sum needs no look at the bitmap and vectorizes.
+BENCH(vocab_nullable, column_sum)
+{
+    fill_nullable();
+    b = [] {
+        int sum        = 0;
+        const int* v   = g_option_column.values();
+        std::size_t sz = g_option_column.size();
+        for(std::size_t i = 0; i < sz; ++i) { sum += v[i]; }
+        nstd::do_not_optimize(sum);
+    };
+}
+
+template <typename T>
+void print_size(const char* name)
+{
+    std::printf("%-36s %4zu %4zu\n", name, sizeof(T), alignof(T));
+}
+
+void print_sizes()
+{
+    std::printf("%-36s %4s %4s\n", "type", "size", "align");
+    print_size<nstd::Result<int, int>>("nstd::Result<int, int>");
+    print_size<std::variant<int, int>>("std::variant<int, int>");
+    print_size<Expected<int, int>>("expected<int, int>");
+    print_size<nstd::Result<std::string, int>>("nstd::Result<std::string, int>");
+    print_size<std::variant<std::string, int>>("std::variant<std::string, int>");
+    print_size<nstd::Option<int>>("nstd::Option<int>");
+    print_size<std::optional<int>>("std::optional<int>");
+    print_size<nstd::Option<std::string>>("nstd::Option<std::string>");
+    print_size<std::optional<std::string>>("std::optional<std::string>");
+    print_size<nstd::Option<nstd::NotNull<int*>>>("nstd::Option<nstd::NotNull<int*>>");
+    print_size<nstd::Option<int&>>("nstd::Option<int&>");
+    print_size<std::optional<int*>>("std::optional<int*>");
+    print_size<nstd::SelfRef<Base>>("nstd::SelfRef<Base>");
+    print_size<std::unique_ptr<Base>>("std::unique_ptr<Base>");
+    print_size<AltVariantT<30>>("variant of 30 alternatives");
+    print_size<Tagged>("tag and value");
+    fill_nullable();
+    std::printf("\n%-36s %9s\n", "nullable column of 1024 ints", "bytes");
+    std::printf("%-36s %9zu\n", "std::vector<nstd::Option<int>>",
+                g_option_rows.capacity() * sizeof(nstd::Option<int>));
+    std::printf("%-36s %9zu\n", "nstd::OptionVec<int>", g_option_column.memory_bytes());
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) { return nstd::bench_main(argc, argv, &print_sizes); }
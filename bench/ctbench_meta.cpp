@@ -0,0 +1,177 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../lib/include/ctbench.hpp"
+
+// The compile time of the metaprogramming layer against the size of the packs it's given: the
+// type_pack_element fallback, the make_integer_sequence fallbacks, MatchHelper and type_list.
+// Run it from anywhere, the headers are found next to this file:
+//     ctbench_meta --sizes 10,100,1000 --filter type_list
+// The type_list cases have a budget, the exit code is 1 if one goes over it.
+
+namespace {
+
+// struct t<0> {} ... and "t<0>, t<1>, ..., t<n - 1>".
+std::string pack(std::size_t n)
+{
+    std::string s;
+    for(std::size_t i = 0; i < n; ++i) { s += (i ? ", t<" : "t<") + std::to_string(i) + ">"; }
+    return s;
+}
+
+const char* const TYPES = "template <int> struct t {};\n";
+
+// Every element of the pack looked up once.
+std::string gen_type_pack_element(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "template <typename... Ts> struct all {\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "    using t" + std::to_string(i) + " = nstd::type_pack_element_t<" +
+             std::to_string(i) + ", Ts...>;\n";
+    }
+    s += "};\ntemplate struct all<" + pack(n) + ">;\n";
+    return s;
+}
+
+std::string gen_index_sequence(std::size_t n)
+{
+    return "static_assert(nstd::make_index_sequence<" + std::to_string(n) +
+           ">::size() == " + std::to_string(n) + ");\n";
+}
+
+std::string gen_index_sequence_linear(std::size_t n)
+{
+    return "static_assert(nstd::_internal0_impl1_utility::make_index_sequence<" +
+           std::to_string(n) + ">::size() == " + std::to_string(n) + ");\n";
+}
+
+// An overload set of n lambdas, called with a few of its alternatives.
+std::string gen_match_helper(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "int f() {\n    nstd::_internal0_impl0_match_helper::MatchHelper h{\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "        [](t<" + std::to_string(i) + ">) { return " + std::to_string(i) + "; }" +
+             (i + 1 < n ? ",\n" : "};\n");
+    }
+    s += "    return h(t<0>{}) + h(t<" + std::to_string(n / 2) + ">{}) + h(t<" +
+         std::to_string(n - 1) + ">{});\n}\n";
+    return s;
+}
+
+// nstd::match on a variant of n alternatives, one lambda per alternative.
+std::string gen_match(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "int f(const nstd::variant<" + pack(n) + ">& v) {\n    return nstd::match(v,\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "        [](t<" + std::to_string(i) + ">) { return " + std::to_string(i) + "; }" +
+             (i + 1 < n ? ",\n" : ");\n");
+    }
+    s += "}\n";
+    return s;
+}
+
+std::string gen_type_list_at(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "using L = nstd::type_list<" + pack(n) + ">;\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "static_assert(std::is_same_v<nstd::type_list_at_t<L, " + std::to_string(i) +
+             ">, t<" + std::to_string(i) + ">>);\n";
+    }
+    return s;
+}
+
+std::string gen_type_list_find(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "using L = nstd::type_list<" + pack(n) + ">;\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "static_assert(nstd::type_list_find<L, t<" + std::to_string(i) +
+             ">>::value == " + std::to_string(i) + ");\n";
+    }
+    return s;
+}
+
+// The same through the variable templates, one variable per lookup.
+std::string gen_type_list_find_v(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "using L = nstd::type_list<" + pack(n) + ">;\n";
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += "static_assert(nstd::type_list_find_v<L, t<" + std::to_string(i) +
+             ">> == " + std::to_string(i) + ");\n";
+    }
+    return s;
+}
+
+// A list with every type twice.
+std::string gen_type_list_unique(std::size_t n)
+{
+    std::string s = TYPES;
+    s += "using L = nstd::type_list<" + pack(n / 2) + ", " + pack(n - n / 2) + ">;\n";
+    s += "static_assert(nstd::type_list_unique_t<L>::size == " + std::to_string(n - n / 2) +
+         ");\n";
+    return s;
+}
+
+// n lists of one type.
+std::string gen_type_list_concat(std::size_t n)
+{
+    std::string s = TYPES + std::string("using L = nstd::type_list_concat_t<");
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        s += (i ? ", nstd::type_list<t<" : "nstd::type_list<t<") + std::to_string(i) + ">>";
+    }
+    s += ">;\nstatic_assert(L::size == " + std::to_string(n) + ");\n";
+    return s;
+}
+
+std::vector<nstd::CtBenchCase> cases()
+{
+    const std::vector<std::string> builtin{"builtin.hpp"};
+    const std::vector<std::string> utility{"utility.hpp"};
+    const std::vector<std::string> match{"variant.hpp", "match.hpp"};
+    const std::vector<std::string> type_list{"type_traits", "type_list.hpp"};
+    const std::vector<std::string> no_builtin{"-DNSTD_NO_BUILTIN_TYPE_PACK_ELEMENT"};
+    const std::vector<std::string> no_std{"-DNSTD_NO_STD_INTEGER_SEQUENCE"};
+    return {
+        {"type_pack_element", builtin, {}, &gen_type_pack_element},
+        {"type_pack_element_fallback", builtin, no_builtin, &gen_type_pack_element},
+        {"make_index_sequence", utility, {}, &gen_index_sequence},
+        {"make_index_sequence_fallback", utility, no_std, &gen_index_sequence},
+        // Linear depth, it goes over the default template depth of 900.
+        {"make_index_sequence_linear", utility, no_std, &gen_index_sequence_linear},
+        {"match_helper", match, {}, &gen_match_helper},
+        // A variant of 1000 alternatives is the cost of the variant, not of match.
+        {"match", match, {}, &gen_match, 100},
+        // The budgets are about twice the time of 1000 types on GCC 12.
+        {"type_list_at", type_list, {}, &gen_type_list_at, 0, 0.6},
+        {"type_list_find", type_list, {}, &gen_type_list_find, 0, 1.5},
+        {"type_list_find_v", type_list, {}, &gen_type_list_find_v},
+        {"type_list_unique", type_list, {}, &gen_type_list_unique, 0, 1.2},
+        {"type_list_concat", type_list, {}, &gen_type_list_concat, 0, 0.5},
+    };
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    std::string file = __FILE__;
+    std::string dir  = file.substr(0, file.find_last_of("/\\") + 1);
+    std::vector<char*> args(argv, argv + argc);
+    std::string inc  = "-I";
+    std::string path = (dir.empty() ? std::string("./") : dir) + "../lib/include";
+    args.insert(args.begin() + 1, {&inc[0], &path[0]});
+    return nstd::ctbench_main(int(args.size()), args.data(), cases());
+}
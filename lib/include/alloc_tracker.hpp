@@ -0,0 +1,63 @@
+#ifndef __NSTD_ALLOC_TRACKER_HPP__
+#define __NSTD_ALLOC_TRACKER_HPP__
+
+#include <cstdint>
+#include <utility>
+
+namespace nstd {
+
+/* Heap allocation counts of a thread. They are only counted when alloc_tracker.cpp is compiled
+ * with NSTD_ALLOC_TRACKER: it replaces the global operator new and delete, and with glibc also
+ * interposes malloc, calloc, realloc, aligned_alloc, posix_memalign, memalign, valloc, pvalloc and
+ * free. Otherwise the counts stay 0.
+ */
+struct AllocStats {
+    std::uint64_t allocs = 0;
+    std::uint64_t frees  = 0;
+    std::uint64_t bytes  = 0;  // requested by the allocations
+
+    AllocStats& operator+=(const AllocStats& other) noexcept
+    {
+        allocs += other.allocs;
+        frees += other.frees;
+        bytes += other.bytes;
+        return *this;
+    }
+    AllocStats operator-(const AllocStats& other) const noexcept
+    {
+        return AllocStats{allocs - other.allocs, frees - other.frees, bytes - other.bytes};
+    }
+};
+
+// True if the allocations are counted.
+bool alloc_tracking_enabled() noexcept;
+// The allocations of the calling thread since it started.
+AllocStats alloc_stats() noexcept;
+
+// The allocations of the calling thread since the scope was made.
+class AllocScope {
+    AllocStats m_start;
+
+public:
+    AllocScope() noexcept : m_start(alloc_stats()) {}
+    AllocStats delta() const noexcept { return alloc_stats() - m_start; }
+};
+
+// Throw the error of expect_allocations(), or print it and abort without exceptions.
+[[noreturn]] void fail_expect_allocations(std::uint64_t max_allocs, const AllocStats& got);
+
+// Fails the test case if f() allocates more than max_allocs times on the calling thread: throws
+// std::runtime_error, or prints the error and aborts with NSTD_NO_EXCEPTIONS. Passes when the
+// allocations aren't counted.
+template <typename F>
+void expect_allocations(std::uint64_t max_allocs, F&& f)
+{
+    AllocScope scope;
+    std::forward<F>(f)();
+    AllocStats d = scope.delta();
+    if(d.allocs > max_allocs) { fail_expect_allocations(max_allocs, d); }
+}
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef __NSTD_BENCH_HPP__
+#define __NSTD_BENCH_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "alloc_tracker.hpp"
+#include "bench_env.hpp"
+#include "perf_counters.hpp"
+#include "test.hpp"
+
+namespace nstd {
+
+// Make the compiler believe `value` is read, so the computation of it can't be optimized away.
+template <typename T>
+inline void do_not_optimize(const T& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const volatile void* sink;
+    sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Make the compiler believe all the memory is read and written, so stores can't be optimized away.
+inline void clobber_memory() noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+namespace _internal0_impl0_bench {
+    // Write s as a JSON string literal.
+    inline void json_string(std::ostream& out, const std::string& s)
+    {
+        out << '"';
+        for(char c : s)
+        {
+            if(c == '"' || c == '\\') { out << '\\' << c; }
+            else if(static_cast<unsigned char>(c) < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", unsigned(c));
+                out << buf;
+            }
+            else { out << c; }
+        }
+        out << '"';
+    }
+}  // namespace _internal0_impl0_bench
+
+// The bytes and the items processed by one call of the benchmarked function, for the throughput.
+// Call them in the BENCH setup. Without them, the throughput is in calls per second.
+void bench_bytes(std::uint64_t bytes) noexcept;
+void bench_items(std::uint64_t items) noexcept;
+// The i-th argument of the running BENCH_ARGS case, in its setup and in its measured function.
+// 0 outside of a parameterized benchmark.
+std::int64_t bench_arg(std::size_t i) noexcept;
+
+// One combination of the arguments of a BENCH_ARGS case, "group::case/8/1024" for the arguments
+// 8 and 1024. A BENCH case has a single instance without argument.
+struct BenchInstance {
+    std::string id;
+    std::vector<std::int64_t> args;
+};
+
+std::vector<BenchInstance> bench_instances(const TestCaseInfo& info, const std::string& id);
+
+struct BenchOptions {
+    double warmup_seconds = 0.1;
+    // The calls of one sample are repeated until a sample takes about this long.
+    double sample_seconds = 0.01;
+    unsigned int samples  = 50;
+    std::string filter;  // only run the benchmarks whose "group::case" contains it
+    // Count cycles, instructions, cache and branch misses around the samples when it's possible.
+    bool perf_counters = true;
+    // Noise controls, see bench_env.hpp.
+    int cpu            = -1;     // pin the measuring thread to this CPU, -1 doesn't pin
+    bool high_priority = false;  // raise the scheduling priority of the measuring thread
+    // Prepare all the benchmarks, then take their samples in rounds, in a new random order every
+    // round, so a slow period of the machine is spread over all of them.
+    bool interleave  = false;
+    bool flush_cache = false;  // evict the data caches before every sample
+    // A result is trusted if the relative spread of its samples is below this, and no migration or
+    // frequency change was seen.
+    double max_noise = 0.02;
+};
+
+// The interference seen while sampling a benchmark.
+struct BenchNoise {
+    double spread                  = 0;  // MAD * 1.4826 / median, a robust relative deviation
+    std::uint64_t migrations       = 0;  // samples which didn't end on the CPU they started on
+    std::uint64_t context_switches = 0;
+    double min_mhz                 = 0;  // the lowest and highest CPU frequency seen, 0 if unknown
+    double max_mhz                 = 0;
+    bool trusted                   = true;
+    std::string reason;  // why it isn't trusted
+};
+
+// Robust statistics of the samples, in nanoseconds per call. MAD is the raw median absolute
+// deviation, multiply it by 1.4826 to estimate the standard deviation of normal samples.
+struct BenchStats {
+    std::size_t count = 0;
+    double min        = 0;
+    double max        = 0;
+    double mean       = 0;
+    double median     = 0;
+    double mad        = 0;
+    double p90        = 0;
+    double p99        = 0;
+};
+
+BenchStats compute_bench_stats(std::vector<double> samples);
+
+struct BenchResult {
+    std::string id;  // "group::case"
+    std::uint64_t iters = 0;  // calls per sample
+    std::uint64_t bytes = 0;  // per call
+    std::uint64_t items = 0;  // per call
+    std::vector<double> samples;  // ns per call
+    BenchStats stats;
+    PerfCounts counters;  // the sum over all the samples
+    AllocStats allocs;    // the sum over all the samples, 0 if they aren't tracked
+    BenchNoise noise;
+
+    // Heap allocations and allocated bytes per call, see alloc_tracker.hpp.
+    double allocs_per_call() const noexcept;
+    double alloc_bytes_per_call() const noexcept;
+    // The mean count of the event per call, 0 if it wasn't counted.
+    double per_call(PerfEvent e) const noexcept;
+    // Instructions per cycle, 0 if they weren't counted.
+    double ipc() const noexcept;
+
+    // Per second by the median: bytes if bytes is set, else items if items is set, else calls.
+    double throughput() const noexcept;
+    const char* throughput_unit() const noexcept;
+};
+
+/* Measures the BENCHMARK cases registered to TestGroupManager, one at a time on the calling thread.
+ * Every benchmark is warmed up, calibrated so a sample lasts about BenchOptions::sample_seconds,
+ * then sampled BenchOptions::samples times.
+ */
+class BenchRunner {
+public:
+    // The state of a benchmark between its samples, so the samples of benchmarks can be taken in
+    // any order.
+    struct State {
+        std::string id;
+        BenchFunc func      = nullptr;
+        std::uint64_t iters = 1;
+        std::uint64_t bytes = 0;
+        std::uint64_t items = 0;
+        std::vector<std::int64_t> args;
+        std::vector<double> samples;
+        PerfCounts counters;
+        AllocStats allocs;
+        BenchNoise noise;
+    };
+
+private:
+    BenchOptions m_options;
+    PerfCounters m_counters;
+    bool m_counters_tried = false;
+    std::unique_ptr<CacheFlusher> m_flusher;
+
+    // Pin and raise the priority of the calling thread as asked, report to out.
+    void setup_thread(std::ostream& out);
+
+public:
+    explicit BenchRunner(BenchOptions options);
+    // Run the setup of the case, warm up and calibrate. Return false if the setup set no function.
+    // The hardware counters count the thread which calls prepare() first.
+    bool prepare(const TestCaseInfo& info,
+                 const std::string& id,
+                 State& state,
+                 const std::vector<std::int64_t>& args = {});
+    void sample(State& state);
+    BenchResult finish(State&& state) const;
+    std::vector<BenchResult> run(std::ostream& out);
+};
+
+void write_bench_table(std::ostream& out, const std::vector<BenchResult>& results);
+void write_bench_json(std::ostream& out, const std::vector<BenchResult>& results);
+
+/* A main() for benchmark binaries:
+ *     int main(int argc, char** argv) { return nstd::bench_main(argc, argv); }
+ * Options: --filter <text>, --samples <n>, --sample-ms <ms>, --warmup-ms <ms>, --json <path>,
+ * --no-counters, --cpu <n>, --high-priority, --interleave, --flush-cache, --max-noise <percent>,
+ * --save-baseline <name>, --baseline <name>, --baseline-dir <dir>,
+ * --confidence <0..1>, --threshold <percent>. -h/--help prints them and exits with 0, an unknown
+ * option exits with 2. `before_run` is called once the options are parsed, before the benchmarks
+ * run, e.g. to print what the binary reports besides them.
+ * With --baseline, the exit code is 1 if a benchmark is significantly slower than the baseline. A
+ * parameterized benchmark whose complexity got worse is only warned about.
+ */
+int bench_main(int argc, char** argv, void (*before_run)() = nullptr);
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef __NSTD_BENCH_BASELINE_HPP__
+#define __NSTD_BENCH_BASELINE_HPP__
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "error.hpp"
+#include "result.hpp"
+
+namespace nstd {
+
+/* Baselines are the samples of a benchmark run saved under a name, by default in
+ * ".nstd_bench/<name>.baseline". A text file:
+ *     nstd-bench-baseline 1
+ *     <group::case>\t<calls per sample>\t<bytes>\t<items>\t<sample ns> <sample ns> ...
+ */
+std::string baseline_path(const std::string& dir, const std::string& name);
+nstd::ResultOmitOk<nstd::Error> save_baseline(const std::string& path,
+                                              const std::vector<BenchResult>& results);
+nstd::Result<std::vector<BenchResult>, nstd::Error> load_baseline(const std::string& path);
+
+// Two sided p-value of the Mann-Whitney U test, normal approximation with tie correction.
+// 1 if either side has no sample.
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b);
+
+enum class BenchVerdict
+{
+    SAME,     // no significant change
+    FASTER,   // significant improvement
+    SLOWER,   // significant regression
+    NEW,      // not in the baseline
+    MISSING,  // in the baseline but not run
+};
+
+struct BenchComparison {
+    std::string id;
+    double base_median   = 0;
+    double new_median    = 0;
+    double ratio         = 1;  // new_median / base_median, < 1 is faster
+    double p_value       = 1;
+    BenchVerdict verdict = BenchVerdict::SAME;
+};
+
+struct BenchCompareOptions {
+    double confidence = 0.99;  // a change is significant if p < 1 - confidence
+    // And if the medians differ by more than this fraction, to ignore tiny stable shifts.
+    double threshold = 0.05;
+};
+
+std::vector<BenchComparison> compare_bench(const std::vector<BenchResult>& base,
+                                           const std::vector<BenchResult>& current,
+                                           const BenchCompareOptions& options);
+void write_bench_comparison(std::ostream& out, const std::vector<BenchComparison>& comparisons);
+// True if any benchmark got significantly slower.
+bool has_regression(const std::vector<BenchComparison>& comparisons) noexcept;
+
+}  // namespace nstd
+
+#endif
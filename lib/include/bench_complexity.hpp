@@ -0,0 +1,56 @@
+#ifndef __NSTD_BENCH_COMPLEXITY_HPP__
+#define __NSTD_BENCH_COMPLEXITY_HPP__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bench.hpp"
+
+namespace nstd {
+
+// In increasing order of growth.
+enum class Complexity
+{
+    O_1,
+    O_LOG_N,
+    O_N,
+    O_N_LOG_N,
+    O_N_SQUARED,
+};
+
+const char* complexity_name(Complexity c) noexcept;
+
+struct ComplexityFit {
+    // The family of the instances, "group::case/n/8" for the instances "group::case/<n>/8".
+    std::string id;
+    Complexity big_o   = Complexity::O_1;
+    double coefficient = 0;  // ns per call = coefficient * f(n)
+    double rms         = 0;  // RMS error of the fit relative to the mean time
+    std::size_t points = 0;
+};
+
+/* Fit (n, ns per call) points to every Complexity by least squares, and return the one with the
+ * lowest RMS error. A faster growing complexity must cut the error of a slower one by 10% to win,
+ * so the noise of a flat curve isn't taken for a trend. Needs 2 distinct n, else the fit is O(1).
+ */
+ComplexityFit fit_complexity(const std::vector<std::pair<double, double>>& points);
+
+/* Fit the instances of every BENCH_ARGS case, taking the first argument as n. The instances which
+ * only differ by the first argument are fit together, so every combination of the other arguments
+ * gets its own fit. The arguments are read back from the ids, so baselines can be fit as well.
+ */
+std::vector<ComplexityFit> fit_bench_complexity(const std::vector<BenchResult>& results);
+
+// `base` are the fits of a baseline, a change of complexity is shown, nullptr if none.
+void write_complexity_table(std::ostream& out,
+                            const std::vector<ComplexityFit>& fits,
+                            const std::vector<ComplexityFit>* base = nullptr);
+// True if the complexity of a family in both grew.
+bool has_complexity_regression(const std::vector<ComplexityFit>& base,
+                               const std::vector<ComplexityFit>& current) noexcept;
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef __NSTD_BENCH_ENV_HPP__
+#define __NSTD_BENCH_ENV_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nstd {
+
+/* Controls and probes of the environment of a benchmark, for Linux. Elsewhere the controls fail
+ * and the probes report unknown.
+ */
+
+// Pin the calling thread to `cpu`. False if it failed.
+bool pin_thread_to_cpu(int cpu) noexcept;
+// Raise the scheduling priority of the calling thread: SCHED_FIFO if it's allowed, else the lowest
+// nice value allowed. Return what was obtained, empty if nothing.
+std::string raise_thread_priority();
+// The CPU the calling thread runs on, -1 if unknown.
+int current_cpu() noexcept;
+// The current frequency of `cpu` in MHz according to cpufreq, 0 if unknown.
+double cpu_frequency_mhz(int cpu) noexcept;
+// The voluntary and involuntary context switches of the calling thread so far.
+std::uint64_t thread_context_switches() noexcept;
+
+// Evicts the data caches by writing then reading a buffer larger than the last level cache.
+class CacheFlusher {
+    std::vector<unsigned char> m_buffer;
+
+public:
+    // 0 means twice the last level cache size, or 64 MiB if it's unknown.
+    explicit CacheFlusher(std::size_t bytes = 0);
+    void flush() noexcept;
+};
+
+}  // namespace nstd
+
+#endif
@@ -3,7 +3,8 @@
 
 #include <cstddef>
 
-#ifdef __has_builtin
+// NSTD_NO_BUILTIN_TYPE_PACK_ELEMENT forces the fallback, to measure it.
+#if defined(__has_builtin) && !defined(NSTD_NO_BUILTIN_TYPE_PACK_ELEMENT)
 #if __has_builtin(__type_pack_element) && !(defined(__ICC))
 #define __NSTD_BUILTIN_HAS_TYPE_PACK_ELEMENT
 #endif
@@ -24,19 +25,19 @@ namespace _internal0_impl0_builtin {
     struct indexed_type : std::integral_constant<std::size_t, I> {
         using type = T;
     };
+    // The set doesn't depend on the index, so it's instantiated once per pack, not per lookup.
+    template <typename Is, typename... Ts>
+    struct indexed_types;
+    template <std::size_t... Is, typename... Ts>
+    struct indexed_types<nstd::index_sequence<Is...>, Ts...> : indexed_type<Is, Ts>... {};
+    template <std::size_t I, typename T>
+    std::enable_if<true, T> select(const indexed_type<I, T>&);
+    template <std::size_t I>
+    std::enable_if<false> select(...);
     template <std::size_t I, typename... Ts>
     struct type_pack_element_impl {
-    private:
-        template <typename>
-        struct set;
-        template <std::size_t... Is>
-        struct set<nstd::index_sequence<Is...>> : indexed_type<Is, Ts>... {};
-        template <typename T>
-        inline static std::enable_if<true, T> impl(indexed_type<I, T>);
-        inline static std::enable_if<false> impl(...);
-
-    public:
-        using type = decltype(impl(set<nstd::make_index_sequence<sizeof...(Ts)>>{}));
+        using type = decltype(select<I>(
+            std::declval<indexed_types<nstd::make_index_sequence<sizeof...(Ts)>, Ts...>>()));
     };
 }  // namespace _internal0_impl0_builtin
 
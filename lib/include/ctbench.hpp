@@ -0,0 +1,77 @@
+#ifndef __NSTD_CTBENCH_HPP__
+#define __NSTD_CTBENCH_HPP__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "bench_complexity.hpp"
+
+namespace nstd {
+
+/* Compile-time benchmarks: a case generates a translation unit for a size n, the harness compiles
+ * it for every size and measures the compiler. The TU of size 0 is the baseline of the case, its
+ * cost is the parsing of the includes and is taken off the other sizes.
+ */
+struct CtBenchCase {
+    std::string name;
+    std::vector<std::string> includes;  // #include <...> lines of the TU
+    std::vector<std::string> flags;     // added to the compiler flags, e.g. a -D
+    std::string (*generate)(std::size_t n) = nullptr;  // the code after the includes
+    std::size_t max_n                      = 0;        // the larger sizes are skipped, 0 if none
+    // The case fails if a size takes longer than this over the baseline, 0 if there's no budget.
+    double budget_seconds = 0;
+};
+
+struct CtBenchOptions {
+    std::string compiler;  // defaults to $CXX, then "c++"
+    std::vector<std::string> flags{"-std=c++17", "-O0"};
+    std::vector<std::size_t> sizes{10, 50, 100, 250, 500, 1000};
+    unsigned int repeats = 3;  // compilations per size, the median time is kept
+    std::string work_dir = ".nstd_ctbench";
+    // Pass -ftime-trace (clang), the traces are left in work_dir next to the objects.
+    bool time_trace = false;
+    std::string filter;  // only the cases whose name contains it
+};
+
+struct CtBenchResult {
+    std::string id;  // "case/n"
+    std::size_t n        = 0;
+    bool compiled        = false;
+    double seconds       = 0;  // CPU time of the compiler, user and system
+    double wall_seconds  = 0;
+    double over_baseline = 0;  // seconds minus those of the size 0
+    long max_rss_kb      = 0;  // peak memory of the compiler
+    bool over_budget     = false;
+    std::string output;  // of the compiler, if it failed
+};
+
+/* Compiles the cases one TU at a time, so the timings don't compete for the cores.
+ */
+class CtBenchRunner {
+    CtBenchOptions m_options;
+
+    CtBenchResult compile(const CtBenchCase& c, std::size_t n) const;
+
+public:
+    explicit CtBenchRunner(CtBenchOptions options);
+    // Every size of the case, the baseline first.
+    std::vector<CtBenchResult> run_case(const CtBenchCase& c, std::ostream& out) const;
+    std::vector<CtBenchResult> run(const std::vector<CtBenchCase>& cases, std::ostream& out) const;
+};
+
+// Fit the compile time over the baseline against n, for every case.
+std::vector<ComplexityFit> fit_ctbench_complexity(const std::vector<CtBenchResult>& results);
+void write_ctbench_table(std::ostream& out, const std::vector<CtBenchResult>& results);
+
+/* A main() for compile-time benchmark binaries:
+ *     int main(int argc, char** argv) { return nstd::ctbench_main(argc, argv, cases); }
+ * Options: --cxx <compiler>, --flag <flag>, -I <dir>, --sizes <n,n,...>, --repeats <n>,
+ * --work-dir <dir>, --time-trace, --filter <text>.
+ * The exit code is 1 if a case went over its budget.
+ */
+int ctbench_main(int argc, char** argv, const std::vector<CtBenchCase>& cases);
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef __NSTD_DOC_TEST_HPP__
+#define __NSTD_DOC_TEST_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "error.hpp"
+#include "result.hpp"
+#include "test.hpp"
+
+namespace nstd {
+
+// A ``` code block of a DOC_TEST doc comment, as a whole program.
+struct DocSnippet {
+    std::string group;
+    std::string name;  // "<group>_<index>"
+    std::string file;
+    std::size_t line = 0;  // of the opening ```
+    std::string code;
+};
+
+/* Extract the code blocks of a DOC_TEST from its source file, since the preprocessor drops the
+ * comments before DOC_TEST sees them. Every block becomes a program of the includes of the
+ * DOC_TEST, a function "void <group>_<index>()" of the block, and a main() calling it. #line
+ * directives point the diagnostics at the doc comment.
+ */
+nstd::Result<std::vector<DocSnippet>, nstd::Error> extract_doc_tests(const TestTextDesc& desc);
+
+struct DocTestOptions {
+    std::string compiler;  // defaults to $CXX, then "c++"
+    std::vector<std::string> flags{"-std=c++17"};
+    std::vector<std::string> link_flags;
+    // The compiled snippets are kept here by the content hash of the snippet, the compiler, the
+    // flags and the files the snippet includes, so only the snippets which changed or whose
+    // headers changed are compiled again. The compiler lists the headers with -MD, it must take
+    // the options of GCC. Stale builds aren't removed.
+    std::string cache_dir = ".nstd_doctest";
+    unsigned int jobs     = 0;  // 0 means all the hardware threads
+    bool run              = true;
+    std::string filter;  // only the snippets whose "group::name" contains it
+};
+
+enum class DocTestOutcome
+{
+    PASSED,
+    COMPILE_FAILED,
+    RUN_FAILED,
+    COMPILED,  // not run
+};
+
+struct DocTestResult {
+    std::string id;  // "group::name"
+    DocTestOutcome outcome = DocTestOutcome::PASSED;
+    bool cached            = false;  // nothing was compiled
+    std::string output;
+};
+
+// FNV-1a, the key of the cache.
+std::uint64_t doc_test_hash(const std::string& data, std::uint64_t seed = 0xcbf29ce484222325ull);
+
+/* Compiles the snippets on a pool of `jobs` compiler processes, then runs them.
+ */
+class DocTestDriver {
+    DocTestOptions m_options;
+    // The content hashes of the headers, read once per run.
+    mutable std::mutex m_files_mutex;
+    mutable std::unordered_map<std::string, std::uint64_t> m_files;
+
+    // The hash of the files listed by a dependency file of the compiler, 0 if one can't be read.
+    std::uint64_t deps_hash(const std::filesystem::path& deps) const;
+    DocTestResult build_and_run(const DocSnippet& snippet) const;
+
+public:
+    explicit DocTestDriver(DocTestOptions options);
+    std::vector<DocTestResult> run(const std::vector<DocSnippet>& snippets,
+                                   std::ostream& out) const;
+};
+
+/* A main() running the DOC_TESTs linked into the binary:
+ *     int main(int argc, char** argv) { return nstd::doc_test_main(argc, argv); }
+ * Options: -j <jobs>, --cxx <compiler>, --flag <flag>, -I <dir>, --link-flag <flag>,
+ * --cache-dir <dir>, --no-run, --filter <text>.
+ */
+int doc_test_main(int argc, char** argv);
+
+}  // namespace nstd
+
+#endif
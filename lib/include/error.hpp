@@ -0,0 +1,149 @@
+#ifndef __NSTD_ERROR_HPP__
+#define __NSTD_ERROR_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "marker.hpp"
+#include "type_traits.hpp"
+
+namespace nstd {
+
+#define __NSTD_ERROR_CTX_SLOTS 16  // contexts kept per thread
+#define __NSTD_ERROR_CTX_SIZE 119  // bytes per context, longer contexts are truncated
+
+// The codes of generic_category().
+enum class Errc : int
+{
+    OK = 0,
+    IO_ERROR,
+    TIMED_OUT,
+    ALREADY_EXISTS,
+    NOT_FOUND,
+    INVALID_FORMAT,
+    UNSUPPORTED_VERSION,
+    INVALID_ARGUMENT,
+    LIMIT_EXCEEDED,
+    EXCEPTION,  // an exception was caught, the context is its what()
+};
+
+class Error;
+
+/* The meaning of the codes of a kind of error. A category is a static object, e.g. a function
+ * local static returned by reference, it's never destroyed while errors refer to it. An error
+ * keeps the id of its category rather than a pointer: there is room for 64 categories.
+ */
+class ErrorCategory {
+    std::uint16_t m_id;
+
+    friend class Error;
+
+protected:
+    ErrorCategory() noexcept;
+    // The categories of the library have fixed ids, so their errors are constant expressions.
+    explicit constexpr ErrorCategory(std::uint16_t id) noexcept : m_id(id) {}
+
+public:
+    ErrorCategory(const ErrorCategory&)            = delete;
+    ErrorCategory& operator=(const ErrorCategory&) = delete;
+    virtual const char* name() const noexcept = 0;
+    // The message of a code, without context. Only called when an error is formatted.
+    virtual std::string message(int code) const = 0;
+    inline std::uint16_t id() const noexcept { return m_id; }
+
+protected:
+    ~ErrorCategory() = default;
+};
+
+// Errc, id 0.
+const ErrorCategory& generic_category() noexcept;
+// errno values, id 1.
+const ErrorCategory& system_category() noexcept;
+
+namespace _internal0_impl0_error {
+    constexpr std::uint16_t GENERIC_ID = 0;
+    constexpr std::uint16_t SYSTEM_ID  = 1;
+
+    // The context being built by Error::with_context, on the stack.
+    struct ContextText {
+        char text[__NSTD_ERROR_CTX_SIZE];
+        std::size_t size = 0;
+        void append(std::string_view part) noexcept;
+        void append(const char* part) noexcept;
+        void append(long long part) noexcept;
+        void append(unsigned long long part) noexcept;
+        template <typename T, nstd::enable_if_t<nstd::is_integral_v<T>, bool> = true>
+        inline void append(T part) noexcept
+        {
+            IF_CONSTEXPR(std::is_signed<T>::value) { append(static_cast<long long>(part)); }
+            else { append(static_cast<unsigned long long>(part)); }
+        }
+    };
+}  // namespace _internal0_impl0_error
+
+/* An error code and its category in 8 bytes. It's trivially copyable, so creating, returning and
+ * propagating an error never allocates, and the message is only formatted when it's asked for.
+ * A context can be attached to an error, e.g. the path which failed to open: it's copied into a
+ * thread local ring of __NSTD_ERROR_CTX_SLOTS entries, not into the error. So it's only found
+ * again in the thread which attached it, while the thread hasn't attached as many contexts since,
+ * otherwise the error is formatted without it.
+ * The error keeps a 16 bit context id, which wraps after 65535 attaches in the process. A slot
+ * reused by a later context is detected by the code and the category it was attached to, so the
+ * context is dropped. But when a later error of the same code and category in the thread lands on
+ * the same id, the error shows that newer context instead of its own.
+ *     return R::err(nstd::Error::from_errno(errno).with_context("Open ", path));
+ */
+class Error {
+    std::int32_t m_code;
+    std::uint16_t m_category;
+    std::uint16_t m_context;  // 0 if there's none
+
+    Error attach_context(const _internal0_impl0_error::ContextText& text) const noexcept;
+
+public:
+    constexpr Error(Errc code) noexcept
+        : m_code(static_cast<std::int32_t>(code)), m_category(_internal0_impl0_error::GENERIC_ID),
+          m_context(0)
+    {
+    }
+    inline Error(int code, const ErrorCategory& category) noexcept
+        : m_code(code), m_category(category.m_id), m_context(0)
+    {
+    }
+    inline static Error from_errno(int code) noexcept { return Error(code, system_category()); }
+
+    inline constexpr int code() const noexcept { return m_code; }
+    const ErrorCategory& category() const noexcept;
+    // The parts are strings or integers, concatenated. It replaces the context of this error.
+    template <typename... Parts>
+    inline Error with_context(const Parts&... parts) const noexcept
+    {
+        _internal0_impl0_error::ContextText text;
+        (text.append(parts), ...);
+        return attach_context(text);
+    }
+    inline constexpr bool has_context() const noexcept { return m_context != 0; }
+    // Empty if the context is gone (see above). It's valid until the thread attaches another
+    // __NSTD_ERROR_CTX_SLOTS contexts.
+    std::string_view context() const noexcept;
+    // "<context>: <message>." or "<message>.".
+    std::string message() const;
+
+    // The same code of the same category, whatever the context.
+    inline constexpr bool operator==(const Error& other) const noexcept
+    {
+        return m_code == other.m_code && m_category == other.m_category;
+    }
+    inline constexpr bool operator!=(const Error& other) const noexcept
+    {
+        return !(*this == other);
+    }
+};
+
+std::ostream& operator<<(std::ostream& os, const Error& error);
+
+}  // namespace nstd
+
+#endif
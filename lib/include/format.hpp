@@ -0,0 +1,330 @@
+#ifndef __NSTD_FORMAT_HPP__
+#define __NSTD_FORMAT_HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include "version.hpp"
+#include "type_traits.hpp"
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define __NSTD_LIB_HAS_FLOAT_TO_CHARS
+#include <charconv>
+#endif
+
+/* Numeric to text kernels. They write into a caller provided buffer without any allocation, locale
+ * or stream state, and return the end of the written text. The buffer must have at least the
+ * documented size.
+ */
+
+namespace nstd {
+
+constexpr std::size_t DEC_BUF_SIZE       = 20;  // u64/i64 to decimal
+constexpr std::size_t HEX_BUF_SIZE       = 16;  // u64 to hex
+constexpr std::size_t FLOAT_BUF_SIZE     = 32;  // shortest round trip double
+constexpr std::size_t TIMESTAMP_BUF_SIZE = 26;  // "YYYY-MM-DD HH:MM:SS.uuuuuu"
+constexpr std::size_t DURATION_BUF_SIZE  = 32;
+
+namespace _internal0_impl0_format {
+    inline constexpr char digits2[201] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    inline constexpr char hex_lower[17] = "0123456789abcdef";
+    inline constexpr char hex_upper[17] = "0123456789ABCDEF";
+
+    inline int bit_width(std::uint64_t v) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return v == 0 ? 0 : 64 - __builtin_clzll(v);
+#else
+        int n = 0;
+        while(v != 0)
+        {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    inline int dec_digits(std::uint64_t v) noexcept
+    {
+        constexpr std::uint64_t pow10[20] = {1ull,
+                                             10ull,
+                                             100ull,
+                                             1000ull,
+                                             10000ull,
+                                             100000ull,
+                                             1000000ull,
+                                             10000000ull,
+                                             100000000ull,
+                                             1000000000ull,
+                                             10000000000ull,
+                                             100000000000ull,
+                                             1000000000000ull,
+                                             10000000000000ull,
+                                             100000000000000ull,
+                                             1000000000000000ull,
+                                             10000000000000000ull,
+                                             100000000000000000ull,
+                                             1000000000000000000ull,
+                                             10000000000000000000ull};
+        // log10(2) ~= 1233 / 4096. `v | 1` makes 0 a one digit number.
+        int t = (bit_width(v | 1) * 1233) >> 12;
+        return t + ((v | 1) >= pow10[t] ? 1 : 0);
+    }
+
+    // Write the n digits of v ending at `last`.
+    inline void write_digits(char* last, std::uint64_t v) noexcept
+    {
+        while(v >= 100)
+        {
+            std::size_t i = std::size_t(v % 100) * 2;
+            v /= 100;
+            last -= 2;
+            std::memcpy(last, digits2 + i, 2);
+        }
+        if(v >= 10)
+        {
+            last -= 2;
+            std::memcpy(last, digits2 + v * 2, 2);
+        }
+        else { *--last = char('0' + v); }
+    }
+
+    inline char* write2(char* p, unsigned int v) noexcept
+    {
+        std::memcpy(p, digits2 + v * 2, 2);
+        return p + 2;
+    }
+
+    // Days since 1970-01-01 to the civil date (proleptic gregorian).
+    inline void civil_from_days(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d) noexcept
+    {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe     = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe     = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy     = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp      = (5 * doy + 2) / 153;
+        d                      = doy - (153 * mp + 2) / 5 + 1;
+        m                      = mp < 10 ? mp + 3 : mp - 9;
+        y                      = std::int64_t(yoe) + era * 400 + (m <= 2 ? 1 : 0);
+    }
+}  // namespace _internal0_impl0_format
+
+// Needs DEC_BUF_SIZE bytes.
+inline char* u64_to_dec(char* buf, std::uint64_t v) noexcept
+{
+    int n = _internal0_impl0_format::dec_digits(v);
+    _internal0_impl0_format::write_digits(buf + n, v);
+    return buf + n;
+}
+
+// Needs DEC_BUF_SIZE bytes.
+inline char* i64_to_dec(char* buf, std::int64_t v) noexcept
+{
+    std::uint64_t u = static_cast<std::uint64_t>(v);
+    if(v < 0)
+    {
+        *buf++ = '-';
+        u      = 0 - u;
+    }
+    return u64_to_dec(buf, u);
+}
+
+// Needs HEX_BUF_SIZE bytes. No "0x" prefix.
+inline char* u64_to_hex(char* buf, std::uint64_t v, bool upper = false) noexcept
+{
+    const char* table =
+        upper ? _internal0_impl0_format::hex_upper : _internal0_impl0_format::hex_lower;
+    int n = (_internal0_impl0_format::bit_width(v) + 3) >> 2;
+    if(n == 0) { n = 1; }
+    char* last = buf + n;
+    for(char* p = last; p != buf; v >>= 4) { *--p = table[v & 0xF]; }
+    return last;
+}
+
+// The shortest text which reads back to the same double. Needs FLOAT_BUF_SIZE bytes.
+inline char* f64_to_str(char* buf, double v) noexcept
+{
+#ifdef __NSTD_LIB_HAS_FLOAT_TO_CHARS
+    return std::to_chars(buf, buf + FLOAT_BUF_SIZE, v).ptr;
+#else
+    int n = 0;
+    for(int prec = 15; prec <= 17; ++prec)
+    {
+        n = std::snprintf(buf, FLOAT_BUF_SIZE, "%.*g", prec, v);
+        if(prec == 17 || std::strtod(buf, nullptr) == v) { break; }
+    }
+    return buf + n;
+#endif
+}
+
+// Needs FLOAT_BUF_SIZE bytes.
+inline char* f32_to_str(char* buf, float v) noexcept
+{
+#ifdef __NSTD_LIB_HAS_FLOAT_TO_CHARS
+    return std::to_chars(buf, buf + FLOAT_BUF_SIZE, v).ptr;
+#else
+    int n = 0;
+    for(int prec = 6; prec <= 9; ++prec)
+    {
+        n = std::snprintf(buf, FLOAT_BUF_SIZE, "%.*g", prec, double(v));
+        if(prec == 9 || std::strtof(buf, nullptr) == v) { break; }
+    }
+    return buf + n;
+#endif
+}
+
+// UTC time as "YYYY-MM-DD HH:MM:SS.uuuuuu". Needs TIMESTAMP_BUF_SIZE bytes.
+inline char* render_timestamp(char* buf, std::chrono::system_clock::time_point tp) noexcept
+{
+    using namespace std::chrono;
+    using _internal0_impl0_format::write2;
+    const std::int64_t us = duration_cast<microseconds>(tp.time_since_epoch()).count();
+    std::int64_t secs     = us / 1000000;
+    std::int64_t frac     = us % 1000000;
+    if(frac < 0)
+    {
+        frac += 1000000;
+        --secs;
+    }
+    std::int64_t days = secs / 86400;
+    std::int64_t sod  = secs % 86400;
+    if(sod < 0)
+    {
+        sod += 86400;
+        --days;
+    }
+    std::int64_t y;
+    unsigned m, d;
+    _internal0_impl0_format::civil_from_days(days, y, m, d);
+    char* p = buf;
+    if(y < 0 || y > 9999) { y = y < 0 ? 0 : 9999; }
+    p    = write2(p, unsigned(y / 100));
+    p    = write2(p, unsigned(y % 100));
+    *p++ = '-';
+    p    = write2(p, m);
+    *p++ = '-';
+    p    = write2(p, d);
+    *p++ = ' ';
+    p    = write2(p, unsigned(sod / 3600));
+    *p++ = ':';
+    p    = write2(p, unsigned(sod / 60 % 60));
+    *p++ = ':';
+    p    = write2(p, unsigned(sod % 60));
+    *p++ = '.';
+    p    = write2(p, unsigned(frac / 10000));
+    p    = write2(p, unsigned(frac / 100 % 100));
+    p    = write2(p, unsigned(frac % 100));
+    return p;
+}
+
+// A duration with 3 decimals in the largest fitting unit, e.g. "12.345ms". Needs
+// DURATION_BUF_SIZE bytes.
+inline char* render_duration(char* buf, std::chrono::nanoseconds dur) noexcept
+{
+    std::int64_t ns = dur.count();
+    std::uint64_t u = static_cast<std::uint64_t>(ns);
+    if(ns < 0)
+    {
+        *buf++ = '-';
+        u      = 0 - u;
+    }
+    if(u < 1000)
+    {
+        buf = u64_to_dec(buf, u);
+        std::memcpy(buf, "ns", 2);
+        return buf + 2;
+    }
+    static constexpr const char* units[] = {"us", "ms", "s"};
+    int unit                              = u >= 1000000000 ? 2 : (u >= 1000000 ? 1 : 0);
+    std::uint64_t step                    = unit == 2 ? 1000000 : (unit == 1 ? 1000 : 1);
+    // Keep 3 decimals: round to a thousandth of the unit. Up to 1000 of it, it's the next unit.
+    std::uint64_t milli = (u + step / 2) / step;
+    if(milli >= 1000000 && unit < 2)
+    {
+        ++unit;
+        step *= 1000;
+        milli = (u + step / 2) / step;
+    }
+    buf              = u64_to_dec(buf, milli / 1000);
+    *buf++           = '.';
+    unsigned int rem = unsigned(milli % 1000);
+    *buf++           = char('0' + rem / 100);
+    buf              = _internal0_impl0_format::write2(buf, rem % 100);
+    std::size_t len  = std::strlen(units[unit]);
+    std::memcpy(buf, units[unit], len);
+    return buf + len;
+}
+
+/* Stream adaptors. `os << nstd::hex(v)` etc. write through the kernels above and bypass the locale
+ * and the num_put facet of the stream.
+ */
+struct FmtHex {
+    std::uint64_t value;
+    bool upper;
+};
+struct FmtFloat {
+    double value;
+};
+struct FmtTimestamp {
+    std::chrono::system_clock::time_point value;
+};
+struct FmtDuration {
+    std::chrono::nanoseconds value;
+};
+
+template <typename T, nstd::enable_if_t<nstd::is_integral_v<T>, bool> = true>
+inline constexpr FmtHex hex(T v, bool upper = false) noexcept
+{
+    return FmtHex{static_cast<std::uint64_t>(v), upper};
+}
+inline constexpr FmtFloat shortest(double v) noexcept { return FmtFloat{v}; }
+inline FmtTimestamp timestamp(std::chrono::system_clock::time_point tp) noexcept
+{
+    return FmtTimestamp{tp};
+}
+template <typename Rep, typename Period>
+inline FmtDuration duration(std::chrono::duration<Rep, Period> d) noexcept
+{
+    return FmtDuration{std::chrono::duration_cast<std::chrono::nanoseconds>(d)};
+}
+
+inline std::ostream& operator<<(std::ostream& os, FmtHex v)
+{
+    char buf[HEX_BUF_SIZE];
+    return os.write(buf, u64_to_hex(buf, v.value, v.upper) - buf);
+}
+inline std::ostream& operator<<(std::ostream& os, FmtFloat v)
+{
+    char buf[FLOAT_BUF_SIZE];
+    return os.write(buf, f64_to_str(buf, v.value) - buf);
+}
+inline std::ostream& operator<<(std::ostream& os, FmtTimestamp v)
+{
+    char buf[TIMESTAMP_BUF_SIZE];
+    return os.write(buf, render_timestamp(buf, v.value) - buf);
+}
+inline std::ostream& operator<<(std::ostream& os, FmtDuration v)
+{
+    char buf[DURATION_BUF_SIZE];
+    return os.write(buf, render_duration(buf, v.value) - buf);
+}
+
+}  // namespace nstd
+
+#endif
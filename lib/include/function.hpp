@@ -0,0 +1,220 @@
+#ifndef __NSTD_FUNCTION_HPP__
+#define __NSTD_FUNCTION_HPP__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "marker.hpp"
+#include "type_traits.hpp"
+
+namespace nstd {
+
+template <typename Sig>
+class FunctionRef;
+template <typename Sig, std::size_t N = 4 * sizeof(void*)>
+class InplaceFunction;
+
+namespace _internal0_impl0_function {
+    template <typename T>
+    struct is_inplace_function : std::false_type {};
+    template <typename Sig, std::size_t N>
+    struct is_inplace_function<InplaceFunction<Sig, N>> : std::true_type {};
+
+    template <typename F>
+    inline bool is_null(const F& f) noexcept
+    {
+        IF_CONSTEXPR(std::is_pointer<F>::value || std::is_member_pointer<F>::value)
+        {
+            return f == nullptr;
+        }
+        else { return false; }
+    }
+}  // namespace _internal0_impl0_function
+
+/* A non-owning reference to a callable, two pointers wide. It never allocates, it's meant for
+ * parameters: the referenced callable must outlive every call.
+ *     void each(nstd::FunctionRef<void(int)> f) { for(int i = 0; i < 3; ++i) { f(i); } }
+ *     each([&](int i) { sum += i; });
+ */
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+    void* m_obj                     = nullptr;
+    R (*m_invoke)(void*, Args&&...) = nullptr;
+
+    template <typename F>
+    static R invoke(void* obj, Args&&... args)
+    {
+        return (*static_cast<F*>(obj))(std::forward<Args>(args)...);
+    }
+    template <typename F>
+    static R invoke_ptr(void* obj, Args&&... args)
+    {
+        return reinterpret_cast<F>(obj)(std::forward<Args>(args)...);
+    }
+
+public:
+    template <typename F,
+              typename = nstd::enable_if_t<
+                  !std::is_same<nstd::decay_t<F>, FunctionRef>::value &&
+                  std::is_invocable_r<R, nstd::remove_reference_t<F>&, Args...>::value>>
+    FunctionRef(F&& f) noexcept
+    {
+        using T = nstd::remove_reference_t<F>;
+        IF_CONSTEXPR(std::is_function<T>::value)
+        {
+            // A function is referenced by its address, it has no object to point to.
+            m_obj    = reinterpret_cast<void*>(&f);
+            m_invoke = &invoke_ptr<T*>;
+        }
+        else
+        {
+            m_obj    = const_cast<void*>(static_cast<const volatile void*>(std::addressof(f)));
+            m_invoke = &invoke<T>;
+        }
+    }
+    FunctionRef(const FunctionRef&) noexcept = default;
+    FunctionRef& operator=(const FunctionRef&) noexcept = default;
+
+    R operator()(Args... args) const { return m_invoke(m_obj, std::forward<Args>(args)...); }
+};
+
+/* An owning callable like std::function, whose target is stored inline in N bytes and never on
+ * the heap: a target which doesn't fit, or isn't nothrow movable, fails to compile. A call is one
+ * indirect call, through which the target's call operator is inlined. Like std::function, the
+ * target must be copyable and is called through a const InplaceFunction. The const doesn't make a
+ * call thread safe: a mutable target is changed by the call, so the threads calling one
+ * InplaceFunction at once need a target which is safe to call concurrently.
+ *     nstd::InplaceFunction<int(int), 16> f = [k = 3](int x) { return x * k; };
+ * Calling an empty InplaceFunction is undefined.
+ */
+template <typename R, typename... Args, std::size_t N>
+class InplaceFunction<R(Args...), N> {
+    struct Ops {
+        R (*invoke)(void*, Args&&...);
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src) noexcept;  // and destroy src
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <typename F>
+    struct OpsFor {
+        static R invoke(void* p, Args&&... args)
+        {
+            return (*static_cast<F*>(p))(std::forward<Args>(args)...);
+        }
+        static void copy(void* dst, const void* src) { ::new(dst) F(*static_cast<const F*>(src)); }
+        static void move(void* dst, void* src) noexcept
+        {
+            ::new(dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* p) noexcept { static_cast<F*>(p)->~F(); }
+        static constexpr Ops ops = {&invoke, &copy, &move, &destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char m_storage[N];
+    const Ops* m_ops = nullptr;
+
+    template <typename F>
+    void assign(F&& f)
+    {
+        using T = nstd::decay_t<F>;
+        static_assert(sizeof(T) <= N, "The callable doesn't fit in the InplaceFunction.");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "The callable is overaligned.");
+        static_assert(std::is_nothrow_move_constructible<T>::value,
+                      "The callable must be nothrow move constructible.");
+        static_assert(std::is_copy_constructible<T>::value, "The callable must be copyable.");
+        if(_internal0_impl0_function::is_null(f)) { return; }
+        ::new(static_cast<void*>(m_storage)) T(std::forward<F>(f));
+        m_ops = &OpsFor<T>::ops;
+    }
+    void reset() noexcept
+    {
+        if(m_ops != nullptr) { m_ops->destroy(m_storage); }
+        m_ops = nullptr;
+    }
+
+public:
+    InplaceFunction() noexcept = default;
+    InplaceFunction(std::nullptr_t) noexcept {}
+    template <typename F,
+              typename = nstd::enable_if_t<
+                  !_internal0_impl0_function::is_inplace_function<nstd::decay_t<F>>::value &&
+                  std::is_invocable_r<R, nstd::decay_t<F>&, Args...>::value>>
+    InplaceFunction(F&& f)
+    {
+        assign(std::forward<F>(f));
+    }
+    InplaceFunction(const InplaceFunction& other)
+    {
+        if(other.m_ops != nullptr)
+        {
+            other.m_ops->copy(m_storage, other.m_storage);
+            m_ops = other.m_ops;
+        }
+    }
+    InplaceFunction(InplaceFunction&& other) noexcept
+    {
+        if(other.m_ops != nullptr)
+        {
+            other.m_ops->move(m_storage, other.m_storage);
+            m_ops       = other.m_ops;
+            other.m_ops = nullptr;
+        }
+    }
+    ~InplaceFunction() { reset(); }
+
+    InplaceFunction& operator=(const InplaceFunction& other)
+    {
+        if(this != &other)
+        {
+            InplaceFunction tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            if(other.m_ops != nullptr)
+            {
+                other.m_ops->move(m_storage, other.m_storage);
+                m_ops       = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+        return *this;
+    }
+    InplaceFunction& operator=(std::nullptr_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+    template <typename F,
+              typename = nstd::enable_if_t<
+                  !_internal0_impl0_function::is_inplace_function<nstd::decay_t<F>>::value &&
+                  std::is_invocable_r<R, nstd::decay_t<F>&, Args...>::value>>
+    InplaceFunction& operator=(F&& f)
+    {
+        reset();
+        assign(std::forward<F>(f));
+        return *this;
+    }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+    friend bool operator==(const InplaceFunction& f, std::nullptr_t) noexcept { return !f; }
+    friend bool operator!=(const InplaceFunction& f, std::nullptr_t) noexcept { return bool(f); }
+
+    // Calls the target as non const, see above.
+    R operator()(Args... args) const
+    {
+        return m_ops->invoke(const_cast<unsigned char*>(m_storage), std::forward<Args>(args)...);
+    }
+};
+
+}  // namespace nstd
+
+#endif
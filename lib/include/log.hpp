@@ -10,15 +10,21 @@
 #include <sstream>
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include "version.hpp"
 #include "marker.hpp"
 #include "type_traits.hpp"
 #include "source_location.hpp"
 #include "self_ref.hpp"
+#include "error.hpp"
 #include "result.hpp"
+#include "log_context.hpp"
+#include "format.hpp"
 
 namespace nstd {
 
-using LogResult = nstd::ResultOmitOk<std::string>;
+using LogResult = nstd::ResultOmitOk<nstd::Error>;
 
 trait ILogMask;
 // The base class of your own LogType class
@@ -28,15 +34,15 @@ class LogMetaData;
 trait Logger;
 class GlobalLogger;
 
-#define NSTD_NON LogType(LogType::LOG_NON)
-#define NSTD_TRACE LogType(LogType::LOG_TRACE)
-#define NSTD_DEBUG LogType(LogType::LOG_DEBUG)
-#define NSTD_INFO LogType(LogType::LOG_INFO)
-#define NSTD_WARN LogType(LogType::LOG_WARN)
-#define NSTD_ERROR LogType(LogType::LOG_ERROR)
-#define NSTD_FATAL LogType(LogType::LOG_FATAL)
-#define NSTD_PERF LogType(LogType::LOG_PERF)
-#define NSTD_FUNC LogType(LogType::LOG_FUNC)
+#define NSTD_NON nstd::LogType(nstd::LogType::LOG_NON)
+#define NSTD_TRACE nstd::LogType(nstd::LogType::LOG_TRACE)
+#define NSTD_DEBUG nstd::LogType(nstd::LogType::LOG_DEBUG)
+#define NSTD_INFO nstd::LogType(nstd::LogType::LOG_INFO)
+#define NSTD_WARN nstd::LogType(nstd::LogType::LOG_WARN)
+#define NSTD_ERROR nstd::LogType(nstd::LogType::LOG_ERROR)
+#define NSTD_FATAL nstd::LogType(nstd::LogType::LOG_FATAL)
+#define NSTD_PERF nstd::LogType(nstd::LogType::LOG_PERF)
+#define NSTD_FUNC nstd::LogType(nstd::LogType::LOG_FUNC)
 
 #define __NSTD_LOG_TIMEOUT 30  // timeout: 30s
 #define __NSTD_WARNING(...)                                                          \
@@ -55,51 +61,75 @@ class GlobalLogger;
         std::cerr << buf.str();                                                       \
     } while(false)
 
-#define NSTD_LOGGER(logger, type, ...)                                         \
-    do {                                                                       \
-        try                                                                    \
-        {                                                                      \
-            LogMetaData md(type, __NSTD_FILE__, __NSTD_LINE__, __NSTD_FUNC__); \
-            if(logger.enabled(md))                                             \
-            {                                                                  \
-                logger.get_buf() << __VA_ARGS__ << std::endl;                  \
-                logger.log(std::move(md));                                     \
-                std::stringstream().swap(logger.get_buf());                    \
-            }                                                                  \
-        }                                                                      \
-        catch(const std::exception& e)                                         \
-        {                                                                      \
-            __NSTD_ERROR(e.what());                                            \
-        }                                                                      \
+/* The log macros don't throw. The errors the loggers return are reported to stderr, and with
+ * exceptions, so are those thrown by the loggers and the streamed values. In the exception-free
+ * mode (see NSTD_NO_EXCEPTIONS) the macros have no handler at all.
+ * The buffer of a logger is reset before a record is written to it, so the text of a record whose
+ * logger threw doesn't leak into the next one.
+ */
+#ifdef NSTD_NO_EXCEPTIONS
+#define __NSTD_LOG_TRY
+#define __NSTD_LOG_CATCH
+#else
+#define __NSTD_LOG_TRY try
+#define __NSTD_LOG_CATCH           \
+    catch(const std::exception& e) \
+    {                              \
+        __NSTD_ERROR(e.what());    \
+    }
+#endif
+
+#define __NSTD_LOG_REPORT(result)                                                      \
+    do {                                                                               \
+        nstd::LogResult _nstd_log_result = (result);                                   \
+        if(_nstd_log_result.is_err()) { __NSTD_ERROR(_nstd_log_result.unwrap_err()); } \
+    } while(false)
+
+#define NSTD_LOGGER(logger, type, ...)                                               \
+    do {                                                                             \
+        __NSTD_LOG_TRY                                                               \
+        {                                                                            \
+            static nstd::LogSite _nstd_log_site;                                     \
+            nstd::LogMetaData md(type, __NSTD_FILE__, __NSTD_LINE__, __NSTD_FUNC__); \
+            md.site = &_nstd_log_site;                                               \
+            if(logger.enabled(md))                                                   \
+            {                                                                        \
+                std::stringstream().swap(logger.get_buf());                          \
+                nstd::LogStream(logger.get_buf()) << __VA_ARGS__ << std::endl;       \
+                __NSTD_LOG_REPORT(logger.log(std::move(md)));                        \
+            }                                                                        \
+        }                                                                            \
+        __NSTD_LOG_CATCH                                                             \
     } while(false)
 
-#define NSTD_LOG(type, ...)                                                                     \
-    do {                                                                                        \
-        try                                                                                     \
-        {                                                                                       \
-            LogMetaData md(type, __NSTD_FILE__, __NSTD_LINE__, __NSTD_FUNC__);                  \
-            std::unique_lock<std::mutex>(GlobalLogger::global_logger_mutex(), std::defer_lock); \
-            if(lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))                     \
-            {                                                                                   \
-                std::map<std::size_t, std::shared_ptr<Logger>>& glogger =                       \
-                    GlobalLogger::global_logger();                                              \
-                for(auto iter = glogger.begin(); iter != glogger.end(); ++iter)                 \
-                {                                                                               \
-                    std::shared_ptr<Logger>& logger = iter->second;                             \
-                    if(logger->enabled(md))                                                     \
-                    {                                                                           \
-                        logger.get_buf() << __VA_ARGS__ << std::endl;                           \
-                        logger->log(std::move(md));                                             \
-                        std::stringstream().swap(logger.get_buf());                             \
-                    }                                                                           \
-                }                                                                               \
-            }                                                                                   \
-            else { __NSTD_ERROR("Lock global logger failed."); }                                \
-        }                                                                                       \
-        catch(const std::exception& e)                                                          \
-        {                                                                                       \
-            __NSTD_ERROR(e.what());                                                             \
-        }                                                                                       \
+// Every logger gets its own metadata, log() takes it by rvalue and may keep it.
+#define NSTD_LOG(type, ...)                                                                    \
+    do {                                                                                       \
+        __NSTD_LOG_TRY                                                                         \
+        {                                                                                      \
+            static nstd::LogSite _nstd_log_site;                                               \
+            std::unique_lock<std::timed_mutex> lock(nstd::GlobalLogger::global_logger_mutex(), \
+                                                    std::defer_lock);                          \
+            if(lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))                    \
+            {                                                                                  \
+                std::map<std::size_t, std::shared_ptr<nstd::Logger>>& glogger =                \
+                    nstd::GlobalLogger::global_logger();                                       \
+                for(auto iter = glogger.begin(); iter != glogger.end(); ++iter)                \
+                {                                                                              \
+                    std::shared_ptr<nstd::Logger>& logger = iter->second;                      \
+                    nstd::LogMetaData md(type, __NSTD_FILE__, __NSTD_LINE__, __NSTD_FUNC__);   \
+                    md.site = &_nstd_log_site;                                                 \
+                    if(logger->enabled(md))                                                    \
+                    {                                                                          \
+                        std::stringstream().swap(logger->get_buf());                           \
+                        nstd::LogStream(logger->get_buf()) << __VA_ARGS__ << std::endl;        \
+                        __NSTD_LOG_REPORT(logger->log(std::move(md)));                         \
+                    }                                                                          \
+                }                                                                              \
+            }                                                                                  \
+            else { __NSTD_ERROR("Lock global logger failed."); }                               \
+        }                                                                                      \
+        __NSTD_LOG_CATCH                                                                       \
     } while(false)
 
 #define NSTD_LOGGER_TRACE(logger, ...) NSTD_LOGGER(logger, NSTD_TRACE, __VA_ARGS__)
@@ -129,13 +159,13 @@ template <typename T1,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T2>, bool> = true>
 T1 operator&(const T1& t1, const T2& t2) noexcept
 {
-    if(dynamic_cast<const T2*>(&t1) != nullptr) { return T1{t1.mask & t2.mask}; }
+    if(dynamic_cast<const T2*>(&t1) != nullptr) { return T1{t1.m_mask & t2.m_mask}; }
     else
     {
         __NSTD_WARNING(
             "There is conflict within log types. Will use the predefined log type only. Log type "
             << typeid(t1).name() << " conflict with log type " << typeid(t2).name() << ".");
-        return T1{t1.mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT & t2.mask};
+        return T1{t1.m_mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT & t2.m_mask};
     }
 }
 
@@ -145,13 +175,13 @@ template <typename T1,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T2>, bool> = true>
 T1 operator|(const T1& t1, const T2& t2) noexcept
 {
-    if(dynamic_cast<const T2*>(&t1) != nullptr) { return T1{t1.mask | t2.mask}; }
+    if(dynamic_cast<const T2*>(&t1) != nullptr) { return T1{t1.m_mask | t2.m_mask}; }
     else
     {
         __NSTD_WARNING(
             "There is conflict within log types. Will use the current log type only. Log type "
             << typeid(t1).name() << " conflict with log type " << typeid(t2).name() << ".");
-        return T1{t1.mask | (t2.mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT)};
+        return T1{t1.m_mask | (t2.m_mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT)};
     }
 }
 
@@ -163,7 +193,7 @@ T1& operator|=(T1& t1, const T2& t2) noexcept
 {
     if(dynamic_cast<const T2*>(&t1) != nullptr)
     {
-        t1.mask |= t2.mask;
+        t1.m_mask |= t2.m_mask;
         return t1;
     }
     else
@@ -171,7 +201,7 @@ T1& operator|=(T1& t1, const T2& t2) noexcept
         __NSTD_WARNING(
             "There is conflict within log types. Will use the current log type only. Log type "
             << typeid(t1).name() << " conflict with log type " << typeid(t2).name() << ".");
-        t1.mask |= (t2.mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT);
+        t1.m_mask |= (t2.m_mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT);
         return t1;
     }
 }
@@ -184,16 +214,16 @@ T1&& operator|=(T1&& t1, const T2& t2) noexcept
 {
     if(dynamic_cast<const T2*>(&t1) != nullptr)
     {
-        t1.mask |= t2.mask;
-        return t1;
+        t1.m_mask |= t2.m_mask;
+        return std::move(t1);
     }
     else
     {
         __NSTD_WARNING(
             "There is conflict within log types. Will use the current log type only. Log type "
             << typeid(t1).name() << " conflict with log type " << typeid(t2).name() << ".");
-        t1.mask |= (t2.mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT);
-        return t1;
+        t1.m_mask |= (t2.m_mask & __PRE_DEFINED_RESERVE_LOG_TYPE_BIT);
+        return std::move(t1);
     }
 }
 
@@ -203,13 +233,13 @@ template <typename T1,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T2>, bool> = true>
 bool operator==(const T1& t1, const T2& t2) noexcept
 {
-    if(dynamic_cast<const T2*>(&t1) != nullptr) { return t1.mask == t2.mask; }
+    if(dynamic_cast<const T2*>(&t1) != nullptr) { return t1.m_mask == t2.m_mask; }
     else
     {
         __NSTD_WARNING("There is conflict within log types. Will compare them anyway. Log type "
                        << typeid(t1).name() << " conflict with log type " << typeid(t2).name()
                        << ".");
-        return t1.mask == t2.mask;
+        return t1.m_mask == t2.m_mask;
     }
 }
 
@@ -235,22 +265,22 @@ public:
           typename T2,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T1>, bool>,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T2>, bool>>
-    friend T1&& operator|=(T1&& t1, const T2& t2) noexcept
+    friend T1&& operator|=(T1&& t1, const T2& t2) noexcept;
     template <typename T1,
           typename T2,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T1>, bool>,
           nstd::enable_if_t<nstd::is_base_of_v<LogType, T2>, bool>>
     friend bool operator==(const T1& t1, const T2& t2) noexcept;
-    constexpr ILogMask(unsigned int m) : mask(m){};
-    constexpr ILogMask(ILogMask &&)                = default;
-    constexpr ILogMask(const ILogMask&)            = default;
-    constexpr ILogMask& operator=(ILogMask&&)      = default;
-    constexpr ILogMask& operator=(const ILogMask&) = default;
-    virtual ~ILogMask()                            = default;
-    virtual unsigned int mask() const noexcept { return mask; }
+    constexpr ILogMask(unsigned int m) : m_mask(m) {}
+    ILogMask(ILogMask&&)                 = default;
+    ILogMask(const ILogMask&)            = default;
+    ILogMask& operator=(ILogMask&&)      = default;
+    ILogMask& operator=(const ILogMask&) = default;
+    virtual ~ILogMask()                  = default;
+    virtual unsigned int mask() const noexcept { return m_mask; }
 
 protected:
-    unsigned int mask;
+    unsigned int m_mask;
 };
 
 class LogType : virtual public ILogMask {
@@ -268,15 +298,16 @@ public:
         LOG_FUNC  = 128,    // 7bit
         LOG_RESV  = 32768,  // _PreSetLogType reserve 16 bits.
     };
-    constexpr LogType() : ILogMask(LogType::LOG_NON){};
-    constexpr LogType(unsigned int m) : ILogMask(m){};
-    constexpr LogType(LogType&&)                  = default;
-    constexpr LogType(const LogType&)             = default;
-    constexpr LogType& operator=(LogType&&)       = default;
-    constexpr LogType& operator=(const LogType&&) = default;
-    virtual const char* c_str() noexcept
+    // A virtual base, so neither the constructors nor the copies can be constexpr.
+    LogType() : ILogMask(LogType::LOG_NON) {}
+    LogType(unsigned int m) : ILogMask(m) {}
+    LogType(LogType&&)                 = default;
+    LogType(const LogType&)            = default;
+    LogType& operator=(LogType&&)      = default;
+    LogType& operator=(const LogType&) = default;
+    virtual const char* c_str() const noexcept
     {
-        switch(mask)
+        switch(m_mask)
         {
         case LOG_NON: return "";
         case LOG_TRACE: return "Trace";
@@ -288,13 +319,94 @@ public:
         case LOG_PERF: return "Perf";
         case LOG_FUNC: return "Func";
         default:
-            __NSTD_ERROR("Must chose one type of logging. Current value: " << std::hex << mask
-                                                                           << ".");
+            __NSTD_ERROR("Must chose one type of logging. Current value: " << std::hex
+                                                                           << m_mask << ".");
             return "";
         }
     }
 };
 
+namespace _internal0_impl0_log {
+    template <typename T>
+    inline constexpr bool is_number_v =
+        nstd::is_integral_v<T> && !nstd::is_same_v<T, bool> && !nstd::is_same_v<T, char> &&
+        !nstd::is_same_v<T, signed char> && !nstd::is_same_v<T, unsigned char> &&
+        !nstd::is_same_v<T, wchar_t> && !nstd::is_same_v<T, char16_t> &&
+        !nstd::is_same_v<T, char32_t>;
+}  // namespace _internal0_impl0_log
+
+/* The stream the log macros write through. Integers go through the format.hpp kernels (unless the
+ * stream has non default flags like std::hex or a width), durations and system clock time points
+ * are rendered by render_duration/render_timestamp. Everything else goes to the underlying stream.
+ */
+class LogStream {
+    std::ostream& os;
+
+    inline bool plain() const
+    {
+        return os.width() == 0 &&
+               (os.flags() & (std::ios_base::basefield | std::ios_base::showpos)) ==
+                   std::ios_base::dec;
+    }
+
+public:
+    explicit LogStream(std::ostream& s) noexcept : os(s) {}
+    template <typename T,
+              nstd::enable_if_t<!_internal0_impl0_log::is_number_v<nstd::decay_t<T>>, bool> = true>
+    inline LogStream& operator<<(const T& v)
+    {
+        os << v;
+        return *this;
+    }
+    template <typename T,
+              nstd::enable_if_t<_internal0_impl0_log::is_number_v<T>, bool> = true>
+    inline LogStream& operator<<(T v)
+    {
+        if(plain())
+        {
+            char buf[DEC_BUF_SIZE + 1];
+            char* last = std::is_signed<T>::value
+                             ? i64_to_dec(buf, static_cast<std::int64_t>(v))
+                             : u64_to_dec(buf, static_cast<std::uint64_t>(v));
+            os.write(buf, last - buf);
+        }
+        else { os << v; }
+        return *this;
+    }
+    template <typename Rep, typename Period>
+    inline LogStream& operator<<(std::chrono::duration<Rep, Period> d)
+    {
+        os << nstd::duration(d);
+        return *this;
+    }
+    template <typename Duration>
+    inline LogStream& operator<<(std::chrono::time_point<std::chrono::system_clock, Duration> tp)
+    {
+        using namespace std::chrono;
+        os << nstd::timestamp(time_point_cast<system_clock::duration>(tp));
+        return *this;
+    }
+    inline LogStream& operator<<(std::ostream& (*manip)(std::ostream&))
+    {
+        manip(os);
+        return *this;
+    }
+    inline LogStream& operator<<(std::ios_base& (*manip)(std::ios_base&))
+    {
+        manip(os);
+        return *this;
+    }
+};
+
+/* The per call site state of the log macros. Every NSTD_LOG/NSTD_LOGGER expansion owns a static
+ * one. Filters cache what they resolved for the call site here (see log_filter.hpp), so the string
+ * predicates are evaluated once per call site instead of once per record.
+ */
+struct LogSite {
+    static constexpr std::size_t CACHE_SLOTS = 4;
+    std::atomic<std::uint64_t> cache[CACHE_SLOTS] = {};
+};
+
 struct LogMetaData {
     template <typename T, nstd::enable_if_t<nstd::is_base_of_v<LogType, T>, bool> = true>
     LogMetaData(T lt,
@@ -303,8 +415,9 @@ struct LogMetaData {
                 std::string&& func_,
                 std::string&& mod = "",
                 unsigned int col  = 0)
-        : log_type(nstd::make_self_ref<LogType, T>(lt)), file(std::move(file_)), line(line_),
-          func(std::move(func_)), log_mod(std::move(mod)), colum(col)
+        : log_type(nstd::make_self_ref<LogType, T>(lt)), log_mod(std::move(mod)),
+          file(std::move(file_)), func(std::move(func_)), line(line_),
+          context(LogContext::current().view()), colum(col)
     {
     }
     nstd::SelfRef<LogType> log_type;
@@ -312,6 +425,11 @@ struct LogMetaData {
     std::string file;
     std::string func;
     unsigned int line;
+    // The NSTD_LOG_SCOPE_CTX entries of the logging thread. It refers to the thread's context
+    // rather than copying it, so a logger that defers the output must take its own copy.
+    nstd::LogContextView context;
+    // The call site of the log macro. nullptr if the metadata isn't made by the log macros.
+    LogSite* site = nullptr;
 
 private:
     unsigned int colum = 0;  // Now we can't provide colum. So it' private.
@@ -330,17 +448,17 @@ public:
 };
 
 struct ProcStart {
-    static const std::chrono::steady_clock proc_start;
+    static const std::chrono::steady_clock::time_point proc_start;
 };
 
 class GlobalLogger {
-    static std::mutex mtx;
+    static std::timed_mutex mtx;
     static std::map<std::size_t, std::shared_ptr<Logger>> glogger;
 
 public:
     static LogResult add_logger(std::shared_ptr<Logger> plogger) noexcept;
     static LogResult remove_logger(std::shared_ptr<Logger> plogger) noexcept;
-    static std::mutex& global_logger_mutex() noexcept;
+    static std::timed_mutex& global_logger_mutex() noexcept;
     static std::map<std::size_t, std::shared_ptr<Logger>>& global_logger() noexcept;
 };
 
@@ -0,0 +1,130 @@
+#ifndef __NSTD_LOG_CONTEXT_HPP__
+#define __NSTD_LOG_CONTEXT_HPP__
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include "marker.hpp"
+#include "type_traits.hpp"
+
+namespace nstd {
+
+#define __NSTD_LOG_CTX_CAPACITY 16    // entries per thread
+#define __NSTD_LOG_CTX_VALUE_SIZE 46  // bytes per value, longer values are truncated
+
+#define __NSTD_LOG_CTX_CONCAT_IMPL(A, B) A##B
+#define __NSTD_LOG_CTX_CONCAT(A, B) __NSTD_LOG_CTX_CONCAT_IMPL(A, B)
+
+// Push (key, value) to the log context of current thread until the end of the scope.
+// The key must have static storage duration, usually it's a string literal.
+#define NSTD_LOG_SCOPE_CTX(key, value) \
+    nstd::LogContextScope __NSTD_LOG_CTX_CONCAT(_nstd_log_ctx_, __COUNTER__)(key, value)
+
+struct LogContextEntry {
+    const char* key;
+    unsigned char size;
+    char value[__NSTD_LOG_CTX_VALUE_SIZE];
+    inline std::string_view get_value() const noexcept { return std::string_view(value, size); }
+};
+
+// A reference to the entries of a log context. It doesn't own the entries.
+struct LogContextView {
+    const LogContextEntry* first = nullptr;
+    const LogContextEntry* last  = nullptr;
+    inline constexpr const LogContextEntry* begin() const noexcept { return first; }
+    inline constexpr const LogContextEntry* end() const noexcept { return last; }
+    inline constexpr std::size_t size() const noexcept { return std::size_t(last - first); }
+    inline constexpr bool empty() const noexcept { return first == last; }
+};
+
+/* The context as the built-in sinks render it, before the message: "[key=value key=value] ", and
+ * nothing if it's empty. render_log_context writes log_context_size(view) bytes at out and returns
+ * the end of them.
+ */
+std::size_t log_context_size(LogContextView view) noexcept;
+char* render_log_context(char* out, LogContextView view) noexcept;
+
+class LogContextSnapshot;
+
+/* The mapped diagnostic context of a thread. It's a fixed size stack living in thread local
+ * storage, so push and pop never allocate. Pushing to a full stack drops the entry (but keeps the
+ * push/pop balanced).
+ */
+class LogContext {
+    LogContextEntry entries[__NSTD_LOG_CTX_CAPACITY];
+    std::size_t depth   = 0;
+    std::size_t dropped = 0;
+
+    friend class LogContextSnapshot;
+
+public:
+    constexpr LogContext() noexcept : entries{} {}
+    static LogContext& current() noexcept;
+    void push(const char* key, std::string_view value) noexcept;
+    void push(const char* key, const char* value) noexcept;
+    void push(const char* key, long long value) noexcept;
+    void push(const char* key, unsigned long long value) noexcept;
+    template <typename T, nstd::enable_if_t<nstd::is_integral_v<T>, bool> = true>
+    inline void push(const char* key, T value) noexcept
+    {
+        IF_CONSTEXPR(std::is_signed<T>::value) { push(key, static_cast<long long>(value)); }
+        else { push(key, static_cast<unsigned long long>(value)); }
+    }
+    void pop() noexcept;
+    inline LogContextView view() const noexcept
+    {
+        return LogContextView{entries, entries + depth};
+    }
+};
+
+// A copy of a log context, used to carry the context across threads or coroutine resumptions.
+class LogContextSnapshot {
+    LogContextEntry entries[__NSTD_LOG_CTX_CAPACITY];
+    std::size_t depth   = 0;
+    std::size_t dropped = 0;
+
+public:
+    constexpr LogContextSnapshot() noexcept : entries{} {}
+    // Copy the context of current thread.
+    static LogContextSnapshot capture() noexcept;
+    // Replace the context of current thread with this snapshot.
+    void install() const noexcept;
+    inline LogContextView view() const noexcept
+    {
+        return LogContextView{entries, entries + depth};
+    }
+};
+
+class LogContextScope {
+public:
+    template <typename V>
+    LogContextScope(const char* key, V&& value) noexcept
+    {
+        LogContext::current().push(key, std::forward<V>(value));
+    }
+    LogContextScope(const LogContextScope&)            = delete;
+    LogContextScope& operator=(const LogContextScope&) = delete;
+    ~LogContextScope() { LogContext::current().pop(); }
+};
+
+// Install a captured context on the current thread, and put back the previous one at the end of
+// the scope. e.g.
+//     auto ctx = nstd::LogContextSnapshot::capture();
+//     pool.submit([ctx] { nstd::LogContextRestore restore(ctx); ... });
+class LogContextRestore {
+    LogContextSnapshot previous;
+
+public:
+    explicit LogContextRestore(const LogContextSnapshot& snapshot) noexcept
+        : previous(LogContextSnapshot::capture())
+    {
+        snapshot.install();
+    }
+    LogContextRestore(const LogContextRestore&)            = delete;
+    LogContextRestore& operator=(const LogContextRestore&) = delete;
+    ~LogContextRestore() { previous.install(); }
+};
+
+}  // namespace nstd
+
+#endif
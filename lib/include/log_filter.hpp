@@ -0,0 +1,108 @@
+#ifndef __NSTD_LOG_FILTER_HPP__
+#define __NSTD_LOG_FILTER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log.hpp"
+#include "result.hpp"
+
+namespace nstd {
+
+/* A log filter compiled from an expression like
+ *     level>=WARN || (module=net.* && file~"http")
+ * Grammar:
+ *     expr  := and ('||' and)*
+ *     and   := unary ('&&' unary)*
+ *     unary := '!' unary | '(' expr ')' | 'true' | 'false' | pred
+ *     pred  := 'level' ('>=' | '>' | '<=' | '<' | '=' | '==' | '!=') LEVEL
+ *            | ('module' | 'file' | 'func') ('=' | '==' | '!=') PATTERN  // glob with '*' and '?'
+ *            | ('module' | 'file' | 'func') '~' PATTERN                  // contains
+ * LEVEL is one of TRACE, DEBUG, INFO, WARN, ERROR, FATAL, PERF, FUNC (case insensitive). The
+ * ordering comparisons only cover TRACE < DEBUG < INFO < WARN < ERROR < FATAL. PATTERN is a bare
+ * word or a double quoted string.
+ *
+ * The expression is compiled into a small bytecode over two inputs: the level mask and a bitmask
+ * of the string predicates. With few string predicates, the bytecode is folded into a decision
+ * table indexed by both. The string predicates only depend on the call site, so their bitmask is
+ * resolved once per LogSite and cached there; most records are filtered by a table lookup.
+ */
+class LogFilter {
+public:
+    enum class Field : unsigned char
+    {
+        MODULE,
+        FILE,
+        FUNC,
+    };
+    enum class Match : unsigned char
+    {
+        GLOB,
+        CONTAINS,
+    };
+    struct StrPred {
+        Field field;
+        Match match;
+        std::string pattern;
+    };
+    enum class Op : unsigned char
+    {
+        LEVEL,  // push (level & arg) != 0
+        PRED,   // push bit `arg` of the predicate bitmask
+        CONST,  // push arg != 0
+        NOT,
+        AND,
+        OR,
+    };
+    struct Instr {
+        Op op;
+        unsigned int arg;
+    };
+    static constexpr std::size_t MAX_PREDS       = 32;
+    static constexpr std::size_t MAX_TABLE_PREDS = 6;
+
+private:
+    std::uint32_t m_id = 0;  // unique per compiled filter, tags the LogSite cache entries
+    std::vector<Instr> m_code;
+    std::vector<StrPred> m_preds;
+    // (level & 0xFF) << preds | pred_bits -> bit. Empty if there are too many predicates.
+    std::vector<std::uint64_t> m_table;
+
+    LogFilter() = default;
+    bool run(unsigned int level, std::uint32_t pred_bits) const noexcept;
+
+public:
+    static nstd::Result<LogFilter, nstd::Error> compile(std::string_view expr);
+    inline const std::vector<Instr>& code() const noexcept { return m_code; }
+    inline const std::vector<StrPred>& predicates() const noexcept { return m_preds; }
+    // Evaluate the string predicates.
+    std::uint32_t resolve(std::string_view module,
+                          std::string_view file,
+                          std::string_view func) const noexcept;
+    inline bool evaluate(unsigned int level, std::uint32_t pred_bits) const noexcept
+    {
+        if(!m_table.empty())
+        {
+            std::size_t idx = (std::size_t(level & 0xFF) << m_preds.size()) | pred_bits;
+            return (m_table[idx >> 6] >> (idx & 63)) & 1;
+        }
+        return run(level, pred_bits);
+    }
+    inline bool evaluate(unsigned int level,
+                         std::string_view module,
+                         std::string_view file,
+                         std::string_view func) const noexcept
+    {
+        return evaluate(level, resolve(module, file, func));
+    }
+    // For Logger::enabled. Uses the cache in md.site when there is one.
+    bool enabled(const LogMetaData& md) const noexcept;
+};
+
+// Match text with a glob pattern ('*' any run, '?' any char).
+bool glob_match(std::string_view pattern, std::string_view text) noexcept;
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef __NSTD_LOG_PARSER_HPP__
+#define __NSTD_LOG_PARSER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "error.hpp"
+#include "log.hpp"
+#include "result.hpp"
+
+#if defined(__AVX2__)
+#define __NSTD_LOG_PARSER_HAS_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define __NSTD_LOG_PARSER_HAS_SSE2
+#endif
+
+namespace nstd {
+
+/* One line of nstd log output. All the views point into the parsed text, so the text (usually a
+ * MappedFile) must outlive the records.
+ * Lines written by __NSTD_WARNING/__NSTD_ERROR look like "[nstd(Warn)]  file:line. message", a
+ * location may also carry a column, "file:line:col. message".
+ * Lines without that prefix (e.g. the output of a custom sink) are kept as LOG_NON records whose
+ * message is the whole line.
+ */
+struct LogRecord {
+    unsigned int level = LogType::LOG_NON;
+    std::string_view file;
+    unsigned int line   = 0;
+    unsigned int column = 0;  // 0 if the location has none
+    std::string_view message;
+};
+
+// A read only view of a whole file. It's mmap'ed where the platform supports it.
+class MappedFile {
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+#if !(defined(__unix__) || defined(__APPLE__))
+    std::string m_buf;
+#endif
+
+    MappedFile() = default;
+
+public:
+    static nstd::Result<MappedFile, nstd::Error> map(const std::string& path) noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+    inline const char* data() const noexcept { return m_data; }
+    inline std::size_t size() const noexcept { return m_size; }
+    inline std::string_view view() const noexcept { return std::string_view(m_data, m_size); }
+};
+
+// Find the first `c` in [first, last). Return last if there is none.
+const char* find_byte(const char* first, const char* last, char c) noexcept;
+
+// Split text into at most `count` chunks. Every chunk but the last one ends right after a '\n'.
+std::vector<std::string_view> split_lines_chunks(std::string_view text, std::size_t count);
+
+// Parse one line (without the trailing '\n').
+LogRecord parse_log_line(std::string_view line) noexcept;
+
+class LogParser {
+    unsigned int m_jobs;
+
+public:
+    // jobs == 0 means using all the hardware threads.
+    explicit LogParser(unsigned int jobs = 0) noexcept;
+    inline unsigned int jobs() const noexcept { return m_jobs; }
+    // Parse the whole text in parallel. The records keep the order of the lines in the text.
+    std::vector<LogRecord> parse(std::string_view text) const;
+    // Parse the text in parallel and hand every chunk's records to `visit(chunk_index, records)`.
+    // `visit` is called from the worker threads, once per chunk.
+    template <typename Visitor>
+    void parse_chunks(std::string_view text, Visitor&& visit) const;
+
+private:
+    static void parse_chunk(std::string_view chunk, std::vector<LogRecord>& records);
+    void run_parallel(std::size_t count, void (*job)(std::size_t, void*), void* ctx) const;
+};
+
+template <typename Visitor>
+void LogParser::parse_chunks(std::string_view text, Visitor&& visit) const
+{
+    struct Ctx {
+        std::vector<std::string_view> chunks;
+        nstd::remove_reference_t<Visitor>* visit;
+    } ctx{split_lines_chunks(text, m_jobs), &visit};
+    run_parallel(
+        ctx.chunks.size(),
+        [](std::size_t i, void* p) {
+            Ctx& c = *static_cast<Ctx*>(p);
+            std::vector<LogRecord> records;
+            parse_chunk(c.chunks[i], records);
+            (*c.visit)(i, static_cast<const std::vector<LogRecord>&>(records));
+        },
+        &ctx);
+}
+
+}  // namespace nstd
+
+#endif
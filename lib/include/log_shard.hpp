@@ -0,0 +1,95 @@
+#ifndef __NSTD_LOG_SHARD_HPP__
+#define __NSTD_LOG_SHARD_HPP__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log.hpp"
+#include "log_parser.hpp"
+#include "result.hpp"
+
+namespace nstd {
+
+/* A logger writing every thread to its own file (a shard), so threads share no lock or queue.
+ * Every record carries a steady clock timestamp and a per shard sequence number; ShardMerger merges
+ * the shards back into one time ordered stream.
+ * Use it with NSTD_LOGGER: NSTD_LOG takes the lock of the global logger.
+ * A shard is flushed when its buffer is full, when its thread calls flush(), and at thread exit.
+ * flush() only flushes the shard of the calling thread.
+ * log() fails with Errc::IO_ERROR when a shard can't be written, e.g. the disk is full: the records
+ * buffered in the shard are lost.
+ *
+ * Shard file: "NSTDSHRD" magic, u32 version, u32 shard id (unique in the process), then records of
+ *     u64 timestamp (ns), u64 seq, u32 level, u32 size, payload[size]
+ * in host byte order. The payload is the text line "[nstd(Level)]  file:line. message\n", with the
+ * NSTD_LOG_SCOPE_CTX entries of the thread before the message (see render_log_context).
+ */
+class ShardedFileLogger : public Logger {
+    std::uint64_t m_id;
+    std::string m_dir;
+    std::string m_prefix;
+    unsigned int m_levels;
+    std::size_t m_buf_size;
+
+public:
+    static constexpr char MAGIC[8]          = {'N', 'S', 'T', 'D', 'S', 'H', 'R', 'D'};
+    static constexpr std::uint32_t VERSION  = 1;
+    static constexpr std::size_t HEADER_SIZE = 16;
+    static constexpr std::size_t RECORD_HEADER_SIZE = 24;
+
+    // Shards are named "<dir>/<prefix>.<pid>.<logger>.<shard>.nlog", the logger id is unique in the
+    // process, so loggers sharing a dir and a prefix don't overwrite each other's shards. `levels`
+    // is the mask of enabled levels.
+    ShardedFileLogger(std::string dir,
+                      std::string prefix,
+                      unsigned int levels  = ~0u,
+                      std::size_t buf_size = 1 << 20);
+    bool enabled(const LogMetaData& md) override;
+    LogResult log(LogMetaData&& md) override;
+    void flush() noexcept override;
+};
+
+struct ShardRecord {
+    std::uint64_t timestamp = 0;
+    std::uint64_t seq       = 0;
+    std::uint32_t shard     = 0;
+    unsigned int level      = LogType::LOG_NON;
+    std::string_view payload;
+};
+
+// Sequential reader of one shard. The payloads point into the mapped shard.
+class ShardReader {
+    MappedFile m_file;
+    std::uint32_t m_shard;
+    std::size_t m_pos;
+
+    ShardReader(MappedFile&& file, std::uint32_t shard) noexcept;
+
+public:
+    static nstd::Result<ShardReader, nstd::Error> open(const std::string& path) noexcept;
+    inline std::uint32_t shard() const noexcept { return m_shard; }
+    // Read the next record. Return false at the end (or at a truncated tail record).
+    bool next(ShardRecord& rec) noexcept;
+};
+
+// K-way merge of shards ordered by (timestamp, shard, seq).
+class ShardMerger {
+    std::vector<ShardReader> m_readers;
+    std::vector<ShardRecord> m_heads;
+    std::vector<std::size_t> m_heap;  // indexes into m_heads
+
+    void sift_down(std::size_t i) noexcept;
+    bool less(std::size_t a, std::size_t b) const noexcept;
+
+public:
+    static nstd::Result<ShardMerger, nstd::Error> open(const std::vector<std::string>& paths);
+    bool next(ShardRecord& rec) noexcept;
+};
+
+// The shard files of `prefix` in `dir`, sorted by name.
+std::vector<std::string> list_shards(const std::string& dir, const std::string& prefix);
+
+}  // namespace nstd
+
+#endif
@@ -2,7 +2,9 @@
 #define __NSTD_OPTION_HPP__
 
 #include <cassert>
+#include <type_traits>
 #include "type_traits.hpp"
+#include "utility.hpp"
 #include "variant.hpp"
 
 namespace nstd {
@@ -13,27 +15,39 @@ enum OptionStatus
     NONE,
 };
 
+namespace _internal0_impl0_option {
+    // True for a single argument of type Self, which is a copy or a move, not a construction.
+    template <typename Self, typename... Args>
+    struct is_self : std::false_type {};
+    template <typename Self, typename Arg>
+    struct is_self<Self, Arg> : std::is_same<Self, nstd::decay_t<Arg>> {};
+}  // namespace _internal0_impl0_option
+
 template <typename SomeType>
 class Some {
 private:
     SomeType value;
 
 public:
-    template<typename... Args>
-    Some(Args&&... args): value(std::forward<Args>(args)...)
+    template <
+        typename... Args,
+        nstd::enable_if_t<!_internal0_impl0_option::is_self<Some<SomeType>, Args...>::value,
+                          bool> = true>
+    constexpr Some(Args&&... args) : value(std::forward<Args>(args)...)
     {
     }
-    Some(Some<SomeType>&& some) : value(std::move(some.value)) {}
-    Some(const Some<SomeType>& some) : value(some.value) {}
+    // Defaulted, so a Some of a trivially copyable type is trivially copyable.
+    Some(Some<SomeType>&&)                           = default;
+    Some(const Some<SomeType>&)                      = default;
     Some<SomeType>& operator=(Some<SomeType>&&)      = default;
     Some<SomeType>& operator=(const Some<SomeType>&) = default;
-    inline constexpr nstd::add_const_t<nstd::add_lvalue_reference_t<SomeType>>
-    operator*() const noexcept
+    // The const goes on the value, a Some<T&> keeps giving a T&.
+    inline constexpr nstd::add_lvalue_reference_t<const SomeType> operator*() const noexcept
     {
         return value;
     }
     inline constexpr nstd::add_lvalue_reference_t<SomeType> operator*() noexcept { return value; }
-    inline constexpr nstd::add_const_t<nstd::add_pointer_t<SomeType>> operator->() const noexcept
+    inline constexpr nstd::add_pointer_t<const SomeType> operator->() const noexcept
     {
         return &value;
     }
@@ -42,55 +56,259 @@ public:
 
 using None = nstd::monostate;
 
+/* A type with a value which is never a valid T can declare it as its niche, then Option<T> keeps
+ * that value for None and has no discriminant: sizeof(Option<T>) == sizeof(T). Specialize
+ * niche_traits<T> with
+ *     static constexpr T none() noexcept;                 // the invalid value
+ *     static constexpr bool is_none(const T& v) noexcept;
+ * or, for an enum with a reserved value, derive it from niche_value:
+ *     template <> struct nstd::niche_traits<Color> : nstd::niche_value<Color, Color::INVALID> {};
+ * NotNull has a niche, and Option<T&> is a pointer. A raw pointer has none: Some(nullptr) isn't
+ * None.
+ */
+template <typename T>
+struct niche_traits {};
+
+template <typename T, T Invalid>
+struct niche_value {
+    static constexpr T none() noexcept { return Invalid; }
+    static constexpr bool is_none(const T& v) noexcept { return v == Invalid; }
+};
+
+namespace _internal0_impl0_option {
+    template <typename T, typename = void>
+    struct has_niche : std::false_type {};
+    template <typename T>
+    struct has_niche<T, std::void_t<decltype(niche_traits<T>::none())>> : std::true_type {};
+
+    // Some<T> and None in a variant, the index is the status.
+    template <typename T, bool = has_niche<T>::value>
+    class Storage {
+        nstd::variant<Some<T>, None> m_value;
+
+    public:
+        constexpr Storage() noexcept : m_value(nstd::in_place_index<1>) {}
+        template <typename S>
+        constexpr Storage(nstd::in_place_t, S&& some)
+            : m_value(nstd::in_place_index<0>, std::forward<S>(some))
+        {
+        }
+        template <typename... Args>
+        constexpr Storage(nstd::in_place_index_t<0>, Args&&... args)
+            : m_value(nstd::in_place_index<0>, std::forward<Args>(args)...)
+        {
+        }
+        constexpr bool has_value() const noexcept { return m_value.index() == 0; }
+        constexpr T& get() noexcept { return *nstd::get<0>(m_value); }
+        constexpr const T& get() const noexcept { return *nstd::get<0>(m_value); }
+    };
+
+    // The niche of T is None.
+    template <typename T>
+    class Storage<T, true> {
+        T m_value;
+
+    public:
+        constexpr Storage() noexcept : m_value(niche_traits<T>::none()) {}
+        constexpr Storage(nstd::in_place_t, Some<T>&& some) : m_value(std::move(*some)) {}
+        constexpr Storage(nstd::in_place_t, const Some<T>& some) : m_value(*some) {}
+        template <typename... Args>
+        constexpr Storage(nstd::in_place_index_t<0>, Args&&... args)
+            : m_value(std::forward<Args>(args)...)
+        {
+        }
+        constexpr bool has_value() const noexcept { return !niche_traits<T>::is_none(m_value); }
+        constexpr T& get() noexcept { return m_value; }
+        constexpr const T& get() const noexcept { return m_value; }
+    };
+
+    // A reference is never null, a null pointer is None.
+    template <typename T>
+    class Storage<T&, false> {
+        T* m_value;
+
+    public:
+        constexpr Storage() noexcept : m_value(nullptr) {}
+        constexpr Storage(nstd::in_place_t, const Some<T&>& some) : m_value(&*some) {}
+        constexpr Storage(nstd::in_place_index_t<0>, T& value) : m_value(&value) {}
+        constexpr bool has_value() const noexcept { return m_value != nullptr; }
+        constexpr T& get() const noexcept { return *m_value; }
+    };
+}  // namespace _internal0_impl0_option
+
+/* Some value or None. The copy, the move and the destruction are trivial if those of SomeType are,
+ * and only the variant index is kept for the status, or nothing at all with a niche (see
+ * niche_traits).
+ * The combinators come in &, const& and && forms: on an rvalue Option they move the value into the
+ * function or the result, so a chain of them on a temporary copies nothing.
+ */
 template <typename SomeType>
-class Option : nstd::variant<Some<SomeType>, None> {
+class Option : _internal0_impl0_option::Storage<SomeType> {
 private:
-    OptionStatus m_status;
+    using Base = _internal0_impl0_option::Storage<SomeType>;
 
-public:
-    Option(Some<SomeType>&& some)
-        : m_status(OptionStatus::SOME), nstd::variant<Some<SomeType>, None>(
-                                            nstd::in_place_type<Some<SomeType>>, std::move(some))
+    template <typename Self, typename F>
+    static constexpr auto map_impl(Self&& self, F&& f)
+    {
+        using R = Option<nstd::decay_t<
+            std::invoke_result_t<F, decltype(std::forward<Self>(self).unwrap())>>>;
+        if(self.is_some())
+        {
+            return R(nstd::in_place, std::forward<F>(f)(std::forward<Self>(self).unwrap()));
+        }
+        return R();
+    }
+    template <typename Self, typename F>
+    static constexpr auto and_then_impl(Self&& self, F&& f)
     {
+        using R =
+            nstd::decay_t<std::invoke_result_t<F, decltype(std::forward<Self>(self).unwrap())>>;
+        if(self.is_some()) { return std::forward<F>(f)(std::forward<Self>(self).unwrap()); }
+        return R();
     }
-    Option(const Some<SomeType>& some)
-        : m_status(OptionStatus::SOME), nstd::variant<Some<SomeType>, None>(
-                                            nstd::in_place_type<Some<SomeType>>, some)
+    template <typename Self, typename F>
+    static constexpr Option<SomeType> or_else_impl(Self&& self, F&& f)
     {
+        static_assert(std::is_same_v<nstd::decay_t<std::invoke_result_t<F>>, Option<SomeType>>,
+                      "The function of or_else must return an Option of the same type.");
+        if(self.is_some()) { return std::forward<Self>(self); }
+        return std::forward<F>(f)();
     }
-    Option()
-        : m_status(OptionStatus::NONE), nstd::variant<Some<SomeType>, None>(
-                                            std::in_place_type<None>, None{})
+    template <typename Self, typename U>
+    static constexpr SomeType unwrap_or_impl(Self&& self, U&& default_value)
     {
+        if(self.is_some()) { return std::forward<Self>(self).unwrap(); }
+        return static_cast<SomeType>(std::forward<U>(default_value));
     }
-    Option(const Option<SomeType>& option)
-        : m_status(option.m_status), nstd::variant<Some<SomeType>, None>(option)
+    template <typename Self, typename F>
+    static constexpr SomeType value_or_else_impl(Self&& self, F&& f)
     {
+        if(self.is_some()) { return std::forward<Self>(self).unwrap(); }
+        return std::forward<F>(f)();
     }
-    Option(Option<SomeType>&& option)
-        : m_result(option.m_status), nstd::variant<Some<SomeType>, None>(std::move(option))
+
+public:
+    // The value is constructed in place from args, for Option<T&> from a T&.
+    template <typename... Args>
+    constexpr explicit Option(nstd::in_place_t, Args&&... args)
+        : Base(nstd::in_place_index<0>, std::forward<Args>(args)...)
     {
     }
+    constexpr Option(Some<SomeType>&& some) : Base(nstd::in_place, std::move(some)) {}
+    constexpr Option(const Some<SomeType>& some) : Base(nstd::in_place, some) {}
+    constexpr Option() noexcept : Base() {}
+    constexpr Option(None) noexcept : Base() {}
+    Option(const Option<SomeType>&)                      = default;
+    Option(Option<SomeType>&&)                           = default;
     Option<SomeType>& operator=(Option<SomeType>&&)      = default;
     Option<SomeType>& operator=(const Option<SomeType>&) = default;
-    tempalte<typename... Args>
-    inline static Option<SomeType> some(Args&&... args)
+    template <typename... Args>
+    inline static constexpr Option<SomeType> some(Args&&... args)
+    {
+        return Option<SomeType>(nstd::in_place, std::forward<Args>(args)...);
+    }
+    inline static constexpr Option<SomeType> none() noexcept { return Option<SomeType>(); }
+
+    inline constexpr OptionStatus status() const noexcept
+    {
+        return Base::has_value() ? OptionStatus::SOME : OptionStatus::NONE;
+    }
+    inline constexpr operator OptionStatus() const noexcept { return status(); }
+    inline constexpr bool is_some() const noexcept { return Base::has_value(); }
+    inline constexpr bool is_none() const noexcept { return !Base::has_value(); }
+    inline constexpr decltype(auto) unwrap() & noexcept
+    {
+        assert(is_some());
+        return Base::get();
+    }
+    inline constexpr decltype(auto) unwrap() const& noexcept
     {
-        return Option<SomeType>(Some<SomeType>(std::forward<Args>(args)...));
+        assert(is_some());
+        return Base::get();
+    }
+    inline constexpr decltype(auto) unwrap() && noexcept
+    {
+        assert(is_some());
+        return std::forward<SomeType>(Base::get());
     }
 
-    inline constexpr OptionStatus status() const noexcept { return m_status; }
-    inline constexpr operator OptionStatus() const noexcept { return m_status; }
-    inline constexpr bool is_some() const noexcept { return OptionStatus::SOME == m_status; }
-    inline constexpr bool is_none() const noexcept { return OptionStatus::NONE == m_status; }
+    // Option<U> of f(value), U the decayed type returned by f.
+    template <typename F>
+    inline constexpr auto map(F&& f) &
+    {
+        return map_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map(F&& f) const&
+    {
+        return map_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map(F&& f) &&
+    {
+        return map_impl(std::move(*this), std::forward<F>(f));
+    }
+    // f(value), an Option itself, or None.
+    template <typename F>
+    inline constexpr auto and_then(F&& f) &
+    {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto and_then(F&& f) const&
+    {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto and_then(F&& f) &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+    // This Option if it's some, f() otherwise, an Option<SomeType> too.
+    template <typename F>
+    inline constexpr Option<SomeType> or_else(F&& f) const&
+    {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr Option<SomeType> or_else(F&& f) &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <typename U>
+    inline constexpr SomeType unwrap_or(U&& default_value) const&
+    {
+        return unwrap_or_impl(*this, std::forward<U>(default_value));
+    }
+    template <typename U>
+    inline constexpr SomeType unwrap_or(U&& default_value) &&
+    {
+        return unwrap_or_impl(std::move(*this), std::forward<U>(default_value));
+    }
+    // The value, or f() if it's none. f is only called then.
+    template <typename F>
+    inline constexpr SomeType value_or_else(F&& f) const&
+    {
+        return value_or_else_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr SomeType value_or_else(F&& f) &&
+    {
+        return value_or_else_impl(std::move(*this), std::forward<F>(f));
+    }
 };
 
 template <typename T, nstd::enable_if_t<nstd::is_pointer_v<T>, bool> = true>
 class NotNull {
     T p;
 
+    struct NullTag {};
+    // The niche of Option<NotNull<T>>, the only null NotNull.
+    constexpr NotNull(NullTag) noexcept : p(nullptr) {}
+    friend struct niche_traits<NotNull<T>>;
+
 public:
-    NotNull(T ptr) : p(ptr) { assert(ptr != nullptr); }
+    constexpr NotNull(T ptr) : p(ptr) { assert(ptr != nullptr); }
     inline constexpr nstd::add_const_t<nstd::add_lvalue_reference_t<nstd::remove_pointer_t<T>>>
     operator*() const noexcept
     {
@@ -102,10 +320,17 @@ public:
     }
     inline constexpr nstd::add_const_t<T> operator->() const noexcept { return p; }
     inline constexpr T operator->() noexcept { return p; }
-    inline constexpr T get() noexcept { return p; }
+    inline constexpr T get() const noexcept { return p; }
 };
 
-class MayNull;
+template <typename T>
+struct niche_traits<NotNull<T>> {
+    static constexpr NotNull<T> none() noexcept
+    {
+        return NotNull<T>(typename NotNull<T>::NullTag{});
+    }
+    static constexpr bool is_none(const NotNull<T>& v) noexcept { return v.p == nullptr; }
+};
 
 template <typename T, nstd::enable_if_t<nstd::is_pointer_v<T>, bool> = true>
 class MayNull {
@@ -0,0 +1,289 @@
+#ifndef __NSTD_OPTION_VEC_HPP__
+#define __NSTD_OPTION_VEC_HPP__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "marker.hpp"
+#include "option.hpp"
+#include "type_traits.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_option_vec {
+    constexpr std::size_t WORD_BITS = 64;
+    constexpr std::uint64_t ALL_SOME = ~std::uint64_t(0);
+
+    inline constexpr std::size_t words(std::size_t n) noexcept
+    {
+        return (n + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    inline std::size_t popcount(std::uint64_t w) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return std::size_t(__builtin_popcountll(w));
+#else
+        std::size_t n = 0;
+        for(; w != 0; w &= w - 1) { ++n; }
+        return n;
+#endif
+    }
+
+    // The index of the lowest set bit, w isn't 0.
+    inline int lowest_bit(std::uint64_t w) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(w);
+#else
+        int n = 0;
+        for(; (w & 1) == 0; w >>= 1) { ++n; }
+        return n;
+#endif
+    }
+
+    // std::vector<bool> packs the bits, it has neither data() nor a real bool&. The bools are held
+    // one per byte in cells instead, which convert to the bool they hold.
+    struct BoolCell {
+        bool value = false;
+        BoolCell() = default;
+        BoolCell(bool v) noexcept : value(v) {}
+        operator bool&() noexcept { return value; }
+        operator const bool&() const noexcept { return value; }
+    };
+    static_assert(sizeof(BoolCell) == sizeof(bool), "The bool column is read as a bool array.");
+
+    template <typename T>
+    using cell_t = std::conditional_t<std::is_same_v<T, bool>, BoolCell, T>;
+}  // namespace _internal0_impl0_option_vec
+
+/* A vector of Option<T> in columns, like an Arrow array: the values are contiguous and the status
+ * is one bit per element in a validity bitmap. It takes sizeof(T) + 1/8 bytes per element, where
+ * a std::vector<Option<T>> pays the variant index and its padding, e.g. 4.125 bytes instead of 8
+ * for an int. A T with a niche is as small in a plain vector, the columns still pay off for the
+ * scans. A None element still holds a T, value initialized, so T must be default constructible.
+ * The bulk operations walk the bitmap a word at a time: a word of 64 some elements is a plain loop
+ * over the values, which the compiler vectorizes, a word of none is skipped. An OptionVec<bool>
+ * holds a byte per value, not a bit, so that its elements can be referred to.
+ */
+template <typename T>
+class OptionVec {
+    static_assert(!std::is_reference_v<T>, "OptionVec holds values, not references.");
+    static_assert(std::is_default_constructible_v<T>,
+                  "The None elements of an OptionVec hold a value initialized T.");
+
+    using Cell = _internal0_impl0_option_vec::cell_t<T>;
+
+    std::vector<Cell> m_values;
+    std::vector<std::uint64_t> m_valid;  // bit i of word i / 64 set if element i is some
+
+    template <typename U>
+    friend class OptionVec;
+
+    inline T& ref(std::size_t i) noexcept { return static_cast<T&>(m_values[i]); }
+    inline const T& ref(std::size_t i) const noexcept
+    {
+        return static_cast<const T&>(m_values[i]);
+    }
+
+    inline void push_bit(bool some)
+    {
+        std::size_t i = m_values.size() - 1;
+        if(i % _internal0_impl0_option_vec::WORD_BITS == 0) { m_valid.push_back(0); }
+        m_valid.back() |= std::uint64_t(some) << (i % _internal0_impl0_option_vec::WORD_BITS);
+    }
+    // The first n elements some, the rest of the bitmap none.
+    inline void set_some_prefix(std::size_t n)
+    {
+        using namespace _internal0_impl0_option_vec;
+        m_valid.assign(words(m_values.size()), 0);
+        for(std::size_t w = 0; w < n / WORD_BITS; ++w) { m_valid[w] = ALL_SOME; }
+        if(n % WORD_BITS != 0) { m_valid[n / WORD_BITS] = ALL_SOME >> (WORD_BITS - n % WORD_BITS); }
+    }
+    // f(i) for every some element, in order.
+    template <typename F>
+    inline void visit_some(F&& f) const
+    {
+        using namespace _internal0_impl0_option_vec;
+        for(std::size_t w = 0; w < m_valid.size(); ++w)
+        {
+            std::uint64_t bits = m_valid[w];
+            std::size_t base   = w * WORD_BITS;
+            if(bits == ALL_SOME)
+            {
+                for(std::size_t i = base; i < base + WORD_BITS; ++i) { f(i); }
+            }
+            else
+            {
+                for(; bits != 0; bits &= bits - 1) { f(base + std::size_t(lowest_bit(bits))); }
+            }
+        }
+    }
+
+public:
+    OptionVec() = default;
+    // n None elements.
+    explicit OptionVec(std::size_t n)
+        : m_values(n), m_valid(_internal0_impl0_option_vec::words(n), 0)
+    {
+    }
+
+    inline std::size_t size() const noexcept { return m_values.size(); }
+    inline bool empty() const noexcept { return m_values.empty(); }
+    inline void reserve(std::size_t n)
+    {
+        m_values.reserve(n);
+        m_valid.reserve(_internal0_impl0_option_vec::words(n));
+    }
+    inline void clear() noexcept
+    {
+        m_values.clear();
+        m_valid.clear();
+    }
+    // The bytes held by the values and the bitmap.
+    inline std::size_t memory_bytes() const noexcept
+    {
+        return m_values.capacity() * sizeof(Cell) + m_valid.capacity() * sizeof(std::uint64_t);
+    }
+
+    inline void push_back(const T& value)
+    {
+        m_values.push_back(value);
+        push_bit(true);
+    }
+    inline void push_back(T&& value)
+    {
+        m_values.push_back(std::move(value));
+        push_bit(true);
+    }
+    inline void push_back(None)
+    {
+        m_values.emplace_back();
+        push_bit(false);
+    }
+    inline void push_back(const Option<T>& value)
+    {
+        if(value.is_some()) { push_back(value.unwrap()); }
+        else { push_back(None{}); }
+    }
+    template <typename... Args>
+    inline void emplace_back(Args&&... args)
+    {
+        m_values.emplace_back(std::forward<Args>(args)...);
+        push_bit(true);
+    }
+
+    inline bool is_some(std::size_t i) const noexcept
+    {
+        assert(i < size());
+        using _internal0_impl0_option_vec::WORD_BITS;
+        return (m_valid[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+    }
+    inline bool is_none(std::size_t i) const noexcept { return !is_some(i); }
+    // A view of the element, Some of a reference to its value or None.
+    inline Option<T&> operator[](std::size_t i) noexcept
+    {
+        return is_some(i) ? Option<T&>(nstd::in_place, ref(i)) : Option<T&>();
+    }
+    inline Option<const T&> operator[](std::size_t i) const noexcept
+    {
+        return is_some(i) ? Option<const T&>(nstd::in_place, ref(i)) : Option<const T&>();
+    }
+    inline void set(std::size_t i, T value)
+    {
+        assert(i < size());
+        using _internal0_impl0_option_vec::WORD_BITS;
+        m_values[i] = std::move(value);
+        m_valid[i / WORD_BITS] |= std::uint64_t(1) << (i % WORD_BITS);
+    }
+    inline void set(std::size_t i, None)
+    {
+        assert(i < size());
+        using _internal0_impl0_option_vec::WORD_BITS;
+        m_values[i] = T();
+        m_valid[i / WORD_BITS] &= ~(std::uint64_t(1) << (i % WORD_BITS));
+    }
+
+    // The columns. The None elements hold a value initialized T, and the bits past size() are 0.
+    inline const T* values() const noexcept
+    {
+        return reinterpret_cast<const T*>(m_values.data());
+    }
+    inline const std::uint64_t* validity() const noexcept { return m_valid.data(); }
+
+    inline std::size_t count_some() const noexcept
+    {
+        std::size_t n = 0;
+        for(std::uint64_t w : m_valid) { n += _internal0_impl0_option_vec::popcount(w); }
+        return n;
+    }
+    inline std::size_t count_none() const noexcept { return size() - count_some(); }
+
+    // f(index, value) for every some element, in order.
+    template <typename F>
+    inline void for_each_some(F&& f) const
+    {
+        visit_some([&](std::size_t i) { f(i, ref(i)); });
+    }
+
+    // f of every some value, the None elements stay None. f is only called on some values.
+    template <typename F>
+    inline auto map(F&& f) const
+    {
+        using U = nstd::decay_t<std::invoke_result_t<F&, const T&>>;
+        OptionVec<U> out(size());
+        out.m_valid = m_valid;
+        visit_some([&](std::size_t i) { out.m_values[i] = f(ref(i)); });
+        return out;
+    }
+
+    // The some values for which pred holds, in order, all some.
+    template <typename P>
+    inline OptionVec<T> filter(P&& pred) const
+    {
+        OptionVec<T> out;
+        std::size_t n = 0;
+        IF_CONSTEXPR(std::is_trivially_copyable_v<T>)
+        {
+            // Branch free: every value is written, and kept by moving past it.
+            out.m_values.resize(count_some());
+            visit_some([&](std::size_t i) {
+                out.m_values[n] = m_values[i];
+                n += pred(ref(i)) ? 1 : 0;
+            });
+            out.m_values.resize(n);
+        }
+        else
+        {
+            visit_some([&](std::size_t i) {
+                if(pred(ref(i))) { out.m_values.push_back(m_values[i]); }
+            });
+            n = out.m_values.size();
+        }
+        out.set_some_prefix(n);
+        return out;
+    }
+
+    // The elements at indices, in their order, some or None as they are here.
+    inline OptionVec<T> gather(const std::vector<std::size_t>& indices) const
+    {
+        using _internal0_impl0_option_vec::WORD_BITS;
+        OptionVec<T> out(indices.size());
+        for(std::size_t j = 0; j < indices.size(); ++j)
+        {
+            std::size_t i = indices[j];
+            assert(i < size());
+            out.m_values[j] = m_values[i];
+            std::uint64_t bit = (m_valid[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+            out.m_valid[j / WORD_BITS] |= bit << (j % WORD_BITS);
+        }
+        return out;
+    }
+};
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef __NSTD_PERF_COUNTERS_HPP__
+#define __NSTD_PERF_COUNTERS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nstd {
+
+enum class PerfEvent
+{
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    L1D_MISSES,
+    LLC_MISSES,
+    CONTEXT_SWITCHES,
+    COUNT,
+};
+
+constexpr std::size_t PERF_EVENT_COUNT = static_cast<std::size_t>(PerfEvent::COUNT);
+
+const char* perf_event_name(PerfEvent e) noexcept;
+
+struct PerfCounts {
+    std::uint64_t value[PERF_EVENT_COUNT] = {};
+    unsigned int valid                    = 0;  // bit mask of the counted events
+
+    inline bool has(PerfEvent e) const noexcept
+    {
+        return (valid & (1u << static_cast<unsigned>(e))) != 0;
+    }
+    inline std::uint64_t get(PerfEvent e) const noexcept
+    {
+        return value[static_cast<std::size_t>(e)];
+    }
+    // Events missing in either side are invalid in the sum.
+    PerfCounts& operator+=(const PerfCounts& other) noexcept;
+};
+
+/* A group of hardware counters of the calling thread, opened with perf_event_open. Only user space
+ * is counted, except for context switches. The events the kernel or the CPU refuse are left out;
+ * when none can be opened (not Linux, no PMU in a VM or a container, perf_event_paranoid) open()
+ * returns false and read() returns no valid event. The counts are scaled when the group was
+ * multiplexed.
+ */
+class PerfCounters {
+    int m_fds[PERF_EVENT_COUNT];
+    std::uint64_t m_ids[PERF_EVENT_COUNT] = {};
+    int m_leader                          = -1;
+
+    void close() noexcept;
+
+public:
+    PerfCounters() noexcept;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    PerfCounters(PerfCounters&& other) noexcept;
+    PerfCounters& operator=(PerfCounters&& other) noexcept;
+    ~PerfCounters();
+
+    bool open() noexcept;
+    inline bool is_open() const noexcept { return m_leader >= 0; }
+    // Reset and start counting.
+    void start() noexcept;
+    void stop() noexcept;
+    PerfCounts read() const noexcept;
+};
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __NSTD_PROCESS_HPP__
+#define __NSTD_PROCESS_HPP__
+
+#include <string>
+#include <vector>
+
+namespace nstd {
+
+struct ProcessResult {
+    bool started       = false;
+    int exit_code      = -1;  // -1 if it didn't start or was killed
+    int signal         = 0;   // the signal which killed it, 0 if none
+    bool timed_out     = false;
+    double seconds     = 0;  // wall time
+    double cpu_seconds = 0;  // user and system time, of the processes it waited for too
+    long max_rss_kb    = 0;
+    std::string output;  // stdout and stderr, or why it didn't start
+};
+
+/* Run argv and wait for it, capturing its stdout and stderr. argv[0] is searched in PATH unless it
+ * contains a '/'. The capture pipe is close-on-exec, so the processes other threads start at the
+ * same time don't inherit it: an inherited write end keeps the read going until they exit too.
+ * With timeout_seconds > 0, the process is killed with SIGKILL once it runs longer.
+ * Without posix_spawn, it goes through std::system: no output, no usage and no timeout.
+ */
+ProcessResult run_process(const std::vector<std::string>& argv, double timeout_seconds = 0);
+
+}  // namespace nstd
+
+#endif
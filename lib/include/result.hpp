@@ -1,8 +1,10 @@
 #ifndef __NSTD_RESULT_HPP__
 #define __NSTD_RESULT_HPP__
 
+#include <cassert>
 #include <memory>
 #include <sstream>
+#include <type_traits>
 #include "type_traits.hpp"
 #include "utility.hpp"
 #include "variant.hpp"
@@ -22,12 +24,15 @@ private:
     OkType value;
 
 public:
-    template<typename... Args>
-    Ok(Args&&... args): value(std::forward<Args>(args)...)
+    template <typename... Args,
+              nstd::enable_if_t<!_internal0_impl0_option::is_self<Ok<OkType>, Args...>::value,
+                                bool> = true>
+    constexpr Ok(Args&&... args) : value(std::forward<Args>(args)...)
     {
     }
-    Ok(Ok<OkType>&& ok) : value(std::move(ok.value)) {}
-    Ok(const Ok<OkType>& ok) : value(ok.value) {}
+    // Defaulted, so an Ok of a trivially copyable type is trivially copyable.
+    Ok(Ok<OkType>&&)                         = default;
+    Ok(const Ok<OkType>&)                    = default;
     Ok<OkType>& operator=(Ok<OkType>&&)      = default;
     Ok<OkType>& operator=(const Ok<OkType>&) = default;
     inline constexpr nstd::add_const_t<nstd::add_lvalue_reference_t<OkType>>
@@ -49,12 +54,14 @@ private:
     ErrType value;
 
 public:
-    template<typename... Args>
-    Err(Args&&... args): value(std::forward<Args>(args)...)
+    template <typename... Args,
+              nstd::enable_if_t<!_internal0_impl0_option::is_self<Err<ErrType>, Args...>::value,
+                                bool> = true>
+    constexpr Err(Args&&... args) : value(std::forward<Args>(args)...)
     {
     }
-    Err(Err<ErrType>&& err) : value(std::move(err.value)) {}
-    Err(const Err<ErrType>& err) : value(err.value) {}
+    Err(Err<ErrType>&&)                          = default;
+    Err(const Err<ErrType>&)                     = default;
     Err<ErrType>& operator=(Err<ErrType>&&)      = default;
     Err<ErrType>& operator=(const Err<ErrType>&) = default;
     inline constexpr nstd::add_const_t<nstd::add_lvalue_reference_t<ErrType>>
@@ -70,60 +77,292 @@ public:
     inline constexpr nstd::add_pointer_t<ErrType> operator->() noexcept { return &value; }
 };
 
+/* The Ok or the Err value, in a variant whose index is the status: there is no other discriminant.
+ * The copy, the move and the destruction are trivial if those of OkType and ErrType are, so e.g.
+ * a Result<int, ErrCode> is as large as a std::pair<int, ErrCode>, is returned in registers and
+ * can be used in constant expressions.
+ * The combinators come in &, const& and && forms: on an rvalue Result they move the values into
+ * the functions and the results, so a chain of them on a temporary copies nothing. See NSTD_TRY
+ * for the early return of the error.
+ */
 template <typename OkType, typename ErrType>
-class Result : nstd::variant<Ok<OkType>, Err<ErrType>> {
+class Result {
 private:
-    ResultStatus m_status;
-public:
-    Result(nstd::Ok<OkType>&& ok_value)
-        : m_status(ResultStatus::OK), nstd::variant<Ok<OkType>, Err<ErrType>>(
-                                          std::move(ok_value))
+    nstd::variant<Ok<OkType>, Err<ErrType>> m_value;
+
+    template <typename Self>
+    using ok_ref_t = decltype(std::declval<Self>().unwrap());
+    template <typename Self>
+    using err_ref_t = decltype(std::declval<Self>().unwrap_err());
+
+    template <typename Self, typename F>
+    static constexpr auto map_impl(Self&& self, F&& f)
+    {
+        using R = Result<nstd::decay_t<std::invoke_result_t<F, ok_ref_t<Self>>>, ErrType>;
+        if(self.is_ok())
+        {
+            return R(nstd::in_place_index<0>,
+                     std::forward<F>(f)(std::forward<Self>(self).unwrap()));
+        }
+        return R(nstd::in_place_index<1>, std::forward<Self>(self).unwrap_err());
+    }
+    template <typename Self, typename F>
+    static constexpr auto map_err_impl(Self&& self, F&& f)
     {
+        using R = Result<OkType, nstd::decay_t<std::invoke_result_t<F, err_ref_t<Self>>>>;
+        if(self.is_ok()) { return R(nstd::in_place_index<0>, std::forward<Self>(self).unwrap()); }
+        return R(nstd::in_place_index<1>,
+                 std::forward<F>(f)(std::forward<Self>(self).unwrap_err()));
     }
-    Result(const nstd::Ok<OkType>& ok_value)
-        : m_status(ResultStatus::OK), nstd::variant<Ok<OkType>, Err<ErrType>>(ok_value)
+    template <typename Self, typename F>
+    static constexpr auto and_then_impl(Self&& self, F&& f)
     {
+        using R = nstd::decay_t<std::invoke_result_t<F, ok_ref_t<Self>>>;
+        static_assert(std::is_same_v<typename R::err_type, ErrType>,
+                      "The function of and_then must return a Result of the same error type.");
+        if(self.is_ok()) { return std::forward<F>(f)(std::forward<Self>(self).unwrap()); }
+        return R(nstd::in_place_index<1>, std::forward<Self>(self).unwrap_err());
     }
-    Result(nstd::Err<ErrType>&& err_value)
-        : m_status(ResultStatus::ERR), nstd::variant<Ok<OkType>, Err<ErrType>>(std::move(err_value))
+    template <typename Self, typename F>
+    static constexpr auto or_else_impl(Self&& self, F&& f)
     {
+        using R = nstd::decay_t<std::invoke_result_t<F, err_ref_t<Self>>>;
+        static_assert(std::is_same_v<typename R::ok_type, OkType>,
+                      "The function of or_else must return a Result of the same ok type.");
+        if(self.is_err()) { return std::forward<F>(f)(std::forward<Self>(self).unwrap_err()); }
+        return R(nstd::in_place_index<0>, std::forward<Self>(self).unwrap());
     }
-    Result(const nstd::Err<ErrType>& err_value)
-        : m_status(ResultStatus::ERR), nstd::variant<Ok<OkType>, Err<ErrType>>(
-                                                               err_value)
+    template <typename Self, typename U>
+    static constexpr OkType unwrap_or_impl(Self&& self, U&& default_value)
     {
+        if(self.is_ok()) { return std::forward<Self>(self).unwrap(); }
+        return static_cast<OkType>(std::forward<U>(default_value));
+    }
+    template <typename Self, typename F>
+    static constexpr OkType value_or_else_impl(Self&& self, F&& f)
+    {
+        if(self.is_ok()) { return std::forward<Self>(self).unwrap(); }
+        return std::forward<F>(f)(std::forward<Self>(self).unwrap_err());
     }
 
 public:
-    Result(const Result<OkType, ErrType>& res)
-        : m_status(res.m_status), nstd::variant<Ok<OkType>, Err<ErrType>>(res)
+    using ok_type  = OkType;
+    using err_type = ErrType;
+
+    // The Ok (0) or the Err (1) value constructed in place from args.
+    template <typename... Args>
+    constexpr explicit Result(nstd::in_place_index_t<0>, Args&&... args)
+        : m_value(nstd::in_place_index<0>, std::forward<Args>(args)...)
+    {
+    }
+    template <typename... Args>
+    constexpr explicit Result(nstd::in_place_index_t<1>, Args&&... args)
+        : m_value(nstd::in_place_index<1>, std::forward<Args>(args)...)
     {
     }
-    Result(Result<OkType, ErrType>&& res)
-        : m_status(res.m_status), nstd::variant<Ok<OkType>, Err<ErrType>>(std::move(res))
+    constexpr Result(nstd::Ok<OkType>&& ok_value)
+        : m_value(nstd::in_place_index<0>, std::move(ok_value))
     {
     }
+    constexpr Result(const nstd::Ok<OkType>& ok_value) : m_value(nstd::in_place_index<0>, ok_value)
+    {
+    }
+    constexpr Result(nstd::Err<ErrType>&& err_value)
+        : m_value(nstd::in_place_index<1>, std::move(err_value))
+    {
+    }
+    constexpr Result(const nstd::Err<ErrType>& err_value)
+        : m_value(nstd::in_place_index<1>, err_value)
+    {
+    }
+    Result(const Result<OkType, ErrType>&)                             = default;
+    Result(Result<OkType, ErrType>&&)                                  = default;
     Result<OkType, ErrType>& operator=(Result<OkType, ErrType>&&)      = default;
     Result<OkType, ErrType>& operator=(const Result<OkType, ErrType>&) = default;
-    inline constexpr ResultStatus status() const noexcept { return m_status; }
-    inline constexpr bool is_ok() const noexcept { return ResultStatus::OK == m_status; }
-    inline constexpr bool is_err() const noexcept { return ResultStatus::ERR == m_status; }
-    inline constexpr operator ResultStatus() const noexcept { return m_status; }
-    template<typename... Args>
-    inline static ok(Args&&... args)
+    template <typename... Args>
+    inline static constexpr Result<OkType, ErrType> ok(Args&&... args)
+    {
+        return Result<OkType, ErrType>(nstd::in_place_index<0>, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    inline static constexpr Result<OkType, ErrType> err(Args&&... args)
     {
-        return Result(Ok<OkType>(std::forward<Args>(args)...));
+        return Result<OkType, ErrType>(nstd::in_place_index<1>, std::forward<Args>(args)...);
     }
-    template<typename... Args>
-    inline static err(Args&&... args)
+
+    inline constexpr ResultStatus status() const noexcept
     {
-        return Result(Err<ErrType>(std::forward<Args>(args)...));
+        return m_value.index() == 0 ? ResultStatus::OK : ResultStatus::ERR;
+    }
+    inline constexpr operator ResultStatus() const noexcept { return status(); }
+    inline constexpr bool is_ok() const noexcept { return m_value.index() == 0; }
+    inline constexpr bool is_err() const noexcept { return m_value.index() != 0; }
+    inline constexpr OkType& unwrap() & noexcept
+    {
+        assert(is_ok());
+        return *nstd::get<0>(m_value);
+    }
+    inline constexpr const OkType& unwrap() const& noexcept
+    {
+        assert(is_ok());
+        return *nstd::get<0>(m_value);
+    }
+    inline constexpr OkType&& unwrap() && noexcept { return std::move(unwrap()); }
+    inline constexpr ErrType& unwrap_err() & noexcept
+    {
+        assert(is_err());
+        return *nstd::get<1>(m_value);
+    }
+    inline constexpr const ErrType& unwrap_err() const& noexcept
+    {
+        assert(is_err());
+        return *nstd::get<1>(m_value);
+    }
+    inline constexpr ErrType&& unwrap_err() && noexcept { return std::move(unwrap_err()); }
+
+    // Result<U, ErrType> of f(ok value), U the decayed type returned by f.
+    template <typename F>
+    inline constexpr auto map(F&& f) &
+    {
+        return map_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map(F&& f) const&
+    {
+        return map_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map(F&& f) &&
+    {
+        return map_impl(std::move(*this), std::forward<F>(f));
+    }
+    // Result<OkType, G> of f(err value), G the decayed type returned by f.
+    template <typename F>
+    inline constexpr auto map_err(F&& f) &
+    {
+        return map_err_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map_err(F&& f) const&
+    {
+        return map_err_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto map_err(F&& f) &&
+    {
+        return map_err_impl(std::move(*this), std::forward<F>(f));
+    }
+    // f(ok value), a Result<U, ErrType> itself, or the error.
+    template <typename F>
+    inline constexpr auto and_then(F&& f) &
+    {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto and_then(F&& f) const&
+    {
+        return and_then_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto and_then(F&& f) &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(f));
+    }
+    // f(err value), a Result<OkType, G> itself, or the ok value.
+    template <typename F>
+    inline constexpr auto or_else(F&& f) &
+    {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto or_else(F&& f) const&
+    {
+        return or_else_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr auto or_else(F&& f) &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(f));
+    }
+    template <typename U>
+    inline constexpr OkType unwrap_or(U&& default_value) const&
+    {
+        return unwrap_or_impl(*this, std::forward<U>(default_value));
+    }
+    template <typename U>
+    inline constexpr OkType unwrap_or(U&& default_value) &&
+    {
+        return unwrap_or_impl(std::move(*this), std::forward<U>(default_value));
+    }
+    // The ok value, or f(err value). f is only called on an error.
+    template <typename F>
+    inline constexpr OkType value_or_else(F&& f) const&
+    {
+        return value_or_else_impl(*this, std::forward<F>(f));
+    }
+    template <typename F>
+    inline constexpr OkType value_or_else(F&& f) &&
+    {
+        return value_or_else_impl(std::move(*this), std::forward<F>(f));
     }
 };
 
 template <typename E>
 using ResultOmitOk = nstd::Result<nstd::monostate, E>;
 
+namespace _internal0_impl0_result {
+    template <typename T, typename E>
+    constexpr bool try_failed(const Result<T, E>& r) noexcept
+    {
+        return r.is_err();
+    }
+    template <typename T>
+    constexpr bool try_failed(const Option<T>& o) noexcept
+    {
+        return o.is_none();
+    }
+    // What NSTD_TRY returns: the error, which converts to any Result of the same error type, or
+    // None.
+    template <typename T, typename E>
+    constexpr Err<E> try_residual(const Result<T, E>& r)
+    {
+        return Err<E>(r.unwrap_err());
+    }
+    template <typename T, typename E>
+    constexpr Err<E> try_residual(Result<T, E>&& r)
+    {
+        return Err<E>(std::move(r).unwrap_err());
+    }
+    template <typename T>
+    constexpr None try_residual(const Option<T>&) noexcept
+    {
+        return None{};
+    }
+}  // namespace _internal0_impl0_result
+
+#define __NSTD_TRY_CONCAT_IMPL(A, B) A##B
+#define __NSTD_TRY_CONCAT(A, B) __NSTD_TRY_CONCAT_IMPL(A, B)
+#define __NSTD_TRY_IMPL(var, tmp, ...)                                                        \
+    auto&& tmp = (__VA_ARGS__);                                                               \
+    if(nstd::_internal0_impl0_result::try_failed(tmp))                                        \
+    {                                                                                         \
+        return nstd::_internal0_impl0_result::try_residual(std::forward<decltype(tmp)>(tmp)); \
+    }                                                                                         \
+    [[maybe_unused]] decltype(auto) var = std::forward<decltype(tmp)>(tmp).unwrap()
+
+/* Evaluate a Result or an Option, return its error (or None) from the enclosing function if it
+ * failed, otherwise declare var as its value:
+ *     nstd::Result<Config, std::string> load(const std::string& path)
+ *     {
+ *         NSTD_TRY(text, read_file(path));  // returns the error of read_file
+ *         return parse_config(text);
+ *     }
+ * The Result or Option is kept until the end of the scope and var refers to its value, so nothing
+ * is copied: for a temporary, var is an rvalue reference which can be moved from.
+ */
+#define NSTD_TRY(var, ...) \
+    __NSTD_TRY_IMPL(var, __NSTD_TRY_CONCAT(_nstd_try_, __COUNTER__), __VA_ARGS__)
+
 }  // namespace nstd
 
 #endif
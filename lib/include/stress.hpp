@@ -0,0 +1,69 @@
+#ifndef __NSTD_STRESS_HPP__
+#define __NSTD_STRESS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "test.hpp"
+
+namespace nstd {
+
+struct StressOptions {
+    double seconds = 1.0;  // run time of every thread count
+    // The thread counts are 1, 2, 4 ... up to max_threads, and max_threads itself.
+    // 0 means all the hardware threads.
+    unsigned int max_threads = 0;
+    bool pin                 = true;  // pin thread i to CPU i % CPUs
+    double interval_seconds  = 0.1;   // the resolution of the throughput timeline
+    std::string filter;  // only run the stress tests whose "group::case" contains it
+};
+
+struct StressStep {
+    unsigned int threads = 0;
+    double seconds       = 0;
+    std::uint64_t ops    = 0;
+    double ops_per_sec   = 0;
+    // ops_per_sec divided by threads times the single thread ops_per_sec, 1 is linear scaling.
+    double efficiency = 0;
+    // Jain's fairness index of the per thread ops: 1 if equal, 1/threads if one thread did all.
+    double fairness = 0;
+    std::vector<std::uint64_t> thread_ops;
+    std::vector<double> timeline;  // ops per second of every interval
+};
+
+struct StressResult {
+    std::string id;  // "group::case"
+    std::vector<StressStep> steps;
+};
+
+/* Runs the STRESS_TEST cases registered to TestGroupManager. Every case runs its operation in a
+ * loop on 1, 2, 4 ... N threads, each step for a fixed time, and records the throughput over time,
+ * the per thread fairness and the scaling efficiency, which shows where contention sets in.
+ */
+class StressRunner {
+    StressOptions m_options;
+
+public:
+    explicit StressRunner(StressOptions options);
+    StressStep run_step(const StressFunc& func, unsigned int threads) const;
+    StressResult run_case(const StressFunc& func, std::string id) const;
+    std::vector<StressResult> run(std::ostream& out) const;
+};
+
+double jain_fairness(const std::vector<std::uint64_t>& values) noexcept;
+
+void write_stress_table(std::ostream& out, const std::vector<StressResult>& results);
+void write_stress_json(std::ostream& out, const std::vector<StressResult>& results);
+
+/* A main() for stress binaries:
+ *     int main(int argc, char** argv) { return nstd::stress_main(argc, argv); }
+ * Options: --filter <text>, --seconds <s>, --max-threads <n>, --interval-ms <ms>, --no-pin,
+ * --json <path>.
+ */
+int stress_main(int argc, char** argv);
+
+}  // namespace nstd
+
+#endif
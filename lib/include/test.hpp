@@ -1,11 +1,16 @@
 #ifndef __NSTD_TEST_HPP__
 #define __NSTD_TEST_HPP__
 
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
 #include <vector>
+#include "error.hpp"
+#include "function.hpp"
+#include "result.hpp"
 #ifdef NSTD_TEST
 #include <sstream>
-#include <regex>
 #ifdef private
 #undef private
 #endif
@@ -18,8 +23,25 @@
 
 namespace nstd {
 
-typedef void (*BenchFunc)();
-typedef void (*StressFunc)();
+typedef void (*TestFunc)();
+// The measured function of a BENCHMARK case and the operation of a STRESS_TEST case. They may
+// capture fixtures, which are stored inline and never allocated.
+typedef InplaceFunction<void(), 64> BenchFunc;
+typedef InplaceFunction<void(), 64> StressFunc;
+// A BENCHMARK case sets the function to be measured, its own code isn't measured.
+typedef void (*BenchSetup)(BenchFunc&);
+// A STRESS_TEST case sets the operation to be run by all the threads, one call is one operation.
+// The threads share the operation and its captures, so it must be safe to call concurrently: a
+// mutable lambda is changed by every thread at once.
+typedef void (*StressSetup)(StressFunc&);
+
+// An argument of a parameterized BENCHMARK case takes lo, lo * mult, lo * mult^2, ... and hi.
+// A mult below 2 is taken as 2, a lo below 1 is followed by 1.
+struct BenchRange {
+    std::int64_t lo;
+    std::int64_t hi;
+    std::int64_t mult = 2;
+};
 
 enum TestKind
 {
@@ -33,7 +55,16 @@ enum TestKind
 struct TestCaseInfo {
     TestKind kind;
     std::string name;
-}
+    // The body of a UNIT_TEST/INTEGRATION_TEST case. nullptr if the case is only known by name.
+    TestFunc func = nullptr;
+    // The setup of a BENCHMARK case.
+    BenchSetup bench = nullptr;
+    // The setup of a STRESS_TEST case.
+    StressSetup stress = nullptr;
+    // The argument ranges of a parameterized BENCHMARK case, it's run for every combination.
+    const BenchRange* ranges = nullptr;
+    std::size_t range_count  = 0;
+};
 
 class TestGroup {
 private:
@@ -45,31 +76,166 @@ private:
 public:
     TestGroup(std::string&& group_name, std::string&& file);
     TestGroup(const std::string& group_name, const std::string& file);
-    void add_case(TestKind kind, std::string&& case_name) noexcept;
+    void add_case(TestKind kind, std::string&& case_name, TestFunc func = nullptr) noexcept;
+    // BenchSetup and StressSetup are the same type, `setup` is stored by `kind`.
+    void add_case(TestKind kind,
+                  std::string&& case_name,
+                  BenchSetup setup,
+                  const BenchRange* ranges = nullptr,
+                  std::size_t range_count  = 0) noexcept;
     void set_code(std::string&& tests_code) noexcept;
-    inline const std::string& get_group_name() const noexcept;
-    inline const std::vector<TestCaseInfo>& get_cases() const noexcept;
+    const std::string& get_group_name() const noexcept;
+    const std::string& get_file() const noexcept;
+    // The source text of a TEST group, empty for the groups of UTEST/ITEST/BENCH/STRESS.
+    const std::string& get_code() const noexcept;
+    const std::vector<TestCaseInfo>& get_cases() const noexcept;
+};
+
+/* Every test case macro emits a constant descriptor, and nothing runs at startup: on ELF targets a
+ * pointer to the descriptor is put into the "nstd_test_cases" linker section and the linker
+ * gathers them into an array. Elsewhere the descriptors are chained in an intrusive list by a
+ * trivial static constructor, which doesn't allocate either. TestGroupManager turns the descriptors
+ * into TestGroups on the first get_groups().
+ */
+struct TestCaseDesc {
+    TestKind kind;
+    const char* group;
+    const char* name;
+    const char* file;
+    TestFunc func;             // UNIT_TEST, INTEGRATION_TEST
+    BenchSetup setup;          // BENCHMARK, STRESS_TEST
+    const BenchRange* ranges;  // BENCHMARK
+    std::size_t range_count;
 };
 
+/* The raw text of a TEST or DOC_TEST group, parsed on demand. For TEST, `text` is the stringified
+ * body with its [[utest(name)]], [[itest(name)]], [[bench(name)]] and [[stress(name)]] attributes.
+ * For DOC_TEST, the doc comments are gone from the stringified text, so the code blocks are taken
+ * from the source `file` by the doc test driver and `incs` are the includes of the blocks.
+ */
+struct TestTextDesc {
+    bool doc;
+    const char* group;
+    const char* file;
+    const char* text;
+    const char* incs;
+};
+
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))
+#define __NSTD_TEST_SECTIONS
+#else
+struct TestCaseNode {
+    const TestCaseDesc* desc;
+    const TestCaseNode* next;
+    TestCaseNode(const TestCaseDesc* d) noexcept;
+};
+struct TestTextNode {
+    const TestTextDesc* desc;
+    const TestTextNode* next;
+    TestTextNode(const TestTextDesc* d) noexcept;
+};
+#endif
+
+// The descriptors linked into the program.
+std::vector<const TestCaseDesc*> test_case_descs();
+std::vector<const TestTextDesc*> test_text_descs();
+
 class TestGroupManager {
 private:
     std::vector<nstd::TestGroup> groups;
+    bool loaded = false;
     static std::mutex tgm_mutex;
     TestGroupManager() = default;
+    // Turn the descriptors into groups, once. tgm_mutex must be held.
+    void load();
 
 public:
     static TestGroupManager& get_obj();
-    void add_test_group(TestGroup&& test_group);
+    // Fails if a group of the same name is already there.
+    nstd::ResultOmitOk<nstd::Error> add_test_group(TestGroup&& test_group);
+    // Add a case to the group named `group`, the group is created if it doesn't exist yet.
+    void add_test_case(
+        const char* group, const char* file, TestKind kind, const char* name, TestFunc func);
+    void add_test_case(
+        const char* group, const char* file, TestKind kind, const char* name, BenchSetup setup);
+    // A copy of the registered groups, other threads may add groups meanwhile. The DOC_TEST groups
+    // aren't included, see doc_test.hpp.
+    std::vector<nstd::TestGroup> get_groups();
 };
 
-#ifdef NSTD_TEST
+// Parse the text of a TEST group into its cases and its code, the test attributes removed.
+TestGroup parse_test_text(const TestTextDesc& desc);
 
-template <typename T>
-T& make_test_group()
-{
-    static const T test_group{};
-    return test_group;
-}
+#define __NSTD_TEST_CAT_IMPL(a, b) a##b
+#define __NSTD_TEST_CAT(a, b) __NSTD_TEST_CAT_IMPL(a, b)
+// `which` is Case or Text.
+#ifdef __NSTD_TEST_SECTIONS
+#define __NSTD_TEST_REGISTER(sect, which, desc)                           \
+    [[maybe_unused]] __attribute__((used, section(#sect))) static const \
+        nstd::Test##which##Desc* const __NSTD_TEST_CAT(_nstd_##sect##_, __COUNTER__) = &desc
+#else
+#define __NSTD_TEST_REGISTER(sect, which, desc)            \
+    [[maybe_unused]] static const nstd::Test##which##Node \
+        __NSTD_TEST_CAT(_nstd_##sect##_, __COUNTER__){&desc}
+#endif
+
+/* Define and register a test case with its body, e.g.
+ *     UTEST(my_group, test_add) { assert(1 + 1 == 2); }
+ *     BENCH(my_group, bench_add) { b = [] { nstd::do_not_optimize(1 + 1); }; }
+ *     BENCH(my_group, bench_sum) { b = [v = make_array()] { nstd::do_not_optimize(sum(v)); }; }
+ *     STRESS(my_group, stress_log) { s = [] { NSTD_LOG_INFO("hi"); }; }
+ * BENCH_ARGS takes argument ranges after the name and runs the case for every combination. The
+ * setup and the measured function read the current arguments with nstd::bench_arg(i):
+ *     BENCH_ARGS(my_group, bench_sort, {8, 1 << 16}) { ... v.resize(nstd::bench_arg(0)); ... }
+ * UTEST and ITEST are run by the test runner (test_runner.hpp), BENCH by the benchmark harness
+ * (bench.hpp), STRESS by the stress engine (stress.hpp). Without NSTD_TEST, the body is compiled
+ * but not registered.
+ */
+#ifdef NSTD_TEST
+#define __NSTD_TEST_CASE(group, name, kind, func, setup, ranges, range_count, ...)               \
+    static void name(__VA_ARGS__);                                                               \
+    static constexpr nstd::TestCaseDesc _nstd_test_case_##name{                                  \
+        kind, #group, #name, __FILE__, func, setup, ranges, range_count};                        \
+    __NSTD_TEST_REGISTER(nstd_test_cases, Case, _nstd_test_case_##name);                         \
+    static void name(__VA_ARGS__)
+#else
+#define __NSTD_TEST_CASE(group, name, kind, func, setup, ranges, range_count, ...) \
+    [[maybe_unused]] static void name(__VA_ARGS__)
+#endif
+#define UTEST(group, name) \
+    __NSTD_TEST_CASE(group, name, nstd::TestKind::UNIT_TEST, &name, nullptr, nullptr, 0, void)
+#define ITEST(group, name) \
+    __NSTD_TEST_CASE(        \
+        group, name, nstd::TestKind::INTEGRATION_TEST, &name, nullptr, nullptr, 0, void)
+#define BENCH(group, name)                        \
+    __NSTD_TEST_CASE(group,                       \
+                     name,                        \
+                     nstd::TestKind::BENCHMARK,   \
+                     nullptr,                     \
+                     &name,                       \
+                     nullptr,                     \
+                     0,                           \
+                     [[maybe_unused]] nstd::BenchFunc& b)
+#define BENCH_ARGS(group, name, ...)                                                      \
+    [[maybe_unused]] static constexpr nstd::BenchRange _nstd_bench_args_##name[] = {      \
+        __VA_ARGS__};                                                                     \
+    __NSTD_TEST_CASE(group,                                                               \
+                     name,                                                                \
+                     nstd::TestKind::BENCHMARK,                                           \
+                     nullptr,                                                             \
+                     &name,                                                               \
+                     _nstd_bench_args_##name,                                             \
+                     sizeof(_nstd_bench_args_##name) / sizeof(nstd::BenchRange),          \
+                     [[maybe_unused]] nstd::BenchFunc& b)
+#define STRESS(group, name)                       \
+    __NSTD_TEST_CASE(group,                       \
+                     name,                        \
+                     nstd::TestKind::STRESS_TEST, \
+                     nullptr,                     \
+                     &name,                       \
+                     nullptr,                     \
+                     0,                           \
+                     [[maybe_unused]] nstd::StressFunc& s)
 
 #define TEST_PARENS_PROBE(...) _, 1
 #define TEST_PARENS_CONDITION(a, b, ...) b
@@ -77,135 +243,19 @@ T& make_test_group()
 #define TEST_PARENS_REMOVE_IMPL_0(...) #__VA_ARGS__
 #define TEST_PARENS_REMOVE_IMPL_1_IMPL(...) #__VA_ARGS__
 #define TEST_PARENS_REMOVE_IMPL_1(expr) TEST_PARENS_REMOVE_IMPL_1_IMPL expr
-#define TEST_PARENS_REMOVE_IMPL(condition) TEST_CONCAT(TEST_PARENS_REMOVE_IMPL_, condition)
+#define TEST_PARENS_REMOVE_IMPL(condition) __NSTD_TEST_CAT(TEST_PARENS_REMOVE_IMPL_, condition)
 #define TEST_PARENS_REMOVE(expr) \
     TEST_PARENS_REMOVE_IMPL(TEST_PARENS_CHECK(TEST_PARENS_PROBE expr))(expr)
 
-#define TEST(name, ...)                                                                            \
-    class PhantomGroupTest##name {                                                                 \
-    public:                                                                                        \
-        PhantomGroupTest##name(I)                                                                  \
-        {                                                                                          \
-            std::istringstream txt{#__VA_ARGS__};                                                  \
-            std::ostringstream code;                                                               \
-            nstd::TestGroup tg(#name, __FILE__);                                                   \
-            std::regex battr_pattern("^(.+\\};?|\\s*)(\\[\\[.*)");                                 \
-            std::regex eattr_pattern("^(.*\\]\\])(.*)");                                           \
-            std::regex utest_pattern("(utest\\()(\\w+)\\),?");                                     \
-            std::regex itest_pattern("(itest\\()(\\w+)\\),?");                                     \
-            std::regex bench_pattern("(bench\\()(\\w+)\\),?");                                     \
-            std::regex stress_pattern("(stress\\()(\\w+)\\),?");                                   \
-            bool bmatch = false;                                                                   \
-            bool ematch = false;                                                                   \
-            std::ostringstream attr;                                                               \
-            for(std::string line; std::getline(txt, line);)                                        \
-            {                                                                                      \
-                if(!bmatch)                                                                        \
-                {                                                                                  \
-                    std::smatch r;                                                                 \
-                    bmatch = std::regex_match(line, r, battr_pattern);                             \
-                    if(bmatch)                                                                     \
-                    {                                                                              \
-                        attr << r[2];                                                              \
-                        code << r[1];                                                              \
-                    }                                                                              \
-                }                                                                                  \
-                std::smatch r;                                                                     \
-                ematch = std::regex_match(line, r, eattr_pattern);                                 \
-                if(bmatch && ematch)                                                               \
-                {                                                                                  \
-                    attr << r[1];                                                                  \
-                    std::string attr_str = attr.str();                                             \
-                    auto find_test       = [&r, &tg, &attr_str, &code, &bmatch, &ematch](          \
-                                         nstd::TestKind kind, std::regex& pattern) -> bool { \
-                        std::smatch tr;                                                            \
-                        if(std::regex_search(attr_str, tr, pattern))                               \
-                        {                                                                          \
-                            std::string name = tr[2];                                              \
-                            code << std::regex_replace(attr_str, pattern, "");                     \
-                            << r[2];                                                               \
-                            tg.add_case(kind, std::move(name));                                    \
-                            bmatch = false;                                                        \
-                            ematch = false;                                                        \
-                            return true;                                                           \
-                        }                                                                          \
-                        else { return false; }                                                     \
-                    };                                                                             \
-                    if(find_test(nstd::TestKind::UNIT_TEST, utest_pattern)) { continue; }          \
-                    if(find_test(nstd::TestKind::INTEGRATION_TEST, itest_pattern)) { continue; }   \
-                    if(find_test(nstd::TestKind::BENCHMARK, bench_pattern)) { continue; }          \
-                    if(find_test(nstd::TestKind::STRESS_TEST, stress_pattern)) { continue; }       \
-                }                                                                                  \
-                else if(bmatch) { attr << line; }                                                  \
-                else                                                                               \
-                {                                                                                  \
-                    ematch = std::string::npos;                                                    \
-                    code << line << "\n";                                                          \
-                }                                                                                  \
-            }                                                                                      \
-            assert(!bmatch && !ematch);                                                            \
-            tg.set_code(code.str());                                                               \
-            nstd::TestCaseManager& tgm = nstd::TestCaseManager::get_obj();                         \
-            tgm.add_test_group(std::move(tg));                                                     \
-        }                                                                                          \
-    };                                                                                             \
-    [[maybe_unused]] static const PhantomGroupTest##name& _group_test_##name =                     \
-        make_test_group<PhantomGroupTest##name>();
-#define DOC_TEST(name, incs, ...)                                                        \
-    class PhantomDocTest##name {                                                         \
-    public:                                                                              \
-        PhantomDocTest##name()                                                           \
-        {                                                                                \
-            std::string incs(TEST_PARENS_REMOVE(inc));                                   \
-            while(std::string::npos != incs.find(","))                                   \
-            {                                                                            \
-                incs = incs.replace(incs.find(","), 1, "\n");                            \
-            }                                                                            \
-            std::istringstream explain(#__VA_ARGS__);                                    \
-            std::ostringstream code;                                                     \
-            code << incs << "\n";                                                        \
-            bool bfind = false;                                                          \
-            std::regex example_pattern("^(\\s*)(///|//!|\\*)(\\s*)(```)(\\s*)");         \
-            std::regex code_pattern("^(\\s*)(///|//!|\\*)(\\s*)(.*)");                   \
-            std::string nm = #name;                                                      \
-            int count      = 0;                                                          \
-            nstd::TestGroup tg(#name, __FILE__);                                         \
-            for(std::string line; std::getline(explain, line);)                          \
-            {                                                                            \
-                if(!bfind)                                                               \
-                {                                                                        \
-                    bfind = std::regex_match(line, example_pattern);                     \
-                    if(bfind)                                                            \
-                    {                                                                    \
-                        tg.add_case(nstd::TestKind::DOC_TEST,                            \
-                                    std::move(nm + "_" + std::to_string(count)));        \
-                        code << "void " << nm + "_" + std::to_string(count) << "() {\n"; \
-                    }                                                                    \
-                }                                                                        \
-                else                                                                     \
-                {                                                                        \
-                    if(std::regex_match(line, example_pattern))                          \
-                    {                                                                    \
-                        code << "\n}\n";                                                 \
-                        bfind = false;                                                   \
-                        ++count;                                                         \
-                    }                                                                    \
-                    else                                                                 \
-                    {                                                                    \
-                        std::smatch r;                                                   \
-                        std::regex_match(line, r, code_pattern);                         \
-                        code << r[4] << "\n";                                            \
-                    }                                                                    \
-                }                                                                        \
-            }                                                                            \
-            assert(!bfind);                                                              \
-            tg.set_code(code.str());                                                     \
-            nstd::TestCaseManager& tgm = nstd::TestCaseManager::get_obj();               \
-            tgm.add_test_group(std::move(tg));                                           \
-        }                                                                                \
-    };                                                                                   \
-    [[maybe_unused]] inline static const PhantomDocTest##name& _doc_test_##name =        \
-        make_test_group<PhantomDocTest##name>();                                         \
+#ifdef NSTD_TEST
+#define TEST(name, ...)                                                         \
+    static constexpr nstd::TestTextDesc _nstd_test_text_##name{                 \
+        false, #name, __FILE__, #__VA_ARGS__, ""};                              \
+    __NSTD_TEST_REGISTER(nstd_test_texts, Text, _nstd_test_text_##name);
+#define DOC_TEST(name, incs, ...)                                               \
+    static constexpr nstd::TestTextDesc _nstd_doc_test_##name{                  \
+        true, #name, __FILE__, #__VA_ARGS__, TEST_PARENS_REMOVE(incs)};         \
+    __NSTD_TEST_REGISTER(nstd_test_texts, Text, _nstd_doc_test_##name);         \
     __VA_ARGS__
 #else
 #define TEST_PP_EMPTY
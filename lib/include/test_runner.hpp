@@ -0,0 +1,105 @@
+#ifndef __NSTD_TEST_RUNNER_HPP__
+#define __NSTD_TEST_RUNNER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "test.hpp"
+
+namespace nstd {
+
+struct TestRunOptions {
+    unsigned int jobs = 0;  // 0 means all the hardware threads
+    // Run every case in a child process, so a crash or a failed assert only fails that case.
+    bool isolate = false;
+    // Seconds an isolated case may run before it's killed and failed. 0 means no limit.
+    double timeout = 600;
+    bool unit_test        = true;
+    bool integration_test = true;
+    std::string filter;  // only run the cases whose "group::case" contains it
+    // Durations of the previous runs. The longest cases are started first. Empty disables it.
+    std::string timing_db = ".nstd_test_times";
+    // The group hashes and results of the previous runs. Only the groups which changed or failed
+    // last time are run again, unless `all`. Empty disables it.
+    std::string state_file = ".nstd_test_state";
+    bool all               = false;
+    // Where the #include "..." and <...> of the groups are searched, besides the directory of the
+    // including file. Headers which aren't found don't count in the group hash.
+    std::vector<std::string> include_dirs;
+    // The executable re-run for isolated cases. Defaults to the running executable.
+    std::string self_exe;
+};
+
+enum class TestOutcome
+{
+    PASSED,
+    FAILED,
+    SKIPPED,
+};
+
+struct TestCaseResult {
+    std::string id;  // "group::case"
+    TestKind kind;
+    TestOutcome outcome = TestOutcome::SKIPPED;
+    double seconds      = 0;
+    std::string message;
+};
+
+struct TestRunSummary {
+    std::size_t passed    = 0;
+    std::size_t failed    = 0;
+    std::size_t skipped   = 0;
+    std::size_t unchanged = 0;  // not run, their groups are unchanged since they passed
+    double wall_seconds   = 0;
+    double case_seconds   = 0;  // the sum of the case durations
+    std::vector<TestCaseResult> results;
+};
+
+/* Runs the UNIT_TEST and INTEGRATION_TEST cases registered to TestGroupManager on a pool of worker
+ * threads. The cases are scheduled longest first according to the timing database, so the wall
+ * time gets close to the total case time divided by the job count. Results are printed as the
+ * cases finish.
+ */
+class TestRunner {
+    TestRunOptions m_options;
+    std::unordered_map<std::string, double> m_timings;
+    struct GroupState {
+        std::uint64_t hash;
+        bool passed;
+    };
+    std::unordered_map<std::string, GroupState> m_states;
+
+    void load_timings();
+    void save_timings(const TestRunSummary& summary) const;
+    void load_states();
+    void save_states() const;
+    TestCaseResult run_case(const TestCaseInfo& info, const std::string& id) const;
+    TestCaseResult run_isolated(const TestCaseInfo& info, const std::string& id) const;
+
+public:
+    explicit TestRunner(TestRunOptions options);
+    TestRunSummary run(std::ostream& out);
+};
+
+/* The hash of the source file of a group and of the files it includes, recursively, and of the code
+ * of a TEST group. 0 if the source file isn't found, the group is then always run.
+ */
+std::uint64_t test_group_hash(const TestGroup& group, const std::vector<std::string>& include_dirs);
+
+// Run one case in current process, used by the child processes of isolated runs.
+// Return the process exit code.
+int run_single_test_case(const std::string& id);
+
+/* A main() for test binaries:
+ *     int main(int argc, char** argv) { return nstd::test_main(argc, argv); }
+ * Options: -j <jobs>, --isolate, --timeout <seconds>, --filter <text>, --timing-db <path>,
+ * --unit, --integration, --all, --state <path>, -I <dir>.
+ */
+int test_main(int argc, char** argv);
+
+}  // namespace nstd
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef __NSTD_TYPE_LIST_HPP__
+#define __NSTD_TYPE_LIST_HPP__
+
+#include <cstddef>
+#include <type_traits>
+#include "marker.hpp"
+#include "utility.hpp"
+
+namespace nstd {
+
+/* A list of types and its algorithms. None of them recurses over the elements, so the template
+ * depth stays constant. A list builds one index set, a class with every (index, type) as a base,
+ * and looks its types up by overload resolution against it, instead of instantiating a template
+ * over the whole pack per lookup. The compile time is kept in check by bench/ctbench_meta.cpp.
+ * The _v forms instantiate a variable per use, which GCC pays for again in code generation: in
+ * generated code with many lookups, prefer ::value.
+ */
+template <typename... Ts>
+struct type_list {
+    static constexpr std::size_t size = sizeof...(Ts);
+};
+
+namespace _internal0_impl0_type_list {
+    constexpr std::size_t NPOS = std::size_t(-1);
+
+    template <typename T>
+    struct type_is {
+        using type = T;
+    };
+    template <std::size_t I, typename T>
+    struct indexed {};
+
+    template <typename Is, typename... Ts>
+    struct index_set;
+    template <std::size_t... Is, typename... Ts>
+    struct index_set<nstd::index_sequence<Is...>, Ts...> : indexed<Is, Ts>... {};
+    template <typename L>
+    struct index_set_of;
+    template <typename... Ts>
+    struct index_set_of<type_list<Ts...>> {
+        using type = index_set<nstd::make_index_sequence<sizeof...(Ts)>, Ts...>;
+    };
+    template <typename L>
+    using index_set_ptr = typename index_set_of<L>::type*;
+
+    // Only in decltype. A type of the set is deduced from its unique base for the index, an index
+    // from the base for the type, which fails if the type is missing or repeated.
+    template <std::size_t I, typename T>
+    type_is<T> at(const indexed<I, T>*);
+    template <typename T, std::size_t I>
+    std::integral_constant<std::size_t, I> index_of(const indexed<I, T>*);
+    template <typename T>
+    std::integral_constant<std::size_t, NPOS> index_of(...);
+
+    // One tag per type, the addresses of the tags compare types in constant expressions.
+    template <typename T>
+    struct type_tag {
+        static constexpr char id = 0;
+    };
+
+    // Unless the comparison of two addresses isn't folded, as by GCC with
+    // -fno-delete-null-pointer-checks, which -fsanitize=undefined implies. The types are compared
+    // with a builtin then, slower when many are repeated.
+    template <typename T, typename = void>
+    struct tags_compare : std::false_type {};
+    template <typename T>
+    struct tags_compare<T, std::enable_if_t<(&type_tag<T>::id != &type_tag<T*>::id)>>
+        : std::true_type {};
+    constexpr bool TAGS_COMPARE = tags_compare<void>::value;
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 10)
+#define __NSTD_TYPE_LIST_SAME(A, B) __is_same(A, B)
+#else
+#define __NSTD_TYPE_LIST_SAME(A, B) std::is_same<A, B>::value
+#endif
+
+    // The slow path of find, when T is missing or repeated: a scan.
+    template <typename T, typename... Ts>
+    constexpr std::size_t scan() noexcept
+    {
+        std::size_t i = 0;
+        IF_CONSTEXPR(TAGS_COMPARE)
+        {
+            constexpr const void* ids[] = {nullptr, &type_tag<Ts>::id...};
+            while(i < sizeof...(Ts) && ids[i + 1] != &type_tag<T>::id) { ++i; }
+        }
+        else
+        {
+            constexpr bool same[] = {false, __NSTD_TYPE_LIST_SAME(T, Ts)...};
+            while(i < sizeof...(Ts) && !same[i + 1]) { ++i; }
+        }
+        return i;
+    }
+    template <typename T, typename L>
+    struct scan_t;
+    template <typename T, typename... Ts>
+    struct scan_t<T, type_list<Ts...>> : std::integral_constant<std::size_t, scan<T, Ts...>()> {};
+
+    // No static data member of its own: a variable named after the whole list per lookup makes
+    // the code generation of GCC quadratic.
+    template <typename L, typename T>
+    using fast_find_t = decltype(index_of<T>(index_set_ptr<L>()));
+    template <typename L, typename T>
+    using find_t = std::conditional_t<fast_find_t<L, T>::value != NPOS, fast_find_t<L, T>,
+                                      scan_t<T, L>>;
+
+    template <std::size_t N>
+    struct indices {
+        std::size_t at[N + 1] = {};  // + 1, an array can't be empty
+        std::size_t size      = 0;
+    };
+
+    // The indices of the first occurrence of every type of Ts.
+    template <typename... Ts>
+    constexpr indices<sizeof...(Ts)> first_indices() noexcept
+    {
+        indices<sizeof...(Ts)> r{};
+        IF_CONSTEXPR(TAGS_COMPARE)
+        {
+            constexpr const void* ids[] = {nullptr, &type_tag<Ts>::id...};
+            for(std::size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                std::size_t j = 0;
+                while(j < i && ids[j + 1] != ids[i + 1]) { ++j; }
+                if(j == i) { r.at[r.size++] = i; }
+            }
+        }
+        else
+        {
+            // The unique types are found by the index set, only the repeated ones are scanned.
+            constexpr std::size_t firsts[] = {0, find_t<type_list<Ts...>, Ts>::value...};
+            for(std::size_t i = 0; i < sizeof...(Ts); ++i)
+            {
+                if(firsts[i + 1] == i) { r.at[r.size++] = i; }
+            }
+        }
+        return r;
+    }
+    template <typename... Ts>
+    inline constexpr indices<sizeof...(Ts)> first_indices_v = first_indices<Ts...>();
+
+    template <typename Is, typename L>
+    struct unique_impl;
+    template <std::size_t... Is, typename... Ts>
+    struct unique_impl<nstd::index_sequence<Is...>, type_list<Ts...>> {
+        using type = type_list<typename decltype(
+            at<first_indices_v<Ts...>.at[Is]>(index_set_ptr<type_list<Ts...>>()))::type...>;
+    };
+}  // namespace _internal0_impl0_type_list
+
+template <typename L>
+inline constexpr std::size_t type_list_size_v = L::size;
+
+// The I-th type of L.
+template <typename L, std::size_t I>
+struct type_list_at {
+    static_assert(I < L::size, "The index is out of the type list.");
+    using type = typename decltype(_internal0_impl0_type_list::at<I>(
+        _internal0_impl0_type_list::index_set_ptr<L>()))::type;
+};
+template <typename L, std::size_t I>
+using type_list_at_t = typename type_list_at<L, I>::type;
+
+// The index of the first T in L, the size of L if T isn't in it.
+template <typename L, typename T>
+struct type_list_find
+    : std::integral_constant<std::size_t, _internal0_impl0_type_list::find_t<L, T>::value> {};
+template <typename L, typename T>
+inline constexpr std::size_t type_list_find_v = type_list_find<L, T>::value;
+template <typename L, typename T>
+inline constexpr bool type_list_contains_v = type_list_find<L, T>::value < L::size;
+
+// L without the repeated types, the first occurrences kept in order.
+template <typename L>
+struct type_list_unique;
+template <typename... Ts>
+struct type_list_unique<type_list<Ts...>>
+    : _internal0_impl0_type_list::unique_impl<
+          nstd::make_index_sequence<_internal0_impl0_type_list::first_indices_v<Ts...>.size>,
+          type_list<Ts...>> {};
+template <typename L>
+using type_list_unique_t = typename type_list_unique<L>::type;
+
+// The lists joined in order. The depth grows by one per 3 lists, not with their sizes.
+template <typename... Ls>
+struct type_list_concat;
+template <>
+struct type_list_concat<> {
+    using type = type_list<>;
+};
+template <typename... Ts>
+struct type_list_concat<type_list<Ts...>> {
+    using type = type_list<Ts...>;
+};
+template <typename... As, typename... Bs>
+struct type_list_concat<type_list<As...>, type_list<Bs...>> {
+    using type = type_list<As..., Bs...>;
+};
+template <typename... As, typename... Bs, typename... Cs>
+struct type_list_concat<type_list<As...>, type_list<Bs...>, type_list<Cs...>> {
+    using type = type_list<As..., Bs..., Cs...>;
+};
+template <typename... As, typename... Bs, typename... Cs, typename... Ds, typename... Ls>
+struct type_list_concat<type_list<As...>, type_list<Bs...>, type_list<Cs...>, type_list<Ds...>,
+                        Ls...>
+    : type_list_concat<type_list<As..., Bs..., Cs..., Ds...>, Ls...> {};
+template <typename... Ls>
+using type_list_concat_t = typename type_list_concat<Ls...>::type;
+
+// T<the types of L...>, e.g. type_list_apply_t<std::variant, type_list_unique_t<L>>.
+template <template <typename...> class T, typename L>
+struct type_list_apply;
+template <template <typename...> class T, typename... Ts>
+struct type_list_apply<T, type_list<Ts...>> {
+    using type = T<Ts...>;
+};
+template <template <typename...> class T, typename L>
+using type_list_apply_t = typename type_list_apply<T, L>::type;
+
+}  // namespace nstd
+
+#undef __NSTD_TYPE_LIST_SAME
+
+#endif
@@ -4,7 +4,8 @@
 
 #include <utility>
 
-#ifdef __cpp_lib_integer_sequence
+// NSTD_NO_STD_INTEGER_SEQUENCE forces the fallback, to measure it.
+#if defined(__cpp_lib_integer_sequence) && !defined(NSTD_NO_STD_INTEGER_SEQUENCE)
 #define __NSTD_LIB_HAS_INTERGER_SEQUENCE
 #else
 #include <cstddef>
@@ -12,4 +12,12 @@
 #include <version>
 #endif
 
+// The exception-free mode: the library has no try/catch and reports its failures through Result
+// only. It's on when the exceptions are disabled (-fno-exceptions), define NSTD_NO_EXCEPTIONS to
+// have it anyway.
+#if !defined(NSTD_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && \
+    !defined(_CPPUNWIND)
+#define NSTD_NO_EXCEPTIONS
+#endif
+
 #endif
@@ -0,0 +1,218 @@
+#include "alloc_tracker.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include "version.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_alloc_tracker {
+    struct Counts {
+        std::uint64_t allocs;
+        std::uint64_t frees;
+        std::uint64_t bytes;
+    };
+
+    // Initial exec, so reading it never allocates: malloc may be what reads it.
+#if defined(__GNUC__) || defined(__clang__)
+    thread_local Counts counts __attribute__((tls_model("initial-exec"))) = {0, 0, 0};
+#else
+    thread_local Counts counts = {0, 0, 0};
+#endif
+
+    inline void on_alloc(std::size_t n) noexcept
+    {
+        ++counts.allocs;
+        counts.bytes += n;
+    }
+    inline void on_free() noexcept { ++counts.frees; }
+}  // namespace _internal0_impl0_alloc_tracker
+
+bool alloc_tracking_enabled() noexcept
+{
+#ifdef NSTD_ALLOC_TRACKER
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocStats alloc_stats() noexcept
+{
+    const auto& c = _internal0_impl0_alloc_tracker::counts;
+    return AllocStats{c.allocs, c.frees, c.bytes};
+}
+
+void fail_expect_allocations(std::uint64_t max_allocs, const AllocStats& got)
+{
+    std::string msg = "Expected at most " + std::to_string(max_allocs) + " allocations, got " +
+                      std::to_string(got.allocs) + " (" + std::to_string(got.bytes) + " bytes).";
+#ifdef NSTD_NO_EXCEPTIONS
+    std::cerr << msg << '\n';
+    std::abort();
+#else
+    throw std::runtime_error(msg);
+#endif
+}
+
+}  // namespace nstd
+
+#ifdef NSTD_ALLOC_TRACKER
+#if defined(__GLIBC__)
+// malloc is interposed, operator new and the C code are counted by it.
+#define __NSTD_ALLOC_TRACKER_MALLOC
+extern "C" {
+void* __libc_malloc(std::size_t n);
+void* __libc_calloc(std::size_t count, std::size_t n);
+void* __libc_realloc(void* p, std::size_t n);
+void* __libc_memalign(std::size_t align, std::size_t n);
+void* __libc_valloc(std::size_t n);
+void* __libc_pvalloc(std::size_t n);
+void __libc_free(void* p);
+
+void* malloc(std::size_t n)
+{
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    return __libc_malloc(n);
+}
+
+void* calloc(std::size_t count, std::size_t n)
+{
+    if(n != 0 && count > SIZE_MAX / n)
+    {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(count * n);
+    return __libc_calloc(count, n);
+}
+
+void* realloc(void* p, std::size_t n)
+{
+    // A new block and the free of the old one.
+    if(n != 0) { nstd::_internal0_impl0_alloc_tracker::on_alloc(n); }
+    if(p != nullptr) { nstd::_internal0_impl0_alloc_tracker::on_free(); }
+    return __libc_realloc(p, n);
+}
+
+void* aligned_alloc(std::size_t align, std::size_t n)
+{
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    return __libc_memalign(align, n);
+}
+
+// The obsolete ones as well, or their blocks would only be counted when freed.
+void* memalign(std::size_t align, std::size_t n)
+{
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    return __libc_memalign(align, n);
+}
+
+void* valloc(std::size_t n)
+{
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    return __libc_valloc(n);
+}
+
+void* pvalloc(std::size_t n)
+{
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    return __libc_pvalloc(n);
+}
+
+int posix_memalign(void** out, std::size_t align, std::size_t n)
+{
+    if(align < sizeof(void*) || (align & (align - 1)) != 0) { return EINVAL; }
+    nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+    void* p = __libc_memalign(align, n);
+    if(p == nullptr) { return ENOMEM; }
+    *out = p;
+    return 0;
+}
+
+void free(void* p)
+{
+    if(p != nullptr) { nstd::_internal0_impl0_alloc_tracker::on_free(); }
+    __libc_free(p);
+}
+}
+#endif
+
+namespace _internal0_impl0_alloc_tracker_new {
+    inline void* allocate(std::size_t n) noexcept
+    {
+#ifndef __NSTD_ALLOC_TRACKER_MALLOC
+        nstd::_internal0_impl0_alloc_tracker::on_alloc(n);
+#endif
+        return std::malloc(n == 0 ? 1 : n);
+    }
+    inline void deallocate(void* p) noexcept
+    {
+#ifndef __NSTD_ALLOC_TRACKER_MALLOC
+        if(p != nullptr) { nstd::_internal0_impl0_alloc_tracker::on_free(); }
+#endif
+        std::free(p);
+    }
+}  // namespace _internal0_impl0_alloc_tracker_new
+
+void* operator new(std::size_t n)
+{
+    void* p = _internal0_impl0_alloc_tracker_new::allocate(n);
+#ifdef NSTD_NO_EXCEPTIONS
+    if(p == nullptr) { std::abort(); }
+#else
+    if(p == nullptr) { throw std::bad_alloc(); }
+#endif
+    return p;
+}
+
+void* operator new[](std::size_t n)
+{
+    void* p = _internal0_impl0_alloc_tracker_new::allocate(n);
+#ifdef NSTD_NO_EXCEPTIONS
+    if(p == nullptr) { std::abort(); }
+#else
+    if(p == nullptr) { throw std::bad_alloc(); }
+#endif
+    return p;
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    return _internal0_impl0_alloc_tracker_new::allocate(n);
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+    return _internal0_impl0_alloc_tracker_new::allocate(n);
+}
+
+void operator delete(void* p) noexcept { _internal0_impl0_alloc_tracker_new::deallocate(p); }
+
+void operator delete[](void* p) noexcept { _internal0_impl0_alloc_tracker_new::deallocate(p); }
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    _internal0_impl0_alloc_tracker_new::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    _internal0_impl0_alloc_tracker_new::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    _internal0_impl0_alloc_tracker_new::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    _internal0_impl0_alloc_tracker_new::deallocate(p);
+}
+#endif
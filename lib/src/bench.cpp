@@ -0,0 +1,659 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include "bench_baseline.hpp"
+#include "bench_complexity.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_bench {
+    // The benchmark whose setup is running, for bench_bytes() and bench_items().
+    thread_local BenchRunner::State* current = nullptr;
+
+    constexpr std::uint64_t MAX_ITERS = std::uint64_t(1) << 40;
+
+    // Seconds taken by `iters` calls of f.
+    inline double time_calls(const BenchFunc& f, std::uint64_t iters) noexcept
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(std::uint64_t i = 0; i < iters; ++i)
+        {
+            f();
+            clobber_memory();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    inline double percentile(const std::vector<double>& sorted, double q) noexcept
+    {
+        double pos     = q * double(sorted.size() - 1);
+        std::size_t lo = std::size_t(pos);
+        if(lo + 1 >= sorted.size()) { return sorted.back(); }
+        return sorted[lo] + (sorted[lo + 1] - sorted[lo]) * (pos - double(lo));
+    }
+
+    // "12.3 ns", "4.56 us", ... with 3 significant digits.
+    inline std::string fmt_ns(double ns)
+    {
+        const char* units[] = {"ns", "us", "ms", "s"};
+        int u               = 0;
+        while(u < 3 && ns >= 1000)
+        {
+            ns /= 1000;
+            ++u;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), ns < 10 ? "%.2f %s" : (ns < 100 ? "%.1f %s" : "%.0f %s"),
+                      ns, units[u]);
+        return buf;
+    }
+
+    inline std::string fmt_rate(double v, const char* unit)
+    {
+        const char* prefixes[] = {"", "K", "M", "G", "T"};
+        int p                  = 0;
+        while(p < 4 && v >= 1000)
+        {
+            v /= 1000;
+            ++p;
+        }
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%.3g %s%s", v, prefixes[p], unit);
+        return buf;
+    }
+
+    inline void write_usage(std::ostream& out, const char* exe)
+    {
+        out << "Usage: " << exe << " [options]\n"
+               "  --filter <text>         only the benchmarks whose group::case contains text\n"
+               "  --samples <n>           samples per benchmark\n"
+               "  --sample-ms <ms>        duration of a sample\n"
+               "  --warmup-ms <ms>        warmup before the samples\n"
+               "  --json <path>           write the results as JSON\n"
+               "  --no-counters           don't count the hardware events\n"
+               "  --cpu <n>               pin the measuring thread to a CPU\n"
+               "  --high-priority         raise the priority of the measuring thread\n"
+               "  --interleave            sample the benchmarks in rounds, in a random order\n"
+               "  --flush-cache           flush the caches before every sample\n"
+               "  --max-noise <percent>   trust the results whose spread is below this\n"
+               "  --save-baseline <name>  save the samples as a baseline\n"
+               "  --baseline <name>       compare with a baseline, exit 1 on a regression\n"
+               "  --baseline-dir <dir>    where the baselines are, .nstd_bench by default\n"
+               "  --confidence <0..1>     confidence of a significant change\n"
+               "  --threshold <percent>   smallest change of the median which counts\n"
+               "  -h, --help              print this help\n";
+    }
+}  // namespace _internal0_impl0_bench
+
+void bench_bytes(std::uint64_t bytes) noexcept
+{
+    using _internal0_impl0_bench::current;
+    if(current != nullptr) { current->bytes = bytes; }
+}
+
+void bench_items(std::uint64_t items) noexcept
+{
+    using _internal0_impl0_bench::current;
+    if(current != nullptr) { current->items = items; }
+}
+
+std::int64_t bench_arg(std::size_t i) noexcept
+{
+    using _internal0_impl0_bench::current;
+    return current != nullptr && i < current->args.size() ? current->args[i] : 0;
+}
+
+std::vector<BenchInstance> bench_instances(const TestCaseInfo& info, const std::string& id)
+{
+    std::vector<BenchInstance> instances{BenchInstance{id, {}}};
+    for(std::size_t r = 0; r < info.range_count; ++r)
+    {
+        const BenchRange& range = info.ranges[r];
+        // Stepping by 1 could make millions of instances, a mult below 2 is taken as 2.
+        const std::int64_t mult = range.mult < 2 ? 2 : range.mult;
+        std::vector<std::int64_t> values;
+        for(std::int64_t v = range.lo; v < range.hi;)
+        {
+            values.push_back(v);
+            if(v < 1) { v = 1; }
+            else if(v > range.hi / mult) { break; }
+            else { v *= mult; }
+        }
+        values.push_back(range.hi);
+        // The cartesian product, the last argument varies slowest.
+        std::vector<BenchInstance> grown;
+        grown.reserve(instances.size() * values.size());
+        for(std::int64_t v : values)
+        {
+            for(const auto& inst : instances)
+            {
+                BenchInstance next{inst.id + "/" + std::to_string(v), inst.args};
+                next.args.push_back(v);
+                grown.push_back(std::move(next));
+            }
+        }
+        instances = std::move(grown);
+    }
+    return instances;
+}
+
+BenchStats compute_bench_stats(std::vector<double> samples)
+{
+    using _internal0_impl0_bench::percentile;
+    BenchStats stats;
+    stats.count = samples.size();
+    if(samples.empty()) { return stats; }
+    std::sort(samples.begin(), samples.end());
+    stats.min    = samples.front();
+    stats.max    = samples.back();
+    stats.median = percentile(samples, 0.5);
+    stats.p90    = percentile(samples, 0.9);
+    stats.p99    = percentile(samples, 0.99);
+    double sum   = 0;
+    for(double s : samples) { sum += s; }
+    stats.mean = sum / double(samples.size());
+    for(double& s : samples) { s = std::fabs(s - stats.median); }
+    std::sort(samples.begin(), samples.end());
+    stats.mad = percentile(samples, 0.5);
+    return stats;
+}
+
+double BenchResult::throughput() const noexcept
+{
+    if(stats.median <= 0) { return 0; }
+    double per_call = bytes != 0 ? double(bytes) : (items != 0 ? double(items) : 1.0);
+    return per_call * 1e9 / stats.median;
+}
+
+const char* BenchResult::throughput_unit() const noexcept
+{
+    return bytes != 0 ? "B/s" : (items != 0 ? "items/s" : "calls/s");
+}
+
+BenchRunner::BenchRunner(BenchOptions options) : m_options(std::move(options))
+{
+    if(m_options.samples == 0) { m_options.samples = 1; }
+}
+
+double BenchResult::per_call(PerfEvent e) const noexcept
+{
+    double calls = double(iters) * double(samples.size());
+    return counters.has(e) && calls > 0 ? double(counters.get(e)) / calls : 0;
+}
+
+double BenchResult::allocs_per_call() const noexcept
+{
+    double calls = double(iters) * double(samples.size());
+    return calls > 0 ? double(allocs.allocs) / calls : 0;
+}
+
+double BenchResult::alloc_bytes_per_call() const noexcept
+{
+    double calls = double(iters) * double(samples.size());
+    return calls > 0 ? double(allocs.bytes) / calls : 0;
+}
+
+double BenchResult::ipc() const noexcept
+{
+    if(!counters.has(PerfEvent::CYCLES) || !counters.has(PerfEvent::INSTRUCTIONS) ||
+       counters.get(PerfEvent::CYCLES) == 0)
+    {
+        return 0;
+    }
+    return double(counters.get(PerfEvent::INSTRUCTIONS)) / double(counters.get(PerfEvent::CYCLES));
+}
+
+bool BenchRunner::prepare(const TestCaseInfo& info,
+                          const std::string& id,
+                          State& state,
+                          const std::vector<std::int64_t>& args)
+{
+    using namespace _internal0_impl0_bench;
+    if(m_options.perf_counters && !m_counters_tried)
+    {
+        m_counters_tried = true;
+        m_counters.open();
+    }
+    if(m_options.flush_cache && m_flusher == nullptr) { m_flusher.reset(new CacheFlusher()); }
+    state      = State{};
+    state.id   = id;
+    state.args = args;
+    if(info.bench == nullptr) { return false; }
+    current = &state;
+    info.bench(state.func);
+    if(state.func == nullptr)
+    {
+        current = nullptr;
+        return false;
+    }
+
+    // Warm up the caches, the branch predictors and the CPU frequency.
+    double spent = 0;
+    for(std::uint64_t n = 1; spent < m_options.warmup_seconds; n = std::min(n * 2, MAX_ITERS))
+    {
+        spent += time_calls(state.func, n);
+    }
+    // Grow the calls per sample until a sample takes sample_seconds.
+    std::uint64_t iters = 1;
+    for(;;)
+    {
+        double t = time_calls(state.func, iters);
+        if(t >= m_options.sample_seconds || iters >= MAX_ITERS) { break; }
+        double scale = t > 0 ? m_options.sample_seconds / t * 1.2 : 100;
+        scale        = std::min(std::max(scale, 2.0), 100.0);
+        iters        = std::min(std::uint64_t(double(iters) * scale), MAX_ITERS);
+    }
+    current     = nullptr;
+    state.iters = iters;
+    state.samples.reserve(m_options.samples);
+    return true;
+}
+
+void BenchRunner::sample(State& state)
+{
+    using namespace _internal0_impl0_bench;
+    if(m_flusher != nullptr) { m_flusher->flush(); }
+    int cpu                = current_cpu();
+    std::uint64_t switches = thread_context_switches();
+    current                = &state;
+    AllocScope allocs;
+    m_counters.start();
+    double t = time_calls(state.func, state.iters);
+    m_counters.stop();
+    state.allocs += allocs.delta();
+    current = nullptr;
+    // The probes of the interference, out of the measurement.
+    int end_cpu = current_cpu();
+    state.noise.context_switches += thread_context_switches() - switches;
+    if(cpu != end_cpu) { ++state.noise.migrations; }
+    double mhz = cpu_frequency_mhz(end_cpu);
+    if(mhz > 0)
+    {
+        if(state.noise.min_mhz == 0 || mhz < state.noise.min_mhz) { state.noise.min_mhz = mhz; }
+        state.noise.max_mhz = std::max(state.noise.max_mhz, mhz);
+    }
+    PerfCounts counts = m_counters.read();
+    if(state.samples.empty()) { state.counters = counts; }
+    else { state.counters += counts; }
+    state.samples.push_back(t * 1e9 / double(state.iters));
+}
+
+BenchResult BenchRunner::finish(State&& state) const
+{
+    BenchResult result;
+    result.id       = std::move(state.id);
+    result.iters    = state.iters;
+    result.bytes    = state.bytes;
+    result.items    = state.items;
+    result.stats    = compute_bench_stats(state.samples);
+    result.counters = state.counters;
+    result.allocs   = state.allocs;
+    result.noise    = state.noise;
+    // Trusted unless the samples spread or something disturbed them.
+    BenchNoise& noise = result.noise;
+    noise.spread =
+        result.stats.median > 0 ? result.stats.mad * 1.4826 / result.stats.median : 0;
+    char reason[160];
+    auto add_reason = [&noise](const char* r) {
+        noise.reason += (noise.reason.empty() ? "" : ", ") + std::string(r);
+        noise.trusted = false;
+    };
+    if(noise.spread > m_options.max_noise)
+    {
+        std::snprintf(reason, sizeof(reason), "spread %.1f%%", noise.spread * 100);
+        add_reason(reason);
+    }
+    if(noise.migrations != 0)
+    {
+        std::snprintf(reason, sizeof(reason), "%llu migrations",
+                      static_cast<unsigned long long>(noise.migrations));
+        add_reason(reason);
+    }
+    if(noise.min_mhz > 0 && noise.max_mhz > noise.min_mhz * 1.05)
+    {
+        std::snprintf(reason, sizeof(reason), "frequency %.0f-%.0f MHz", noise.min_mhz,
+                      noise.max_mhz);
+        add_reason(reason);
+    }
+    result.samples = std::move(state.samples);
+    return result;
+}
+
+void BenchRunner::setup_thread(std::ostream& out)
+{
+    if(m_options.cpu >= 0)
+    {
+        bool pinned = pin_thread_to_cpu(m_options.cpu);
+        out << "[ ENV     ] " << (pinned ? "pinned to CPU " : "pinning failed, CPU ")
+            << m_options.cpu << '\n';
+    }
+    if(m_options.high_priority)
+    {
+        std::string got = raise_thread_priority();
+        out << "[ ENV     ] " << (got.empty() ? "raising the priority failed" : "priority " + got)
+            << '\n';
+    }
+}
+
+std::vector<BenchResult> BenchRunner::run(std::ostream& out)
+{
+    setup_thread(out);
+    // The jobs point into the groups.
+    const std::vector<TestGroup> groups = TestGroupManager::get_obj().get_groups();
+    std::vector<std::pair<const TestCaseInfo*, BenchInstance>> jobs;
+    for(const auto& group : groups)
+    {
+        for(const auto& info : group.get_cases())
+        {
+            if(info.kind != TestKind::BENCHMARK) { continue; }
+            std::string id = group.get_group_name() + "::" + info.name;
+            if(!m_options.filter.empty() && id.find(m_options.filter) == std::string::npos)
+            {
+                continue;
+            }
+            for(auto& inst : bench_instances(info, id))
+            {
+                jobs.emplace_back(&info, std::move(inst));
+            }
+        }
+    }
+    std::vector<BenchResult> results;
+    auto report = [&out](const BenchResult& r) {
+        out << "[ BENCHED ] " << r.id << " (" << r.samples.size() << " x " << r.iters << " calls)\n"
+            << std::flush;
+    };
+    if(!m_options.interleave)
+    {
+        for(const auto& job : jobs)
+        {
+            State state;
+            if(!prepare(*job.first, job.second.id, state, job.second.args))
+            {
+                out << "[ SKIPPED ] " << job.second.id << " (no benchmark function)\n";
+                continue;
+            }
+            for(unsigned int i = 0; i < m_options.samples; ++i) { sample(state); }
+            results.push_back(finish(std::move(state)));
+            report(results.back());
+        }
+        return results;
+    }
+    // All the setups run first, so a setup mustn't depend on state another setup overwrites.
+    std::vector<State> states;
+    states.reserve(jobs.size());
+    for(const auto& job : jobs)
+    {
+        states.emplace_back();
+        if(!prepare(*job.first, job.second.id, states.back(), job.second.args))
+        {
+            out << "[ SKIPPED ] " << job.second.id << " (no benchmark function)\n";
+            states.pop_back();
+        }
+    }
+    std::vector<std::size_t> order(states.size());
+    for(std::size_t i = 0; i < order.size(); ++i) { order[i] = i; }
+    std::mt19937_64 rng{std::random_device{}()};
+    for(unsigned int round = 0; round < m_options.samples; ++round)
+    {
+        std::shuffle(order.begin(), order.end(), rng);
+        for(std::size_t i : order) { sample(states[i]); }
+    }
+    for(auto& state : states)
+    {
+        results.push_back(finish(std::move(state)));
+        report(results.back());
+    }
+    return results;
+}
+
+void write_bench_table(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    using namespace _internal0_impl0_bench;
+    std::size_t width = 9;
+    bool counted      = false;
+    bool allocs       = alloc_tracking_enabled();
+    for(const auto& r : results)
+    {
+        width   = std::max(width, r.id.size());
+        counted = counted || r.counters.valid != 0;
+    }
+    // The counter columns are per call, except IPC.
+    char buf[512];
+    int n = std::snprintf(buf, sizeof(buf), "%-*s %12s %10s %10s %10s %10s %7s %16s", int(width),
+                          "benchmark", "calls", "median", "MAD", "p90", "p99", "noise",
+                          "throughput");
+    if(counted && n > 0 && std::size_t(n) < sizeof(buf))
+    {
+        std::snprintf(buf + n, sizeof(buf) - std::size_t(n), " %6s %10s %10s %10s %8s", "IPC",
+                      "br-miss", "L1D-miss", "LLC-miss", "ctx-sw");
+    }
+    out << buf;
+    // Allocations per call.
+    if(allocs)
+    {
+        std::snprintf(buf, sizeof(buf), " %8s %10s", "allocs", "alloc-B");
+        out << buf;
+    }
+    out << '\n';
+    for(const auto& r : results)
+    {
+        // An untrusted result is marked by a '?' after its noise.
+        char noise[16];
+        std::snprintf(noise, sizeof(noise), "%.1f%%%s", r.noise.spread * 100,
+                      r.noise.trusted ? " " : "?");
+        n = std::snprintf(buf, sizeof(buf), "%-*s %12llu %10s %10s %10s %10s %7s %16s", int(width),
+                          r.id.c_str(), static_cast<unsigned long long>(r.iters),
+                          fmt_ns(r.stats.median).c_str(), fmt_ns(r.stats.mad).c_str(),
+                          fmt_ns(r.stats.p90).c_str(), fmt_ns(r.stats.p99).c_str(), noise,
+                          fmt_rate(r.throughput(), r.throughput_unit()).c_str());
+        if(counted && n > 0 && std::size_t(n) < sizeof(buf))
+        {
+            auto col = [&r](PerfEvent e, const char* fmt, double v, char* cell, std::size_t size) {
+                if(r.counters.has(e)) { std::snprintf(cell, size, fmt, v); }
+                else { std::snprintf(cell, size, "-"); }
+            };
+            char ipc[16], br[16], l1[16], llc[16], cs[24];
+            col(PerfEvent::INSTRUCTIONS, "%.2f", r.ipc(), ipc, sizeof(ipc));
+            if(!r.counters.has(PerfEvent::CYCLES)) { std::snprintf(ipc, sizeof(ipc), "-"); }
+            col(PerfEvent::BRANCH_MISSES, "%.3g", r.per_call(PerfEvent::BRANCH_MISSES), br,
+                sizeof(br));
+            col(PerfEvent::L1D_MISSES, "%.3g", r.per_call(PerfEvent::L1D_MISSES), l1, sizeof(l1));
+            col(PerfEvent::LLC_MISSES, "%.3g", r.per_call(PerfEvent::LLC_MISSES), llc, sizeof(llc));
+            col(PerfEvent::CONTEXT_SWITCHES, "%.0f",
+                double(r.counters.get(PerfEvent::CONTEXT_SWITCHES)), cs, sizeof(cs));
+            std::snprintf(buf + n, sizeof(buf) - std::size_t(n), " %6s %10s %10s %10s %8s", ipc,
+                          br, l1, llc, cs);
+        }
+        out << buf;
+        if(allocs)
+        {
+            std::snprintf(buf, sizeof(buf), " %8.3g %10.4g", r.allocs_per_call(),
+                          r.alloc_bytes_per_call());
+            out << buf;
+        }
+        out << '\n';
+    }
+    for(const auto& r : results)
+    {
+        if(!r.noise.trusted) { out << "? " << r.id << ": " << r.noise.reason << '\n'; }
+    }
+}
+
+void write_bench_json(std::ostream& out, const std::vector<BenchResult>& results)
+{
+    using _internal0_impl0_bench::json_string;
+    auto flags = out.flags();
+    auto prec  = out.precision(10);
+    out << "{\"benchmarks\": [";
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+        json_string(out, r.id);
+        out << ", \"calls_per_sample\": " << r.iters << ", \"bytes_per_call\": " << r.bytes
+            << ", \"items_per_call\": " << r.items << ", \"unit\": \"ns\""
+            << ", \"min\": " << r.stats.min << ", \"max\": " << r.stats.max
+            << ", \"mean\": " << r.stats.mean << ", \"median\": " << r.stats.median
+            << ", \"mad\": " << r.stats.mad << ", \"p90\": " << r.stats.p90
+            << ", \"p99\": " << r.stats.p99 << ", \"throughput\": " << r.throughput()
+            << ", \"throughput_unit\": \"" << r.throughput_unit() << "\"";
+        if(r.counters.valid != 0)
+        {
+            // Per call, except context_switches which is the total of all the samples.
+            out << ", \"counters\": {";
+            const char* sep = "";
+            for(std::size_t e = 0; e < PERF_EVENT_COUNT; ++e)
+            {
+                auto ev = static_cast<PerfEvent>(e);
+                if(!r.counters.has(ev)) { continue; }
+                out << sep << '"' << perf_event_name(ev) << "\": "
+                    << (ev == PerfEvent::CONTEXT_SWITCHES ? double(r.counters.get(ev))
+                                                          : r.per_call(ev));
+                sep = ", ";
+            }
+            if(r.ipc() > 0) { out << sep << "\"ipc\": " << r.ipc(); }
+            out << "}";
+        }
+        const BenchNoise& noise = r.noise;
+        out << ", \"noise\": {\"spread\": " << noise.spread
+            << ", \"migrations\": " << noise.migrations
+            << ", \"context_switches\": " << noise.context_switches
+            << ", \"min_mhz\": " << noise.min_mhz << ", \"max_mhz\": " << noise.max_mhz
+            << ", \"trusted\": " << (noise.trusted ? "true" : "false") << "}";
+        if(alloc_tracking_enabled())
+        {
+            out << ", \"allocs_per_call\": " << r.allocs_per_call()
+                << ", \"alloc_bytes_per_call\": " << r.alloc_bytes_per_call();
+        }
+        out << ", \"samples\": [";
+        for(std::size_t j = 0; j < r.samples.size(); ++j)
+        {
+            out << (j == 0 ? "" : ", ") << r.samples[j];
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+    out.precision(prec);
+    out.flags(flags);
+}
+
+int bench_main(int argc, char** argv, void (*before_run)())
+{
+    BenchOptions options;
+    BenchCompareOptions compare;
+    std::string json, save_name, base_name, base_dir = ".nstd_bench";
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+        else if(arg == "--samples" && i + 1 < argc)
+        {
+            options.samples = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--sample-ms" && i + 1 < argc)
+        {
+            options.sample_seconds = std::strtod(argv[++i], nullptr) / 1000;
+        }
+        else if(arg == "--warmup-ms" && i + 1 < argc)
+        {
+            options.warmup_seconds = std::strtod(argv[++i], nullptr) / 1000;
+        }
+        else if(arg == "--json" && i + 1 < argc) { json = argv[++i]; }
+        else if(arg == "--no-counters") { options.perf_counters = false; }
+        else if(arg == "--cpu" && i + 1 < argc) { options.cpu = std::atoi(argv[++i]); }
+        else if(arg == "--high-priority") { options.high_priority = true; }
+        else if(arg == "--interleave") { options.interleave = true; }
+        else if(arg == "--flush-cache") { options.flush_cache = true; }
+        else if(arg == "--max-noise" && i + 1 < argc)
+        {
+            options.max_noise = std::strtod(argv[++i], nullptr) / 100;
+        }
+        else if(arg == "--save-baseline" && i + 1 < argc) { save_name = argv[++i]; }
+        else if(arg == "--baseline" && i + 1 < argc) { base_name = argv[++i]; }
+        else if(arg == "--baseline-dir" && i + 1 < argc) { base_dir = argv[++i]; }
+        else if(arg == "--confidence" && i + 1 < argc)
+        {
+            compare.confidence = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--threshold" && i + 1 < argc)
+        {
+            compare.threshold = std::strtod(argv[++i], nullptr) / 100;
+        }
+        else if(arg == "-h" || arg == "--help")
+        {
+            _internal0_impl0_bench::write_usage(std::cout, argv[0]);
+            return 0;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << arg << ".\n";
+            _internal0_impl0_bench::write_usage(std::cerr, argv[0]);
+            return 2;
+        }
+    }
+    if(before_run != nullptr) { before_run(); }
+    BenchRunner runner(std::move(options));
+    std::vector<BenchResult> results = runner.run(std::cerr);
+    write_bench_table(std::cout, results);
+    std::vector<ComplexityFit> fits = fit_bench_complexity(results);
+    if(!fits.empty() && base_name.empty())
+    {
+        std::cout << "\nComplexity:\n";
+        write_complexity_table(std::cout, fits);
+    }
+    if(!json.empty())
+    {
+        std::ofstream out(json, std::ios::trunc);
+        if(!out)
+        {
+            std::cerr << "Open " << json << " failed.\n";
+            return 1;
+        }
+        write_bench_json(out, results);
+    }
+    int rc = 0;
+    if(!base_name.empty())
+    {
+        auto base = load_baseline(baseline_path(base_dir, base_name));
+        if(base.is_err())
+        {
+            std::cerr << base.unwrap_err() << '\n';
+            return 1;
+        }
+        std::vector<BenchComparison> comparisons = compare_bench(base.unwrap(), results, compare);
+        std::cout << "\nCompared with baseline " << base_name << ":\n";
+        write_bench_comparison(std::cout, comparisons);
+        if(has_regression(comparisons)) { rc = 1; }
+        if(!fits.empty())
+        {
+            std::vector<ComplexityFit> base_fits = fit_bench_complexity(base.unwrap());
+            std::cout << "\nComplexity:\n";
+            write_complexity_table(std::cout, fits, &base_fits);
+            // Only a warning: a fit may flip between two classes within the noise of the timings.
+            if(has_complexity_regression(base_fits, fits))
+            {
+                std::cerr << "Warning: the complexity of a benchmark got worse.\n";
+            }
+        }
+    }
+    if(!save_name.empty())
+    {
+        auto saved = save_baseline(baseline_path(base_dir, save_name), results);
+        if(saved.is_err())
+        {
+            std::cerr << saved.unwrap_err() << '\n';
+            return 1;
+        }
+    }
+    return rc;
+}
+
+}  // namespace nstd
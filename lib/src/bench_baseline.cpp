@@ -0,0 +1,214 @@
+#include "bench_baseline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace nstd {
+
+namespace _internal0_impl0_bench_baseline {
+    constexpr const char* MAGIC = "nstd-bench-baseline";
+    constexpr int VERSION       = 1;
+}  // namespace _internal0_impl0_bench_baseline
+
+std::string baseline_path(const std::string& dir, const std::string& name)
+{
+    return (std::filesystem::path(dir) / (name + ".baseline")).string();
+}
+
+nstd::ResultOmitOk<nstd::Error> save_baseline(const std::string& path,
+                                              const std::vector<BenchResult>& results)
+{
+    using R = nstd::ResultOmitOk<nstd::Error>;
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty()) { std::filesystem::create_directories(parent, ec); }
+    // Write aside then rename, so an interrupted run doesn't leave half a baseline.
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if(!out) { return R::err(Error(Errc::IO_ERROR).with_context("Open ", tmp)); }
+        out.precision(10);
+        out << _internal0_impl0_bench_baseline::MAGIC << ' '
+            << _internal0_impl0_bench_baseline::VERSION << '\n';
+        for(const auto& r : results)
+        {
+            out << r.id << '\t' << r.iters << '\t' << r.bytes << '\t' << r.items << '\t';
+            for(std::size_t i = 0; i < r.samples.size(); ++i)
+            {
+                out << (i == 0 ? "" : " ") << r.samples[i];
+            }
+            out << '\n';
+        }
+        if(!out.flush()) { return R::err(Error(Errc::IO_ERROR).with_context("Write ", tmp)); }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if(ec) { return R::err(Error::from_errno(ec.value()).with_context("Rename ", tmp)); }
+    return R::ok();
+}
+
+nstd::Result<std::vector<BenchResult>, nstd::Error> load_baseline(const std::string& path)
+{
+    using R = nstd::Result<std::vector<BenchResult>, nstd::Error>;
+    std::ifstream in(path);
+    if(!in) { return R::err(Error(Errc::IO_ERROR).with_context("Open baseline ", path)); }
+    std::string magic;
+    int version = 0;
+    in >> magic >> version;
+    if(magic != _internal0_impl0_bench_baseline::MAGIC)
+    {
+        return R::err(Error(Errc::INVALID_FORMAT).with_context("Read baseline ", path));
+    }
+    if(version != _internal0_impl0_bench_baseline::VERSION)
+    {
+        return R::err(Error(Errc::UNSUPPORTED_VERSION).with_context("Read baseline ", path));
+    }
+    std::vector<BenchResult> results;
+    std::size_t lineno = 1;
+    for(std::string line; std::getline(in, line); ++lineno)
+    {
+        if(line.empty()) { continue; }
+        std::size_t tab = line.find('\t');
+        if(tab == std::string::npos)
+        {
+            return R::err(Error(Errc::INVALID_FORMAT).with_context(path, ":", lineno));
+        }
+        BenchResult r;
+        r.id = line.substr(0, tab);
+        std::istringstream fields(line.substr(tab + 1));
+        if(!(fields >> r.iters >> r.bytes >> r.items))
+        {
+            return R::err(Error(Errc::INVALID_FORMAT).with_context(path, ":", lineno));
+        }
+        for(double s; fields >> s;) { r.samples.push_back(s); }
+        r.stats = compute_bench_stats(r.samples);
+        results.push_back(std::move(r));
+    }
+    return R::ok(std::move(results));
+}
+
+double mann_whitney_p(const std::vector<double>& a, const std::vector<double>& b)
+{
+    const std::size_t na = a.size(), nb = b.size(), n = na + nb;
+    if(na == 0 || nb == 0) { return 1; }
+    // Rank the pooled samples, ties get their mean rank.
+    std::vector<std::pair<double, bool>> pooled;  // (value, from a)
+    pooled.reserve(n);
+    for(double v : a) { pooled.emplace_back(v, true); }
+    for(double v : b) { pooled.emplace_back(v, false); }
+    std::sort(pooled.begin(), pooled.end(),
+              [](const auto& x, const auto& y) { return x.first < y.first; });
+    double rank_sum_a = 0, tie_term = 0;
+    for(std::size_t i = 0; i < n;)
+    {
+        std::size_t j = i;
+        while(j < n && pooled[j].first == pooled[i].first) { ++j; }
+        double rank = (double(i + 1) + double(j)) / 2;
+        for(std::size_t k = i; k < j; ++k)
+        {
+            if(pooled[k].second) { rank_sum_a += rank; }
+        }
+        double t = double(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+    double u    = rank_sum_a - double(na) * double(na + 1) / 2;
+    double mean = double(na) * double(nb) / 2;
+    double var  = double(na) * double(nb) / 12 *
+                 (double(n + 1) - tie_term / (double(n) * double(n - 1)));
+    if(var <= 0) { return 1; }
+    // Continuity correction.
+    double z = (std::fabs(u - mean) - 0.5) / std::sqrt(var);
+    if(z < 0) { z = 0; }
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<BenchComparison> compare_bench(const std::vector<BenchResult>& base,
+                                           const std::vector<BenchResult>& current,
+                                           const BenchCompareOptions& options)
+{
+    std::unordered_map<std::string, const BenchResult*> by_id;
+    for(const auto& r : base) { by_id.emplace(r.id, &r); }
+    std::vector<BenchComparison> comparisons;
+    for(const auto& r : current)
+    {
+        BenchComparison c;
+        c.id         = r.id;
+        c.new_median = r.stats.median;
+        auto it      = by_id.find(r.id);
+        if(it == by_id.end())
+        {
+            c.verdict = BenchVerdict::NEW;
+            comparisons.push_back(std::move(c));
+            continue;
+        }
+        const BenchResult& b = *it->second;
+        by_id.erase(it);
+        c.base_median = b.stats.median;
+        c.ratio       = c.base_median > 0 ? c.new_median / c.base_median : 1;
+        c.p_value     = mann_whitney_p(b.samples, r.samples);
+        bool significant =
+            c.p_value < 1 - options.confidence && std::fabs(c.ratio - 1) > options.threshold;
+        if(significant) { c.verdict = c.ratio > 1 ? BenchVerdict::SLOWER : BenchVerdict::FASTER; }
+        comparisons.push_back(std::move(c));
+    }
+    for(const auto& r : base)
+    {
+        if(by_id.count(r.id) == 0) { continue; }
+        BenchComparison c;
+        c.id          = r.id;
+        c.base_median = r.stats.median;
+        c.verdict     = BenchVerdict::MISSING;
+        comparisons.push_back(std::move(c));
+    }
+    return comparisons;
+}
+
+void write_bench_comparison(std::ostream& out, const std::vector<BenchComparison>& comparisons)
+{
+    std::size_t width = 9;
+    for(const auto& c : comparisons) { width = std::max(width, c.id.size()); }
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), "%-*s %12s %12s %9s %9s  %s\n", int(width), "benchmark",
+                  "base (ns)", "new (ns)", "change", "p", "verdict");
+    out << buf;
+    for(const auto& c : comparisons)
+    {
+        const char* verdict = "";
+        switch(c.verdict)
+        {
+        case BenchVerdict::SAME: verdict = "no change"; break;
+        case BenchVerdict::FASTER: verdict = "faster"; break;
+        case BenchVerdict::SLOWER: verdict = "SLOWER"; break;
+        case BenchVerdict::NEW: verdict = "new"; break;
+        case BenchVerdict::MISSING: verdict = "missing"; break;
+        }
+        if(c.verdict == BenchVerdict::NEW || c.verdict == BenchVerdict::MISSING)
+        {
+            std::snprintf(buf, sizeof(buf), "%-*s %12.3f %12.3f %9s %9s  %s\n", int(width),
+                          c.id.c_str(), c.base_median, c.new_median, "-", "-", verdict);
+        }
+        else
+        {
+            std::snprintf(buf, sizeof(buf), "%-*s %12.3f %12.3f %+8.2f%% %9.2g  %s\n", int(width),
+                          c.id.c_str(), c.base_median, c.new_median, (c.ratio - 1) * 100,
+                          c.p_value, verdict);
+        }
+        out << buf;
+    }
+}
+
+bool has_regression(const std::vector<BenchComparison>& comparisons) noexcept
+{
+    for(const auto& c : comparisons)
+    {
+        if(c.verdict == BenchVerdict::SLOWER) { return true; }
+    }
+    return false;
+}
+
+}  // namespace nstd
@@ -0,0 +1,190 @@
+#include "bench_complexity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <unordered_map>
+
+namespace nstd {
+
+namespace _internal0_impl0_bench_complexity {
+    constexpr Complexity ALL[] = {Complexity::O_1,
+                                  Complexity::O_LOG_N,
+                                  Complexity::O_N,
+                                  Complexity::O_N_LOG_N,
+                                  Complexity::O_N_SQUARED};
+
+    inline double growth(Complexity c, double n) noexcept
+    {
+        n = std::max(n, 1.0);
+        switch(c)
+        {
+        case Complexity::O_1: return 1;
+        case Complexity::O_LOG_N: return std::max(std::log2(n), 1.0);
+        case Complexity::O_N: return n;
+        case Complexity::O_N_LOG_N: return n * std::max(std::log2(n), 1.0);
+        case Complexity::O_N_SQUARED: return n * n;
+        }
+        return 1;
+    }
+
+    // Split "group::case/8/1024" into "group::case" and {8, 1024}. False if there's no argument.
+    inline bool parse_id(const std::string& id, std::string& base, std::vector<std::int64_t>& args)
+    {
+        std::size_t slash = id.find('/');
+        if(slash == std::string::npos) { return false; }
+        base = id.substr(0, slash);
+        args.clear();
+        while(slash != std::string::npos)
+        {
+            std::size_t next  = id.find('/', slash + 1);
+            std::string token = id.substr(slash + 1, next - slash - 1);
+            char* end         = nullptr;
+            long long v       = std::strtoll(token.c_str(), &end, 10);
+            if(token.empty() || *end != '\0') { return false; }
+            args.push_back(v);
+            slash = next;
+        }
+        return true;
+    }
+}  // namespace _internal0_impl0_bench_complexity
+
+const char* complexity_name(Complexity c) noexcept
+{
+    switch(c)
+    {
+    case Complexity::O_1: return "O(1)";
+    case Complexity::O_LOG_N: return "O(log n)";
+    case Complexity::O_N: return "O(n)";
+    case Complexity::O_N_LOG_N: return "O(n log n)";
+    case Complexity::O_N_SQUARED: return "O(n^2)";
+    }
+    return "";
+}
+
+ComplexityFit fit_complexity(const std::vector<std::pair<double, double>>& points)
+{
+    using namespace _internal0_impl0_bench_complexity;
+    ComplexityFit best;
+    best.points = points.size();
+    if(points.empty()) { return best; }
+    double mean = 0;
+    for(const auto& p : points) { mean += p.second; }
+    mean /= double(points.size());
+    bool distinct = std::any_of(points.begin(), points.end(), [&points](const auto& p) {
+        return p.first != points.front().first;
+    });
+    bool first = true;
+    for(Complexity c : ALL)
+    {
+        // Least squares of t = k * f(n): k = sum(t f) / sum(f^2).
+        double tf = 0, ff = 0;
+        for(const auto& p : points)
+        {
+            double f = growth(c, p.first);
+            tf += p.second * f;
+            ff += f * f;
+        }
+        double k   = ff > 0 ? tf / ff : 0;
+        double err = 0;
+        for(const auto& p : points)
+        {
+            double d = p.second - k * growth(c, p.first);
+            err += d * d;
+        }
+        double rms = mean > 0 ? std::sqrt(err / double(points.size())) / mean : 0;
+        if(first || rms < best.rms * 0.9)
+        {
+            best.big_o       = c;
+            best.coefficient = k;
+            best.rms         = rms;
+        }
+        first = false;
+        if(!distinct) { break; }
+    }
+    return best;
+}
+
+std::vector<ComplexityFit> fit_bench_complexity(const std::vector<BenchResult>& results)
+{
+    using namespace _internal0_impl0_bench_complexity;
+    // The points of every family, in the order the families first appear.
+    std::vector<std::string> order;
+    std::unordered_map<std::string, std::vector<std::pair<double, double>>> families;
+    std::string base;
+    std::vector<std::int64_t> args;
+    for(const auto& r : results)
+    {
+        if(!parse_id(r.id, base, args)) { continue; }
+        std::string family = base + "/n";
+        for(std::size_t i = 1; i < args.size(); ++i) { family += "/" + std::to_string(args[i]); }
+        auto it = families.find(family);
+        if(it == families.end())
+        {
+            order.push_back(family);
+            it = families.emplace(family, std::vector<std::pair<double, double>>{}).first;
+        }
+        it->second.emplace_back(double(args[0]), r.stats.median);
+    }
+    std::vector<ComplexityFit> fits;
+    for(const auto& family : order)
+    {
+        const auto& points = families[family];
+        std::set<double> ns;
+        for(const auto& p : points) { ns.insert(p.first); }
+        // A curve needs a few sizes.
+        if(ns.size() < 3) { continue; }
+        ComplexityFit fit = fit_complexity(points);
+        fit.id            = family;
+        fits.push_back(std::move(fit));
+    }
+    return fits;
+}
+
+void write_complexity_table(std::ostream& out,
+                            const std::vector<ComplexityFit>& fits,
+                            const std::vector<ComplexityFit>* base)
+{
+    std::size_t width = 9;
+    for(const auto& f : fits) { width = std::max(width, f.id.size()); }
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), "%-*s %11s %14s %8s %7s%s\n", int(width), "benchmark",
+                  "complexity", "coefficient", "RMS", "points", base != nullptr ? "  was" : "");
+    out << buf;
+    for(const auto& f : fits)
+    {
+        std::string was;
+        if(base != nullptr)
+        {
+            for(const auto& b : *base)
+            {
+                if(b.id != f.id) { continue; }
+                was = b.big_o == f.big_o ? "  same" : std::string("  ") + complexity_name(b.big_o);
+                if(b.big_o < f.big_o) { was += " (WORSE)"; }
+                break;
+            }
+            if(was.empty()) { was = "  new"; }
+        }
+        std::snprintf(buf, sizeof(buf), "%-*s %11s %11.4g ns %7.1f%% %7zu%s\n", int(width),
+                      f.id.c_str(), complexity_name(f.big_o), f.coefficient, f.rms * 100,
+                      f.points, was.c_str());
+        out << buf;
+    }
+}
+
+bool has_complexity_regression(const std::vector<ComplexityFit>& base,
+                               const std::vector<ComplexityFit>& current) noexcept
+{
+    for(const auto& c : current)
+    {
+        for(const auto& b : base)
+        {
+            if(b.id == c.id && b.big_o < c.big_o) { return true; }
+        }
+    }
+    return false;
+}
+
+}  // namespace nstd
@@ -0,0 +1,115 @@
+#include "bench_env.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include "bench.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace nstd {
+
+bool pin_thread_to_cpu(int cpu) noexcept
+{
+#ifdef __linux__
+    if(cpu < 0 || cpu >= CPU_SETSIZE) { return false; }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+std::string raise_thread_priority()
+{
+#ifdef __linux__
+    sched_param param{};
+    // Half way, the kernel threads which must preempt the benchmark run higher.
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+    if(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+    {
+        return "SCHED_FIFO " + std::to_string(param.sched_priority);
+    }
+    // The nice value of a Linux thread is set by its thread id.
+    auto tid = id_t(::syscall(SYS_gettid));
+    for(int nice = -20; nice < 0; ++nice)
+    {
+        if(::setpriority(PRIO_PROCESS, tid, nice) == 0) { return "nice " + std::to_string(nice); }
+    }
+#endif
+    return std::string();
+}
+
+int current_cpu() noexcept
+{
+#ifdef __linux__
+    return ::sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+double cpu_frequency_mhz(int cpu) noexcept
+{
+#ifdef __linux__
+    if(cpu < 0) { return 0; }
+    char path[96];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq",
+                  cpu);
+    std::FILE* f = std::fopen(path, "r");
+    if(f == nullptr) { return 0; }
+    unsigned long khz = 0;
+    int n             = std::fscanf(f, "%lu", &khz);
+    std::fclose(f);
+    return n == 1 ? double(khz) / 1000 : 0;
+#else
+    (void)cpu;
+    return 0;
+#endif
+}
+
+std::uint64_t thread_context_switches() noexcept
+{
+#ifdef __linux__
+    rusage usage{};
+    if(::getrusage(RUSAGE_THREAD, &usage) != 0) { return 0; }
+    return std::uint64_t(usage.ru_nvcsw) + std::uint64_t(usage.ru_nivcsw);
+#else
+    return 0;
+#endif
+}
+
+CacheFlusher::CacheFlusher(std::size_t bytes)
+{
+    if(bytes == 0)
+    {
+        long llc = 0;
+#if defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+        llc = ::sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+        bytes = llc > 0 ? std::size_t(llc) * 2 : std::size_t(64) << 20;
+    }
+    m_buffer.assign(bytes, 0);
+}
+
+void CacheFlusher::flush() noexcept
+{
+    // One write and one read per cache line, the lines are evicted from all the levels.
+    unsigned char sum = 0;
+    for(std::size_t i = 0; i < m_buffer.size(); i += 64)
+    {
+        m_buffer[i] = static_cast<unsigned char>(m_buffer[i] + 1);
+        sum         = static_cast<unsigned char>(sum + m_buffer[i]);
+    }
+    do_not_optimize(sum);
+    clobber_memory();
+}
+
+}  // namespace nstd
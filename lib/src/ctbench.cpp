@@ -0,0 +1,240 @@
+#include "ctbench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "process.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_ctbench {
+    inline double median(std::vector<double> v)
+    {
+        if(v.empty()) { return 0; }
+        std::sort(v.begin(), v.end());
+        std::size_t m = v.size() / 2;
+        return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2;
+    }
+
+    inline std::string tu_source(const CtBenchCase& c, std::size_t n)
+    {
+        std::string src;
+        for(const auto& inc : c.includes) { src += "#include <" + inc + ">\n"; }
+        src += "\n";
+        if(n > 0) { src += c.generate(n); }
+        src += "\n";
+        return src;
+    }
+}  // namespace _internal0_impl0_ctbench
+
+CtBenchRunner::CtBenchRunner(CtBenchOptions options) : m_options(std::move(options))
+{
+    if(m_options.compiler.empty())
+    {
+        const char* cxx     = std::getenv("CXX");
+        m_options.compiler = cxx != nullptr && *cxx != '\0' ? cxx : "c++";
+    }
+    if(m_options.repeats == 0) { m_options.repeats = 1; }
+}
+
+CtBenchResult CtBenchRunner::compile(const CtBenchCase& c, std::size_t n) const
+{
+    using namespace _internal0_impl0_ctbench;
+    CtBenchResult result;
+    result.id = c.name + "/" + std::to_string(n);
+    result.n  = n;
+    std::error_code ec;
+    std::filesystem::create_directories(m_options.work_dir, ec);
+    std::string base = m_options.work_dir + "/" + c.name + "_" + std::to_string(n);
+    {
+        std::ofstream src(base + ".cpp", std::ios::binary | std::ios::trunc);
+        src << tu_source(c, n);
+        if(!src)
+        {
+            result.output = "Write " + base + ".cpp failed.";
+            return result;
+        }
+    }
+    std::vector<std::string> argv{m_options.compiler};
+    argv.insert(argv.end(), m_options.flags.begin(), m_options.flags.end());
+    argv.insert(argv.end(), c.flags.begin(), c.flags.end());
+    if(m_options.time_trace) { argv.push_back("-ftime-trace"); }
+    argv.insert(argv.end(), {"-c", base + ".cpp", "-o", base + ".o"});
+
+    std::vector<double> cpu, wall;
+    for(unsigned int i = 0; i < m_options.repeats; ++i)
+    {
+        // The usage of the driver covers the processes it waited for, the compiler proper included.
+        ProcessResult proc = run_process(argv);
+        if(proc.exit_code != 0)
+        {
+            result.output = proc.output.empty() ? "The compiler failed." : proc.output;
+            return result;
+        }
+        cpu.push_back(proc.cpu_seconds);
+        wall.push_back(proc.seconds);
+        result.max_rss_kb = std::max(result.max_rss_kb, proc.max_rss_kb);
+    }
+    result.compiled     = true;
+    result.seconds      = median(cpu);
+    result.wall_seconds = median(wall);
+    return result;
+}
+
+std::vector<CtBenchResult> CtBenchRunner::run_case(const CtBenchCase& c, std::ostream& out) const
+{
+    std::vector<CtBenchResult> results;
+    if(c.generate == nullptr) { return results; }
+    std::vector<std::size_t> sizes{0};
+    for(std::size_t n : m_options.sizes)
+    {
+        if(n > 0 && (c.max_n == 0 || n <= c.max_n)) { sizes.push_back(n); }
+    }
+    double base = 0;
+    for(std::size_t n : sizes)
+    {
+        results.push_back(compile(c, n));
+        CtBenchResult& r = results.back();
+        if(n == 0) { base = r.seconds; }
+        if(r.compiled)
+        {
+            r.over_baseline = std::max(r.seconds - base, 0.0);
+            r.over_budget   = c.budget_seconds > 0 && r.over_baseline > c.budget_seconds;
+        }
+        out << (!r.compiled ? "[ FAILED  ] " : (r.over_budget ? "[ BUDGET  ] " : "[ COMPILED] "))
+            << r.id << '\n'
+            << std::flush;
+        if(!r.compiled && n == 0) { break; }  // the includes don't compile, nothing will
+    }
+    return results;
+}
+
+std::vector<CtBenchResult> CtBenchRunner::run(const std::vector<CtBenchCase>& cases,
+                                              std::ostream& out) const
+{
+    std::vector<CtBenchResult> results;
+    for(const auto& c : cases)
+    {
+        if(!m_options.filter.empty() && c.name.find(m_options.filter) == std::string::npos)
+        {
+            continue;
+        }
+        for(auto& r : run_case(c, out)) { results.push_back(std::move(r)); }
+    }
+    return results;
+}
+
+std::vector<ComplexityFit> fit_ctbench_complexity(const std::vector<CtBenchResult>& results)
+{
+    std::vector<ComplexityFit> fits;
+    std::vector<std::pair<double, double>> points;
+    std::string family;
+    auto flush = [&]() {
+        if(points.size() >= 3)
+        {
+            fits.push_back(fit_complexity(points));
+            fits.back().id = family + "/n";
+        }
+        points.clear();
+    };
+    for(const auto& r : results)
+    {
+        std::string name = r.id.substr(0, r.id.rfind('/'));
+        if(name != family)
+        {
+            flush();
+            family = name;
+        }
+        // In nanoseconds, as the fits of the benchmarks.
+        if(r.compiled && r.n > 0) { points.emplace_back(double(r.n), r.over_baseline * 1e9); }
+    }
+    flush();
+    return fits;
+}
+
+void write_ctbench_table(std::ostream& out, const std::vector<CtBenchResult>& results)
+{
+    std::size_t width = 4;
+    for(const auto& r : results) { width = std::max(width, r.id.size()); }
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "%-*s %10s %10s %12s %10s\n", int(width), "case", "cpu-s",
+                  "wall-s", "over-base-s", "max-RSS");
+    out << buf;
+    for(const auto& r : results)
+    {
+        if(!r.compiled)
+        {
+            std::snprintf(buf, sizeof(buf), "%-*s %10s\n", int(width), r.id.c_str(), "failed");
+        }
+        else
+        {
+            std::snprintf(buf, sizeof(buf), "%-*s %10.3f %10.3f %12.3f %7ld MB%s\n", int(width),
+                          r.id.c_str(), r.seconds, r.wall_seconds, r.over_baseline,
+                          r.max_rss_kb / 1024, r.over_budget ? "  over budget" : "");
+        }
+        out << buf;
+    }
+}
+
+int ctbench_main(int argc, char** argv, const std::vector<CtBenchCase>& cases)
+{
+    CtBenchOptions options;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--cxx" && i + 1 < argc) { options.compiler = argv[++i]; }
+        else if(arg == "--flag" && i + 1 < argc) { options.flags.push_back(argv[++i]); }
+        else if(arg == "-I" && i + 1 < argc)
+        {
+            options.flags.push_back("-I" + std::string(argv[++i]));
+        }
+        else if(arg == "--sizes" && i + 1 < argc)
+        {
+            options.sizes.clear();
+            for(const char* p = argv[++i]; *p != '\0';)
+            {
+                char* end;
+                options.sizes.push_back(std::strtoull(p, &end, 10));
+                p = *end == ',' ? end + 1 : end;
+                if(end == p) { break; }
+            }
+        }
+        else if(arg == "--repeats" && i + 1 < argc)
+        {
+            options.repeats = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--work-dir" && i + 1 < argc) { options.work_dir = argv[++i]; }
+        else if(arg == "--time-trace") { options.time_trace = true; }
+        else if(arg == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+        else
+        {
+            std::cerr << "Unknown option " << arg << ".\n";
+            return 2;
+        }
+    }
+    CtBenchRunner runner(std::move(options));
+    auto results = runner.run(cases, std::cout);
+    std::cout << '\n';
+    write_ctbench_table(std::cout, results);
+    auto fits = fit_ctbench_complexity(results);
+    if(!fits.empty())
+    {
+        std::cout << "\nComplexity:\n";
+        write_complexity_table(std::cout, fits);
+    }
+    int rc = 0;
+    for(const auto& r : results)
+    {
+        if(r.over_budget) { rc = 1; }
+        if(!r.compiled)
+        {
+            std::cout << "\n" << r.id << ":\n" << r.output.substr(0, 2000) << '\n';
+        }
+    }
+    return rc;
+}
+
+}  // namespace nstd
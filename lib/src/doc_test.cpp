@@ -0,0 +1,458 @@
+#include "doc_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "process.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_doc_test {
+    inline bool is_ident(char c) noexcept
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    inline std::string ltrim(const std::string& s)
+    {
+        std::size_t i = 0;
+        while(i < s.size() && (s[i] == ' ' || s[i] == '\t')) { ++i; }
+        return s.substr(i);
+    }
+
+    inline bool read_file(const std::filesystem::path& path, std::string& content)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if(!in) { return false; }
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        content = ss.str();
+        return true;
+    }
+
+    inline std::string hex(std::uint64_t v)
+    {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+        return buf;
+    }
+
+    struct CommentLine {
+        std::size_t line;
+        std::string text;  // without the comment markers
+    };
+
+    // The comment lines inside the parentheses of the macro call which starts at `open`.
+    inline std::vector<CommentLine> macro_comments(const std::string& src,
+                                                   std::size_t open,
+                                                   std::size_t line)
+    {
+        std::vector<CommentLine> lines;
+        int depth = 0;
+        for(std::size_t i = open; i < src.size(); ++i)
+        {
+            char c = src[i];
+            if(c == '\n') { ++line; }
+            else if(c == '(') { ++depth; }
+            else if(c == ')')
+            {
+                if(--depth == 0) { break; }
+            }
+            else if(c == '"' || c == '\'')
+            {
+                for(++i; i < src.size() && src[i] != c && src[i] != '\n'; ++i)
+                {
+                    if(src[i] == '\\') { ++i; }
+                }
+            }
+            else if(c == '/' && i + 1 < src.size() && src[i + 1] == '/')
+            {
+                std::size_t end = src.find('\n', i);
+                if(end == std::string::npos) { end = src.size(); }
+                // "///" and "//!" doc comments, and plain "//".
+                std::size_t b = i + 2;
+                if(b < end && (src[b] == '/' || src[b] == '!')) { ++b; }
+                if(b < end && src[b] == ' ') { ++b; }
+                lines.push_back({line, src.substr(b, end - b)});
+                i = end - 1;
+            }
+            else if(c == '/' && i + 1 < src.size() && src[i + 1] == '*')
+            {
+                std::size_t end = src.find("*/", i + 2);
+                if(end == std::string::npos) { end = src.size(); }
+                std::istringstream block(src.substr(i + 2, end - i - 2));
+                bool first = true;
+                for(std::string l; std::getline(block, l); first = false)
+                {
+                    std::string t = ltrim(l);
+                    // " * text" and the "/**" or "/*!" opening.
+                    if(!t.empty() && (t[0] == '*' || (first && t[0] == '!'))) { t.erase(0, 1); }
+                    if(!t.empty() && t[0] == ' ') { t.erase(0, 1); }
+                    lines.push_back({line, t});
+                    ++line;
+                }
+                --line;
+                i = end + 1;
+            }
+        }
+        return lines;
+    }
+
+    // The prerequisites of the make rule written by the compiler with -MD.
+    inline std::vector<std::string> make_deps(const std::string& rule)
+    {
+        std::vector<std::string> deps;
+        std::size_t i = rule.find(": ");
+        if(i == std::string::npos) { return deps; }
+        std::string cur;
+        for(i += 2; i <= rule.size(); ++i)
+        {
+            char c = i < rule.size() ? rule[i] : ' ';
+            char n = i + 1 < rule.size() ? rule[i + 1] : '\0';
+            if(c == '\\' && (n == ' ' || n == '#'))
+            {
+                cur += n;
+                ++i;
+            }
+            else if(c == '$' && n == '$')
+            {
+                cur += '$';
+                ++i;
+            }
+            else if(c == '\\' && (n == '\n' || n == '\r')) { ++i; }
+            else if(std::isspace(static_cast<unsigned char>(c)))
+            {
+                if(!cur.empty()) { deps.push_back(std::move(cur)); }
+                cur.clear();
+            }
+            else { cur += c; }
+        }
+        return deps;
+    }
+
+}  // namespace _internal0_impl0_doc_test
+
+std::uint64_t doc_test_hash(const std::string& data, std::uint64_t seed)
+{
+    std::uint64_t h = seed;
+    for(unsigned char c : data)
+    {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+nstd::Result<std::vector<DocSnippet>, nstd::Error> extract_doc_tests(const TestTextDesc& desc)
+{
+    using namespace _internal0_impl0_doc_test;
+    using R = nstd::Result<std::vector<DocSnippet>, nstd::Error>;
+    std::ifstream in(desc.file, std::ios::binary);
+    if(!in) { return R::err(Error(Errc::IO_ERROR).with_context("Open ", desc.file)); }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    const std::string src = ss.str();
+    const std::string group(desc.group);
+
+    // Find "DOC_TEST(<group>".
+    std::size_t open = std::string::npos;
+    for(std::size_t at = src.find("DOC_TEST"); at != std::string::npos;
+        at             = src.find("DOC_TEST", at + 8))
+    {
+        if(at > 0 && is_ident(src[at - 1])) { continue; }
+        std::size_t p = at + 8;
+        while(p < src.size() && std::isspace(static_cast<unsigned char>(src[p]))) { ++p; }
+        if(p >= src.size() || src[p] != '(') { continue; }
+        std::size_t n = p + 1;
+        while(n < src.size() && std::isspace(static_cast<unsigned char>(src[n]))) { ++n; }
+        if(src.compare(n, group.size(), group) == 0 && !is_ident(src[n + group.size()]))
+        {
+            open = p;
+            break;
+        }
+    }
+    if(open == std::string::npos)
+    {
+        return R::err(
+            Error(Errc::NOT_FOUND).with_context("DOC_TEST(", group, ") in ", desc.file));
+    }
+    std::size_t line = 1;
+    for(std::size_t i = 0; i < open; ++i) { line += src[i] == '\n' ? 1 : 0; }
+
+    std::string includes;
+    std::istringstream incs(desc.incs);
+    for(std::string inc; std::getline(incs, inc, ',');)
+    {
+        inc = ltrim(inc);
+        while(!inc.empty() && std::isspace(static_cast<unsigned char>(inc.back())))
+        {
+            inc.pop_back();
+        }
+        if(inc.empty()) { continue; }
+        includes += (inc[0] == '<' || inc[0] == '"' ? "#include " : "") + inc + "\n";
+    }
+
+    std::vector<DocSnippet> snippets;
+    DocSnippet* cur = nullptr;
+    std::string body;
+    for(const CommentLine& cl : macro_comments(src, open, line))
+    {
+        bool fence = ltrim(cl.text).compare(0, 3, "```") == 0;
+        if(cur == nullptr)
+        {
+            if(!fence) { continue; }
+            snippets.push_back(DocSnippet{group, group + "_" + std::to_string(snippets.size()),
+                                          desc.file, cl.line, {}});
+            cur = &snippets.back();
+            body.clear();
+        }
+        else if(fence)
+        {
+            std::ostringstream code;
+            code << includes << "void " << cur->name << "()\n{\n"
+                 << "#line " << cur->line + 1 << " \"" << cur->file << "\"\n"
+                 << body << "}\nint main()\n{\n    " << cur->name << "();\n    return 0;\n}\n";
+            cur->code = code.str();
+            cur       = nullptr;
+        }
+        else { body += cl.text + "\n"; }
+    }
+    if(cur != nullptr)
+    {
+        return R::err(Error(Errc::INVALID_FORMAT)
+                          .with_context("Unterminated code block at ", desc.file, ":", cur->line));
+    }
+    return R::ok(std::move(snippets));
+}
+
+DocTestDriver::DocTestDriver(DocTestOptions options) : m_options(std::move(options))
+{
+    if(m_options.compiler.empty())
+    {
+        const char* cxx    = std::getenv("CXX");
+        m_options.compiler = cxx != nullptr && *cxx != '\0' ? cxx : "c++";
+    }
+    if(m_options.jobs == 0) { m_options.jobs = std::thread::hardware_concurrency(); }
+    if(m_options.jobs == 0) { m_options.jobs = 1; }
+}
+
+std::uint64_t DocTestDriver::deps_hash(const std::filesystem::path& deps) const
+{
+    using namespace _internal0_impl0_doc_test;
+    std::string rule;
+    if(!read_file(deps, rule)) { return 0; }
+    std::string files;
+    for(const auto& dep : make_deps(rule))
+    {
+        std::uint64_t fh = 0;
+        {
+            std::lock_guard<std::mutex> guard(m_files_mutex);
+            auto it = m_files.find(dep);
+            if(it != m_files.end()) { fh = it->second; }
+        }
+        if(fh == 0)
+        {
+            std::string content;
+            if(!read_file(dep, content)) { return 0; }
+            fh = doc_test_hash(content) | 1;
+            std::lock_guard<std::mutex> guard(m_files_mutex);
+            m_files.emplace(dep, fh);
+        }
+        files += dep + '\0' + hex(fh) + '\n';
+    }
+    std::uint64_t h = doc_test_hash(files);
+    return h == 0 ? 1 : h;
+}
+
+DocTestResult DocTestDriver::build_and_run(const DocSnippet& snippet) const
+{
+    using namespace _internal0_impl0_doc_test;
+    namespace fs = std::filesystem;
+    DocTestResult result;
+    result.id = snippet.group + "::" + snippet.name;
+
+    std::string key = snippet.code + '\0' + m_options.compiler;
+    for(const auto& f : m_options.flags) { key += '\0' + f; }
+    const std::string src_hash = hex(doc_test_hash(key));
+    const fs::path dir         = m_options.cache_dir;
+    const fs::path src         = dir / (src_hash + ".cpp");
+    const fs::path deps        = dir / (src_hash + ".d");
+    // Unique per thread, the same snippet may be built by two jobs at once.
+    std::ostringstream tid;
+    tid << std::this_thread::get_id();
+    const std::string tmp = ".tmp" + tid.str();
+
+    // The object is named after the files it was built from as well, as listed by the last build.
+    // A change to the list itself takes a change to one of the files.
+    std::error_code ec;
+    std::uint64_t dep_hash = deps_hash(deps);
+    fs::path obj           = dir / (src_hash + "." + hex(dep_hash) + ".o");
+    result.cached          = dep_hash != 0 && fs::exists(obj, ec);
+    if(!result.cached)
+    {
+        fs::create_directories(dir, ec);
+        {
+            std::ofstream out(src.string() + tmp, std::ios::trunc);
+            out << snippet.code;
+        }
+        fs::rename(src.string() + tmp, src, ec);
+        std::vector<std::string> cmd{m_options.compiler};
+        cmd.insert(cmd.end(), m_options.flags.begin(), m_options.flags.end());
+        cmd.insert(cmd.end(), {"-MD", "-MF", deps.string() + tmp});
+        cmd.insert(cmd.end(), {"-c", src.string(), "-o", obj.string() + tmp});
+        ProcessResult proc = run_process(cmd);
+        result.output      = std::move(proc.output);
+        if(proc.exit_code != 0)
+        {
+            result.outcome = DocTestOutcome::COMPILE_FAILED;
+            fs::remove(deps.string() + tmp, ec);
+            fs::remove(obj.string() + tmp, ec);
+            return result;
+        }
+        fs::rename(deps.string() + tmp, deps, ec);
+        fs::path built = obj.string() + tmp;
+        dep_hash       = deps_hash(deps);
+        obj            = dir / (src_hash + "." + hex(dep_hash) + ".o");
+        fs::rename(built, obj, ec);
+    }
+    std::string link_key = obj.filename().string();
+    for(const auto& f : m_options.link_flags) { link_key += '\0' + f; }
+    const fs::path exe = dir / (hex(doc_test_hash(link_key)) + ".bin");
+    if(!fs::exists(exe, ec))
+    {
+        result.cached = false;
+        std::vector<std::string> cmd{m_options.compiler, obj.string(), "-o", exe.string() + tmp};
+        cmd.insert(cmd.end(), m_options.link_flags.begin(), m_options.link_flags.end());
+        ProcessResult proc = run_process(cmd);
+        result.output += proc.output;
+        if(proc.exit_code != 0)
+        {
+            result.outcome = DocTestOutcome::COMPILE_FAILED;
+            fs::remove(exe.string() + tmp, ec);
+            return result;
+        }
+        fs::rename(exe.string() + tmp, exe, ec);
+    }
+    if(!m_options.run)
+    {
+        result.outcome = DocTestOutcome::COMPILED;
+        return result;
+    }
+    std::string exe_path = exe.is_absolute() ? exe.string() : (fs::path(".") / exe).string();
+    ProcessResult proc   = run_process({exe_path});
+    result.output        = std::move(proc.output);
+    if(proc.exit_code != 0) { result.outcome = DocTestOutcome::RUN_FAILED; }
+    return result;
+}
+
+std::vector<DocTestResult> DocTestDriver::run(const std::vector<DocSnippet>& snippets,
+                                              std::ostream& out) const
+{
+    {
+        std::lock_guard<std::mutex> guard(m_files_mutex);
+        m_files.clear();
+    }
+    std::vector<DocTestResult> results(snippets.size());
+    std::atomic<std::size_t> next{0};
+    std::mutex out_mutex;
+    auto worker = [&]() {
+        for(std::size_t i; (i = next.fetch_add(1)) < snippets.size();)
+        {
+            DocTestResult r = build_and_run(snippets[i]);
+            const char* tag = "[ PASSED  ]";
+            switch(r.outcome)
+            {
+            case DocTestOutcome::PASSED: break;
+            case DocTestOutcome::COMPILE_FAILED: tag = "[ NO BUILD]"; break;
+            case DocTestOutcome::RUN_FAILED: tag = "[ FAILED  ]"; break;
+            case DocTestOutcome::COMPILED: tag = "[ BUILT   ]"; break;
+            }
+            std::ostringstream line;
+            line << tag << ' ' << r.id << (r.cached ? " (cached)" : "") << '\n';
+            bool failed = r.outcome == DocTestOutcome::COMPILE_FAILED ||
+                          r.outcome == DocTestOutcome::RUN_FAILED;
+            if(failed && !r.output.empty()) { line << r.output; }
+            {
+                std::lock_guard<std::mutex> guard(out_mutex);
+                out << line.str() << std::flush;
+            }
+            results[i] = std::move(r);
+        }
+    };
+    std::size_t nworkers = std::min<std::size_t>(m_options.jobs, snippets.size());
+    std::vector<std::thread> workers;
+    for(std::size_t i = 1; i < nworkers; ++i) { workers.emplace_back(worker); }
+    worker();
+    for(auto& w : workers) { w.join(); }
+    return results;
+}
+
+int doc_test_main(int argc, char** argv)
+{
+    DocTestOptions options;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "-j" && i + 1 < argc)
+        {
+            options.jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--cxx" && i + 1 < argc) { options.compiler = argv[++i]; }
+        else if(arg == "--flag" && i + 1 < argc) { options.flags.push_back(argv[++i]); }
+        else if(arg == "-I" && i + 1 < argc)
+        {
+            options.flags.push_back("-I" + std::string(argv[++i]));
+        }
+        else if(arg == "--link-flag" && i + 1 < argc) { options.link_flags.push_back(argv[++i]); }
+        else if(arg == "--cache-dir" && i + 1 < argc) { options.cache_dir = argv[++i]; }
+        else if(arg == "--no-run") { options.run = false; }
+        else if(arg == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+        else
+        {
+            std::cerr << "Unknown option " << arg << ".\n";
+            return 2;
+        }
+    }
+    std::vector<DocSnippet> snippets;
+    int rc = 0;
+    for(const TestTextDesc* desc : test_text_descs())
+    {
+        if(!desc->doc) { continue; }
+        auto extracted = extract_doc_tests(*desc);
+        if(extracted.is_err())
+        {
+            std::cerr << extracted.unwrap_err() << '\n';
+            rc = 1;
+            continue;
+        }
+        for(auto& s : extracted.unwrap())
+        {
+            std::string id = s.group + "::" + s.name;
+            if(options.filter.empty() || id.find(options.filter) != std::string::npos)
+            {
+                snippets.push_back(std::move(s));
+            }
+        }
+    }
+    DocTestDriver driver(std::move(options));
+    std::size_t passed = 0, failed = 0, cached = 0;
+    for(const auto& r : driver.run(snippets, std::cout))
+    {
+        bool ok = r.outcome == DocTestOutcome::PASSED || r.outcome == DocTestOutcome::COMPILED;
+        (ok ? passed : failed) += 1;
+        cached += r.cached ? 1 : 0;
+    }
+    std::cout << passed << " passed, " << failed << " failed, " << cached << " of "
+              << snippets.size() << " from cache\n";
+    return failed == 0 ? rc : 1;
+}
+
+}  // namespace nstd
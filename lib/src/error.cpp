@@ -0,0 +1,164 @@
+#include "error.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <system_error>
+#include "format.hpp"
+
+namespace nstd {
+
+namespace _internal0_impl0_error {
+    constexpr std::size_t MAX_CATEGORIES = 64;
+
+    std::atomic<const ErrorCategory*> categories[MAX_CATEGORIES];
+    std::atomic<std::uint16_t> next_category_id{SYSTEM_ID + 1};
+
+    // 128 bytes. The code and the category tell a slot reused after the ids wrapped.
+    struct ContextSlot {
+        std::uint16_t id;
+        std::uint16_t category;
+        std::int32_t code;
+        unsigned char size;
+        char text[__NSTD_ERROR_CTX_SIZE];
+    };
+    static_assert(sizeof(ContextSlot) == 128);
+    // constexpr constructed and trivially destructible, so there is no lazy init guard on access.
+    thread_local ContextSlot context_slots[__NSTD_ERROR_CTX_SLOTS];
+    // The slots are taken in turn by the thread, not by id: the ids of a thread aren't consecutive
+    // when other threads attach contexts too, so an id would reuse a slot still holding a recent
+    // context.
+    thread_local unsigned int next_context_slot = 0;
+    // The ids are shared by the threads, so until the counter wraps an id names a single context
+    // in the process. After a wrap, it can name a newer one too (see Error).
+    std::atomic<std::uint16_t> next_context_id{1};
+
+    class GenericCategory final : public ErrorCategory {
+    public:
+        constexpr GenericCategory() noexcept : ErrorCategory(GENERIC_ID) {}
+        const char* name() const noexcept override { return "nstd"; }
+        std::string message(int code) const override
+        {
+            switch(Errc(code))
+            {
+            case Errc::OK: return "Success";
+            case Errc::IO_ERROR: return "I/O error";
+            case Errc::TIMED_OUT: return "Timed out";
+            case Errc::ALREADY_EXISTS: return "Already exists";
+            case Errc::NOT_FOUND: return "Not found";
+            case Errc::INVALID_FORMAT: return "Invalid format";
+            case Errc::UNSUPPORTED_VERSION: return "Unsupported version";
+            case Errc::INVALID_ARGUMENT: return "Invalid argument";
+            case Errc::LIMIT_EXCEEDED: return "Limit exceeded";
+            case Errc::EXCEPTION: return "Exception";
+            }
+            return "Unknown error " + std::to_string(code);
+        }
+    };
+
+    class SystemCategory final : public ErrorCategory {
+    public:
+        constexpr SystemCategory() noexcept : ErrorCategory(SYSTEM_ID) {}
+        const char* name() const noexcept override { return "system"; }
+        // std::strerror isn't thread safe.
+        std::string message(int code) const override
+        {
+            return std::generic_category().message(code);
+        }
+    };
+
+    const GenericCategory generic;
+    const SystemCategory system;
+}  // namespace _internal0_impl0_error
+
+ErrorCategory::ErrorCategory() noexcept
+{
+    using namespace _internal0_impl0_error;
+    m_id = next_category_id.fetch_add(1, std::memory_order_relaxed);
+    if(m_id >= MAX_CATEGORIES)
+    {
+        std::cerr << "Too many error categories, at most " << MAX_CATEGORIES << ".\n";
+        std::abort();
+    }
+    categories[m_id].store(this, std::memory_order_release);
+}
+
+const ErrorCategory& generic_category() noexcept { return _internal0_impl0_error::generic; }
+
+const ErrorCategory& system_category() noexcept { return _internal0_impl0_error::system; }
+
+void _internal0_impl0_error::ContextText::append(std::string_view part) noexcept
+{
+    std::size_t n = part.size() < sizeof(text) - size ? part.size() : sizeof(text) - size;
+    std::memcpy(text + size, part.data(), n);
+    size += n;
+}
+
+void _internal0_impl0_error::ContextText::append(const char* part) noexcept
+{
+    append(part == nullptr ? std::string_view() : std::string_view(part));
+}
+
+void _internal0_impl0_error::ContextText::append(long long part) noexcept
+{
+    char buf[DEC_BUF_SIZE + 1];
+    append(std::string_view(buf, std::size_t(i64_to_dec(buf, part) - buf)));
+}
+
+void _internal0_impl0_error::ContextText::append(unsigned long long part) noexcept
+{
+    char buf[DEC_BUF_SIZE];
+    append(std::string_view(buf, std::size_t(u64_to_dec(buf, part) - buf)));
+}
+
+Error Error::attach_context(const _internal0_impl0_error::ContextText& text) const noexcept
+{
+    using namespace _internal0_impl0_error;
+    std::uint16_t id = next_context_id.fetch_add(1, std::memory_order_relaxed);
+    if(id == 0) { id = next_context_id.fetch_add(1, std::memory_order_relaxed); }
+    ContextSlot& slot = context_slots[next_context_slot++ % __NSTD_ERROR_CTX_SLOTS];
+    slot.id           = id;
+    slot.category     = m_category;
+    slot.code         = m_code;
+    slot.size         = static_cast<unsigned char>(text.size);
+    std::memcpy(slot.text, text.text, text.size);
+    Error e     = *this;
+    e.m_context = id;
+    return e;
+}
+
+const ErrorCategory& Error::category() const noexcept
+{
+    using namespace _internal0_impl0_error;
+    if(m_category == GENERIC_ID) { return generic; }
+    if(m_category == SYSTEM_ID) { return system; }
+    return *categories[m_category].load(std::memory_order_acquire);
+}
+
+std::string_view Error::context() const noexcept
+{
+    using namespace _internal0_impl0_error;
+    if(m_context == 0) { return std::string_view(); }
+    for(const ContextSlot& slot : context_slots)
+    {
+        if(slot.id == m_context && slot.code == m_code && slot.category == m_category)
+        {
+            return std::string_view(slot.text, slot.size);
+        }
+    }
+    return std::string_view();
+}
+
+std::string Error::message() const
+{
+    std::string_view ctx = context();
+    std::string msg      = category().message(m_code);
+    if(!ctx.empty()) { msg.insert(0, std::string(ctx) + ": "); }
+    msg += '.';
+    return msg;
+}
+
+std::ostream& operator<<(std::ostream& os, const Error& error) { return os << error.message(); }
+
+}  // namespace nstd
@@ -2,52 +2,78 @@
 #include "log.hpp"
 
 namespace nstd {
-const std::chrono::steady_clock ProcStart::proc_start = std::chrono::steady_clock::now();
+const std::chrono::steady_clock::time_point ProcStart::proc_start =
+    std::chrono::steady_clock::now();
 thread_local std::stringstream Logger::buf;
-std::mutex GlobalLogger::mtx;
-std::shared_ptr<Logger> GlobalLogger::glogger;
+std::timed_mutex GlobalLogger::mtx;
+std::map<std::size_t, std::shared_ptr<Logger>> GlobalLogger::glogger;
+
+namespace _internal0_impl0_log {
+    LogResult add_logger(std::shared_ptr<Logger>&& plogger)
+    {
+        if(!plogger.get()) { return LogResult::ok(); }
+        std::unique_lock<std::timed_mutex> lock{GlobalLogger::global_logger_mutex(),
+                                                std::defer_lock};
+        if(!lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))
+        {
+            return LogResult::err(Error(Errc::TIMED_OUT).with_context("Lock global logger"));
+        }
+        auto& glogger = GlobalLogger::global_logger();
+        if(glogger.try_emplace(std::size_t(plogger.get()), std::move(plogger)).second)
+        {
+            return LogResult::ok();
+        }
+        return LogResult::err(
+            Error(Errc::ALREADY_EXISTS).with_context("Add a logger to global logger"));
+    }
+
+    LogResult remove_logger(const std::shared_ptr<Logger>& plogger)
+    {
+        std::unique_lock<std::timed_mutex> lock{GlobalLogger::global_logger_mutex(),
+                                                std::defer_lock};
+        if(!lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))
+        {
+            return LogResult::err(Error(Errc::TIMED_OUT).with_context("Lock global logger"));
+        }
+        GlobalLogger::global_logger().erase(std::size_t(plogger.get()));
+        return LogResult::ok();
+    }
+}  // namespace _internal0_impl0_log
+
+// Without exceptions, a failed allocation terminates and the other failures are already returned.
 LogResult GlobalLogger::add_logger(std::shared_ptr<Logger> plogger) noexcept
 {
+#ifdef NSTD_NO_EXCEPTIONS
+    return _internal0_impl0_log::add_logger(std::move(plogger));
+#else
     try
     {
-        if(plogger.get())
-        {
-            std::unique_lock<std::mutex> lock{mtx, std::defer_lock};
-            if(lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))
-            {
-                if(glogger.try_emplace(std::size_t(plogger.get()), plogger).second) { return; }
-                else { return LogResult::err("Add the same address of logger to global logger."); }
-            }
-            else { return LogResult::err("Lock global logger failed."); }
-        }
-        else { return LogResult::ok(); }
+        return _internal0_impl0_log::add_logger(std::move(plogger));
     }
     catch(const std::exception& e)
     {
-        return LogResult::err(e.what());
+        return LogResult::err(Error(Errc::EXCEPTION).with_context(e.what()));
     }
+#endif
 }
 
 LogResult GlobalLogger::remove_logger(std::shared_ptr<Logger> plogger) noexcept
 {
+#ifdef NSTD_NO_EXCEPTIONS
+    return _internal0_impl0_log::remove_logger(plogger);
+#else
     try
     {
-        std::unique_lock<std::mutex> lock{mtx, std::defer_lock};
-        if(lock.try_lock_for(std::chrono::seconds{__NSTD_LOG_TIMEOUT}))
-        {
-            auto iter = std::find(std::size_t(plogger.get()));
-            if(iter != glogger.end()) { glogger.erase(iter); }
-            else { return LogResult::ok(); }
-        }
-        else { return LogResult::err("Lock global logger failed."); }
+        return _internal0_impl0_log::remove_logger(plogger);
     }
     catch(const std::exception& e)
     {
-        return LogResult::err(e.what());
+        return LogResult::err(Error(Errc::EXCEPTION).with_context(e.what()));
     }
+#endif
 }
 
-std::mutex& GlobalLogger::global_logger_mutex() noexcept { return mtx; }
+std::timed_mutex& GlobalLogger::global_logger_mutex() noexcept { return mtx; }
 
 std::map<std::size_t, std::shared_ptr<Logger>>& GlobalLogger::global_logger() noexcept
 {
@@ -0,0 +1,97 @@
+#include "log_context.hpp"
+
+#include <cstring>
+#include "format.hpp"
+
+namespace nstd {
+
+namespace {
+    // constexpr constructed and trivially destructible, so there is no lazy init guard on access.
+    thread_local LogContext tls_log_context;
+}  // namespace
+
+LogContext& LogContext::current() noexcept { return tls_log_context; }
+
+void LogContext::push(const char* key, std::string_view value) noexcept
+{
+    if(depth == __NSTD_LOG_CTX_CAPACITY)
+    {
+        ++dropped;
+        return;
+    }
+    LogContextEntry& e = entries[depth++];
+    std::size_t n      = value.size() < sizeof(e.value) ? value.size() : sizeof(e.value);
+    e.key              = key;
+    e.size             = static_cast<unsigned char>(n);
+    std::memcpy(e.value, value.data(), n);
+}
+
+void LogContext::push(const char* key, const char* value) noexcept
+{
+    push(key, value == nullptr ? std::string_view() : std::string_view(value));
+}
+
+void LogContext::push(const char* key, long long value) noexcept
+{
+    char buf[DEC_BUF_SIZE + 1];
+    push(key, std::string_view(buf, std::size_t(i64_to_dec(buf, value) - buf)));
+}
+
+void LogContext::push(const char* key, unsigned long long value) noexcept
+{
+    char buf[DEC_BUF_SIZE];
+    push(key, std::string_view(buf, std::size_t(u64_to_dec(buf, value) - buf)));
+}
+
+void LogContext::pop() noexcept
+{
+    if(dropped != 0) { --dropped; }
+    else if(depth != 0) { --depth; }
+}
+
+std::size_t log_context_size(LogContextView view) noexcept
+{
+    if(view.empty()) { return 0; }
+    std::size_t n = 2;  // "[" and "] ", less the space after the last entry
+    for(const auto& e : view) { n += std::strlen(e.key) + 1 + e.size + 1; }
+    return n;
+}
+
+char* render_log_context(char* out, LogContextView view) noexcept
+{
+    if(view.empty()) { return out; }
+    *out++ = '[';
+    for(const auto& e : view)
+    {
+        if(&e != view.begin()) { *out++ = ' '; }
+        std::size_t n = std::strlen(e.key);
+        std::memcpy(out, e.key, n);
+        out += n;
+        *out++ = '=';
+        std::memcpy(out, e.value, e.size);
+        out += e.size;
+    }
+    *out++ = ']';
+    *out++ = ' ';
+    return out;
+}
+
+LogContextSnapshot LogContextSnapshot::capture() noexcept
+{
+    const LogContext& ctx = LogContext::current();
+    LogContextSnapshot snapshot;
+    std::memcpy(snapshot.entries, ctx.entries, ctx.depth * sizeof(LogContextEntry));
+    snapshot.depth   = ctx.depth;
+    snapshot.dropped = ctx.dropped;
+    return snapshot;
+}
+
+void LogContextSnapshot::install() const noexcept
+{
+    LogContext& ctx = LogContext::current();
+    std::memcpy(ctx.entries, entries, depth * sizeof(LogContextEntry));
+    ctx.depth   = depth;
+    ctx.dropped = dropped;
+}
+
+}  // namespace nstd
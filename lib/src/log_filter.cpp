@@ -0,0 +1,358 @@
+#include "log_filter.hpp"
+
+#include <atomic>
+#include <cctype>
+
+namespace nstd {
+
+namespace _internal0_impl0_log_filter {
+
+    constexpr unsigned int SEVERITY[] = {LogType::LOG_TRACE,
+                                         LogType::LOG_DEBUG,
+                                         LogType::LOG_INFO,
+                                         LogType::LOG_WARN,
+                                         LogType::LOG_ERROR,
+                                         LogType::LOG_FATAL};
+
+    inline bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+        if(a.size() != b.size()) { return false; }
+        for(std::size_t i = 0; i < a.size(); ++i)
+        {
+            if(std::toupper(static_cast<unsigned char>(a[i])) !=
+               std::toupper(static_cast<unsigned char>(b[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    class Parser {
+        std::string_view src;
+        std::size_t pos = 0;
+        std::vector<LogFilter::Instr>& code;
+        std::vector<LogFilter::StrPred>& preds;
+        std::string error;
+
+        void skip_space()
+        {
+            while(pos < src.size() && std::isspace(static_cast<unsigned char>(src[pos]))) { ++pos; }
+        }
+        bool eat(std::string_view tok)
+        {
+            skip_space();
+            if(src.compare(pos, tok.size(), tok) == 0)
+            {
+                pos += tok.size();
+                return true;
+            }
+            return false;
+        }
+        bool fail(const std::string& msg)
+        {
+            if(error.empty()) { error = msg + " at column " + std::to_string(pos + 1); }
+            return false;
+        }
+        std::string_view ident()
+        {
+            skip_space();
+            std::size_t b = pos;
+            while(pos < src.size() &&
+                  (std::isalnum(static_cast<unsigned char>(src[pos])) || src[pos] == '_'))
+            {
+                ++pos;
+            }
+            return src.substr(b, pos - b);
+        }
+        bool pattern(std::string& out)
+        {
+            skip_space();
+            if(pos < src.size() && src[pos] == '"')
+            {
+                for(++pos; pos < src.size() && src[pos] != '"'; ++pos)
+                {
+                    if(src[pos] == '\\' && pos + 1 < src.size()) { ++pos; }
+                    out.push_back(src[pos]);
+                }
+                if(pos == src.size()) { return fail("Unterminated string"); }
+                ++pos;
+                return true;
+            }
+            std::size_t b = pos;
+            while(pos < src.size() && !std::isspace(static_cast<unsigned char>(src[pos])) &&
+                  src[pos] != '(' && src[pos] != ')' && src[pos] != '&' && src[pos] != '|')
+            {
+                ++pos;
+            }
+            if(b == pos) { return fail("Expect a pattern"); }
+            out.assign(src.substr(b, pos - b));
+            return true;
+        }
+        void emit(LogFilter::Op op, unsigned int arg = 0) { code.push_back({op, arg}); }
+
+        bool level_pred()
+        {
+            enum
+            {
+                GE,
+                GT,
+                LE,
+                LT,
+                EQ,
+                NE
+            } cmp;
+            if(eat(">=")) { cmp = GE; }
+            else if(eat("<=")) { cmp = LE; }
+            else if(eat("!=")) { cmp = NE; }
+            else if(eat("==") || eat("=")) { cmp = EQ; }
+            else if(eat(">")) { cmp = GT; }
+            else if(eat("<")) { cmp = LT; }
+            else { return fail("Expect a comparison after 'level'"); }
+            std::string_view name = ident();
+            unsigned int level    = LogType::LOG_NON;
+            const char* names[]   = {
+                "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "PERF", "FUNC"};
+            for(unsigned int i = 0; i < 8; ++i)
+            {
+                if(iequals(name, names[i])) { level = 1u << i; }
+            }
+            if(level == LogType::LOG_NON) { return fail("Unknown level"); }
+            unsigned int mask = 0;
+            if(cmp == EQ || cmp == NE) { mask = level; }
+            else
+            {
+                int at = -1;
+                for(int i = 0; i < 6; ++i)
+                {
+                    if(SEVERITY[i] == level) { at = i; }
+                }
+                if(at < 0) { return fail("PERF and FUNC can only be compared with '=' or '!='"); }
+                for(int i = 0; i < 6; ++i)
+                {
+                    bool in = (cmp == GE && i >= at) || (cmp == GT && i > at) ||
+                              (cmp == LE && i <= at) || (cmp == LT && i < at);
+                    if(in) { mask |= SEVERITY[i]; }
+                }
+            }
+            emit(LogFilter::Op::LEVEL, mask);
+            if(cmp == NE) { emit(LogFilter::Op::NOT); }
+            return true;
+        }
+
+        bool str_pred(LogFilter::Field field)
+        {
+            LogFilter::StrPred pred{field, LogFilter::Match::GLOB, {}};
+            bool negate = false;
+            if(eat("~")) { pred.match = LogFilter::Match::CONTAINS; }
+            else if(eat("!=")) { negate = true; }
+            else if(!(eat("==") || eat("="))) { return fail("Expect '=', '!=' or '~'"); }
+            if(!pattern(pred.pattern)) { return false; }
+            std::size_t idx = 0;
+            while(idx < preds.size() && !(preds[idx].field == pred.field &&
+                                          preds[idx].match == pred.match &&
+                                          preds[idx].pattern == pred.pattern))
+            {
+                ++idx;
+            }
+            if(idx == preds.size())
+            {
+                if(preds.size() == LogFilter::MAX_PREDS) { return fail("Too many predicates"); }
+                preds.push_back(std::move(pred));
+            }
+            emit(LogFilter::Op::PRED, unsigned(idx));
+            if(negate) { emit(LogFilter::Op::NOT); }
+            return true;
+        }
+
+        bool unary()
+        {
+            if(eat("!"))
+            {
+                if(!unary()) { return false; }
+                emit(LogFilter::Op::NOT);
+                return true;
+            }
+            if(eat("("))
+            {
+                if(!expr()) { return false; }
+                return eat(")") ? true : fail("Expect ')'");
+            }
+            std::size_t b         = pos;
+            std::string_view name = ident();
+            if(name == "level") { return level_pred(); }
+            if(name == "module") { return str_pred(LogFilter::Field::MODULE); }
+            if(name == "file") { return str_pred(LogFilter::Field::FILE); }
+            if(name == "func") { return str_pred(LogFilter::Field::FUNC); }
+            if(name == "true" || name == "false")
+            {
+                emit(LogFilter::Op::CONST, name == "true" ? 1 : 0);
+                return true;
+            }
+            pos = b;
+            return fail("Expect a predicate");
+        }
+
+        bool conj()
+        {
+            if(!unary()) { return false; }
+            while(eat("&&"))
+            {
+                if(!unary()) { return false; }
+                emit(LogFilter::Op::AND);
+            }
+            return true;
+        }
+
+    public:
+        Parser(std::string_view s,
+               std::vector<LogFilter::Instr>& c,
+               std::vector<LogFilter::StrPred>& p)
+            : src(s), code(c), preds(p)
+        {
+        }
+        bool expr()
+        {
+            if(!conj()) { return false; }
+            while(eat("||"))
+            {
+                if(!conj()) { return false; }
+                emit(LogFilter::Op::OR);
+            }
+            return true;
+        }
+        bool parse()
+        {
+            if(!expr()) { return false; }
+            skip_space();
+            return pos == src.size() ? true : fail("Unexpected token");
+        }
+        inline const std::string& get_error() const noexcept { return error; }
+    };
+
+    std::atomic<std::uint32_t> next_filter_id{1};
+}  // namespace _internal0_impl0_log_filter
+
+bool glob_match(std::string_view pattern, std::string_view text) noexcept
+{
+    std::size_t p = 0, t = 0;
+    std::size_t star = std::string_view::npos, mark = 0;
+    while(t < text.size())
+    {
+        if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]))
+        {
+            ++p;
+            ++t;
+        }
+        else if(p < pattern.size() && pattern[p] == '*')
+        {
+            star = p++;
+            mark = t;
+        }
+        else if(star != std::string_view::npos)
+        {
+            p = star + 1;
+            t = ++mark;
+        }
+        else { return false; }
+    }
+    while(p < pattern.size() && pattern[p] == '*') { ++p; }
+    return p == pattern.size();
+}
+
+nstd::Result<LogFilter, nstd::Error> LogFilter::compile(std::string_view expr)
+{
+    using R = nstd::Result<LogFilter, nstd::Error>;
+    LogFilter filter;
+    _internal0_impl0_log_filter::Parser parser(expr, filter.m_code, filter.m_preds);
+    if(!parser.parse())
+    {
+        return R::err(Error(Errc::INVALID_ARGUMENT).with_context(parser.get_error()));
+    }
+    // run() keeps the evaluation stack in 64 bits.
+    int depth = 0, max_depth = 0;
+    for(const Instr& ins : filter.m_code)
+    {
+        depth += (ins.op == Op::AND || ins.op == Op::OR) ? -1 : (ins.op == Op::NOT ? 0 : 1);
+        max_depth = depth > max_depth ? depth : max_depth;
+    }
+    if(max_depth > 64)
+    {
+        return R::err(Error(Errc::LIMIT_EXCEEDED).with_context("Nest the filter expression"));
+    }
+    using _internal0_impl0_log_filter::next_filter_id;
+    do {
+        filter.m_id = next_filter_id.fetch_add(1, std::memory_order_relaxed);
+    } while(filter.m_id == 0);
+    const std::size_t npreds = filter.m_preds.size();
+    if(npreds <= MAX_TABLE_PREDS)
+    {
+        std::size_t bits = std::size_t(256) << npreds;
+        filter.m_table.assign((bits + 63) / 64, 0);
+        for(std::size_t idx = 0; idx < bits; ++idx)
+        {
+            unsigned int level = unsigned(idx >> npreds);
+            auto pred_bits     = std::uint32_t(idx & ((std::size_t(1) << npreds) - 1));
+            if(filter.run(level, pred_bits))
+            {
+                filter.m_table[idx >> 6] |= std::uint64_t(1) << (idx & 63);
+            }
+        }
+    }
+    return R::ok(std::move(filter));
+}
+
+bool LogFilter::run(unsigned int level, std::uint32_t pred_bits) const noexcept
+{
+    // The stack of booleans as bits, the top is bit 0.
+    std::uint64_t stack = 0;
+    for(const Instr& ins : m_code)
+    {
+        switch(ins.op)
+        {
+        case Op::LEVEL: stack = (stack << 1) | ((level & ins.arg) != 0 ? 1 : 0); break;
+        case Op::PRED: stack = (stack << 1) | ((pred_bits >> ins.arg) & 1); break;
+        case Op::CONST: stack = (stack << 1) | (ins.arg != 0 ? 1 : 0); break;
+        case Op::NOT: stack ^= 1; break;
+        case Op::AND: stack = (stack >> 1) & (stack | ~std::uint64_t(1)); break;
+        case Op::OR: stack = (stack >> 1) | (stack & 1); break;
+        }
+    }
+    return (stack & 1) != 0;
+}
+
+std::uint32_t LogFilter::resolve(std::string_view module,
+                                 std::string_view file,
+                                 std::string_view func) const noexcept
+{
+    std::uint32_t bits = 0;
+    for(std::size_t i = 0; i < m_preds.size(); ++i)
+    {
+        const StrPred& p = m_preds[i];
+        std::string_view text =
+            p.field == Field::MODULE ? module : (p.field == Field::FILE ? file : func);
+        bool hit = p.match == Match::GLOB ? glob_match(p.pattern, text)
+                                          : text.find(p.pattern) != std::string_view::npos;
+        if(hit) { bits |= std::uint32_t(1) << i; }
+    }
+    return bits;
+}
+
+bool LogFilter::enabled(const LogMetaData& md) const noexcept
+{
+    unsigned int level = md.log_type->mask();
+    if(m_preds.empty()) { return evaluate(level, 0); }
+    if(md.site == nullptr) { return evaluate(level, md.log_mod, md.file, md.func); }
+    std::atomic<std::uint64_t>& slot = md.site->cache[m_id % LogSite::CACHE_SLOTS];
+    std::uint64_t entry              = slot.load(std::memory_order_relaxed);
+    std::uint32_t pred_bits;
+    if(std::uint32_t(entry >> 32) == m_id) { pred_bits = std::uint32_t(entry); }
+    else
+    {
+        pred_bits = resolve(md.log_mod, md.file, md.func);
+        slot.store((std::uint64_t(m_id) << 32) | pred_bits, std::memory_order_relaxed);
+    }
+    return evaluate(level, pred_bits);
+}
+
+}  // namespace nstd
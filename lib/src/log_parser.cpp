@@ -0,0 +1,286 @@
+#include "log_parser.hpp"
+
+#include <cstring>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__NSTD_LOG_PARSER_HAS_AVX2)
+#include <immintrin.h>
+#elif defined(__NSTD_LOG_PARSER_HAS_SSE2)
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace nstd {
+
+nstd::Result<MappedFile, nstd::Error> MappedFile::map(const std::string& path) noexcept
+{
+    using R = nstd::Result<MappedFile, nstd::Error>;
+    MappedFile mf;
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) { return R::err(Error::from_errno(errno).with_context("Open ", path)); }
+    struct stat st;
+    if(::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return R::err(Error::from_errno(errno).with_context("Stat ", path));
+    }
+    if(st.st_size > 0)
+    {
+        void* p = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED)
+        {
+            ::close(fd);
+            return R::err(Error::from_errno(errno).with_context("Map ", path));
+        }
+        ::madvise(p, std::size_t(st.st_size), MADV_SEQUENTIAL);
+        mf.m_data = static_cast<const char*>(p);
+        mf.m_size = std::size_t(st.st_size);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if(!in) { return R::err(Error(Errc::IO_ERROR).with_context("Open ", path)); }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    mf.m_buf  = ss.str();
+    mf.m_data = mf.m_buf.data();
+    mf.m_size = mf.m_buf.size();
+#endif
+    return R::ok(std::move(mf));
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size)
+#if !(defined(__unix__) || defined(__APPLE__))
+      ,
+      m_buf(std::move(other.m_buf))
+#endif
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this != &other)
+    {
+        this->~MappedFile();
+        new(this) MappedFile(std::move(other));
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if(m_data != nullptr) { ::munmap(const_cast<char*>(m_data), m_size); }
+#endif
+}
+
+namespace _internal0_impl0_log_parser {
+    // The index of the lowest set bit of a compare mask, mask isn't 0.
+    inline unsigned int lowest_bit(unsigned int mask) noexcept
+    {
+#ifdef _MSC_VER
+        unsigned long idx;
+        _BitScanForward(&idx, mask);
+        return static_cast<unsigned int>(idx);
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+}  // namespace _internal0_impl0_log_parser
+
+const char* find_byte(const char* first, const char* last, char c) noexcept
+{
+    using _internal0_impl0_log_parser::lowest_bit;
+#if defined(__NSTD_LOG_PARSER_HAS_AVX2)
+    const __m256i pattern = _mm256_set1_epi8(c);
+    for(; last - first >= 32; first += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        unsigned int mask =
+            static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)));
+        if(mask != 0) { return first + lowest_bit(mask); }
+    }
+#elif defined(__NSTD_LOG_PARSER_HAS_SSE2)
+    const __m128i pattern = _mm_set1_epi8(c);
+    for(; last - first >= 16; first += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        unsigned int mask =
+            static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)));
+        if(mask != 0) { return first + lowest_bit(mask); }
+    }
+#endif
+    if(first == last) { return last; }
+    const void* p = std::memchr(first, c, std::size_t(last - first));
+    return p == nullptr ? last : static_cast<const char*>(p);
+}
+
+std::vector<std::string_view> split_lines_chunks(std::string_view text, std::size_t count)
+{
+    std::vector<std::string_view> chunks;
+    if(text.empty()) { return chunks; }
+    if(count == 0) { count = 1; }
+    const char* const end = text.data() + text.size();
+    const std::size_t step = (text.size() + count - 1) / count;
+    const char* first = text.data();
+    while(first < end)
+    {
+        const char* last = std::size_t(end - first) > step ? first + step : end;
+        if(last < end)
+        {
+            last = find_byte(last, end, '\n');
+            if(last < end) { ++last; }
+        }
+        chunks.emplace_back(first, std::size_t(last - first));
+        first = last;
+    }
+    return chunks;
+}
+
+namespace _internal0_impl0_log_parser {
+    inline unsigned int level_of(std::string_view name) noexcept
+    {
+        switch(name.size())
+        {
+        case 4:
+            if(name == "Warn") { return LogType::LOG_WARN; }
+            if(name == "Info") { return LogType::LOG_INFO; }
+            if(name == "Perf") { return LogType::LOG_PERF; }
+            if(name == "Func") { return LogType::LOG_FUNC; }
+            break;
+        case 5:
+            if(name == "Error") { return LogType::LOG_ERROR; }
+            if(name == "Trace") { return LogType::LOG_TRACE; }
+            if(name == "Debug") { return LogType::LOG_DEBUG; }
+            if(name == "Fatal") { return LogType::LOG_FATAL; }
+            break;
+        default: break;
+        }
+        return LogType::LOG_NON;
+    }
+
+    // The decimal number at p, p moves past it. False if there is no digit at p.
+    inline bool parse_uint(const char*& p, const char* end, unsigned int& n) noexcept
+    {
+        const char* first = p;
+        n                 = 0;
+        while(p < end && *p >= '0' && *p <= '9') { n = n * 10 + unsigned(*p++ - '0'); }
+        return p != first;
+    }
+}  // namespace _internal0_impl0_log_parser
+
+LogRecord parse_log_line(std::string_view line) noexcept
+{
+    LogRecord rec;
+    rec.message = line;
+    constexpr std::string_view prefix = "[nstd(";
+    if(line.size() <= prefix.size() || line.compare(0, prefix.size(), prefix) != 0) { return rec; }
+    const char* const end = line.data() + line.size();
+    const char* name      = line.data() + prefix.size();
+    const char* close     = find_byte(name, end, ')');
+    if(close + 1 >= end || close[1] != ']') { return rec; }
+    unsigned int level =
+        _internal0_impl0_log_parser::level_of(std::string_view(name, std::size_t(close - name)));
+    if(level == LogType::LOG_NON) { return rec; }
+    const char* file = close + 2;
+    while(file < end && *file == ' ') { ++file; }
+    // The file name may contain ':' itself, so look for the first ":<digits>. " or
+    // ":<digits>:<digits>. ".
+    using _internal0_impl0_log_parser::parse_uint;
+    for(const char* colon = find_byte(file, end, ':'); colon < end;
+        colon             = find_byte(colon + 1, end, ':'))
+    {
+        const char* p    = colon + 1;
+        unsigned int n   = 0;
+        unsigned int col = 0;
+        if(!parse_uint(p, end, n)) { continue; }
+        if(p < end && *p == ':')
+        {
+            ++p;
+            if(!parse_uint(p, end, col)) { continue; }
+        }
+        if(p >= end || *p != '.') { continue; }
+        ++p;
+        if(p < end && *p == ' ') { ++p; }
+        rec.level   = level;
+        rec.file    = std::string_view(file, std::size_t(colon - file));
+        rec.line    = n;
+        rec.column  = col;
+        rec.message = std::string_view(p, std::size_t(end - p));
+        break;
+    }
+    return rec;
+}
+
+LogParser::LogParser(unsigned int jobs) noexcept : m_jobs(jobs)
+{
+    if(m_jobs == 0) { m_jobs = std::thread::hardware_concurrency(); }
+    if(m_jobs == 0) { m_jobs = 1; }
+}
+
+void LogParser::parse_chunk(std::string_view chunk, std::vector<LogRecord>& records)
+{
+    const char* first     = chunk.data();
+    const char* const end = chunk.data() + chunk.size();
+    while(first < end)
+    {
+        const char* nl   = find_byte(first, end, '\n');
+        const char* last = nl;
+        if(last > first && last[-1] == '\r') { --last; }
+        records.push_back(parse_log_line(std::string_view(first, std::size_t(last - first))));
+        first = nl < end ? nl + 1 : end;
+    }
+}
+
+void LogParser::run_parallel(std::size_t count, void (*job)(std::size_t, void*), void* ctx) const
+{
+    if(count <= 1)
+    {
+        if(count == 1) { job(0, ctx); }
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(count - 1);
+    for(std::size_t i = 1; i < count; ++i) { workers.emplace_back(job, i, ctx); }
+    job(0, ctx);
+    for(auto& w : workers) { w.join(); }
+}
+
+std::vector<LogRecord> LogParser::parse(std::string_view text) const
+{
+    struct Ctx {
+        std::vector<std::string_view> chunks;
+        std::vector<std::vector<LogRecord>> parts;
+    } ctx{split_lines_chunks(text, m_jobs), {}};
+    ctx.parts.resize(ctx.chunks.size());
+    run_parallel(
+        ctx.chunks.size(),
+        [](std::size_t i, void* p) {
+            Ctx& c = *static_cast<Ctx*>(p);
+            // A log line is rarely shorter than 32 bytes.
+            c.parts[i].reserve(c.chunks[i].size() / 32 + 1);
+            parse_chunk(c.chunks[i], c.parts[i]);
+        },
+        &ctx);
+    std::size_t total = 0;
+    for(const auto& part : ctx.parts) { total += part.size(); }
+    std::vector<LogRecord> records;
+    records.reserve(total);
+    for(auto& part : ctx.parts) { records.insert(records.end(), part.begin(), part.end()); }
+    return records;
+}
+
+}  // namespace nstd
@@ -0,0 +1,314 @@
+#include "log_shard.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include "format.hpp"
+#ifdef _WIN32
+#include <process.h>
+#define __NSTD_GETPID _getpid
+#else
+#include <unistd.h>
+#define __NSTD_GETPID getpid
+#endif
+
+namespace nstd {
+
+namespace _internal0_impl0_log_shard {
+
+    std::atomic<std::uint64_t> next_logger_id{1};
+    // The shard ids are unique in the process, not per logger, so the merge and the stamps of
+    // nstd_log_merge tell apart the shards of loggers sharing a dir and a prefix.
+    std::atomic<std::uint32_t> next_shard_id{0};
+
+    struct Shard {
+        std::uint64_t logger_id;
+        std::string path;
+        std::FILE* file;
+        std::vector<char> buf;
+        std::size_t used  = 0;
+        std::uint64_t seq = 0;
+
+        Shard(std::uint64_t id, std::string p, std::FILE* f, std::size_t size)
+            : logger_id(id), path(std::move(p)), file(f), buf(size)
+        {
+        }
+        ~Shard()
+        {
+            flush();
+            std::fclose(file);
+        }
+        // False if the bytes weren't all written, e.g. the disk is full.
+        bool write(const char* data, std::size_t n) noexcept
+        {
+            return n == 0 || std::fwrite(data, 1, n, file) == n;
+        }
+        // The buffered records are dropped if they can't be written.
+        bool flush() noexcept
+        {
+            bool ok = write(buf.data(), used);
+            used    = 0;
+            std::fflush(file);
+            return ok;
+        }
+        // Make room for n bytes, p is nullptr if n doesn't fit into the buffer at all. False if the
+        // buffer was written short.
+        bool reserve(std::size_t n, char*& p) noexcept
+        {
+            bool ok = used + n > buf.size() ? flush() : true;
+            p       = n <= buf.size() ? buf.data() + used : nullptr;
+            return ok;
+        }
+    };
+
+    // The shards of current thread, one per ShardedFileLogger used by the thread. They are flushed
+    // and closed when the thread exits.
+    thread_local std::vector<std::unique_ptr<Shard>> tls_shards;
+
+    inline void put_u32(char* p, std::uint32_t v) noexcept { std::memcpy(p, &v, 4); }
+    inline void put_u64(char* p, std::uint64_t v) noexcept { std::memcpy(p, &v, 8); }
+    inline std::uint32_t get_u32(const char* p) noexcept
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    inline std::uint64_t get_u64(const char* p) noexcept
+    {
+        std::uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+}  // namespace _internal0_impl0_log_shard
+
+ShardedFileLogger::ShardedFileLogger(std::string dir,
+                                     std::string prefix,
+                                     unsigned int levels,
+                                     std::size_t buf_size)
+    : m_id(_internal0_impl0_log_shard::next_logger_id.fetch_add(1)), m_dir(std::move(dir)),
+      m_prefix(std::move(prefix)), m_levels(levels), m_buf_size(buf_size)
+{
+}
+
+bool ShardedFileLogger::enabled(const LogMetaData& md)
+{
+    return (md.log_type->mask() & m_levels) != 0;
+}
+
+LogResult ShardedFileLogger::log(LogMetaData&& md)
+{
+    using namespace _internal0_impl0_log_shard;
+    Shard* shard = nullptr;
+    for(auto& s : tls_shards)
+    {
+        if(s->logger_id == m_id) { shard = s.get(); }
+    }
+    if(shard == nullptr)
+    {
+        std::uint32_t id = next_shard_id.fetch_add(1, std::memory_order_relaxed);
+        std::string path = m_dir + "/" + m_prefix + "." + std::to_string(__NSTD_GETPID()) + "." +
+                           std::to_string(m_id) + "." + std::to_string(id) + ".nlog";
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if(f == nullptr)
+        {
+            return LogResult::err(Error::from_errno(errno).with_context("Open log shard ", path));
+        }
+        std::setvbuf(f, nullptr, _IONBF, 0);
+        char header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, 8);
+        put_u32(header + 8, VERSION);
+        put_u32(header + 12, id);
+        if(std::fwrite(header, 1, HEADER_SIZE, f) != HEADER_SIZE)
+        {
+            std::fclose(f);
+            return LogResult::err(Error(Errc::IO_ERROR).with_context("Write log shard ", path));
+        }
+        tls_shards.emplace_back(new Shard(m_id, std::move(path), f, m_buf_size));
+        shard = tls_shards.back().get();
+    }
+
+    // "[nstd(Level)]  file:line. " as written by __NSTD_WARNING, then the context and the message.
+    char prefix[32];
+    const char* name = md.log_type->c_str();
+    int n            = std::snprintf(prefix, sizeof(prefix), "[nstd(%s)] ", name);
+    if(n < 0) { n = 0; }
+    while(n < 15) { prefix[n++] = ' '; }
+    char line[DEC_BUF_SIZE + 2];
+    char* line_end = u64_to_dec(line + 1, md.line);
+    line[0]        = ':';
+    *line_end++    = '.';
+    *line_end++    = ' ';
+    std::stringstream& msg = get_buf();
+    auto msg_size          = msg.tellp();
+    std::size_t msg_len    = msg_size > 0 ? std::size_t(msg_size) : 0;
+    std::size_t ctx_size = log_context_size(md.context);
+    std::size_t size     = std::size_t(n) + md.file.size() + std::size_t(line_end - line) +
+                           ctx_size + msg_len;
+
+    char head[RECORD_HEADER_SIZE];
+    auto ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    put_u64(head, std::uint64_t(ts.count()));
+    put_u64(head + 8, shard->seq++);
+    put_u32(head + 16, md.log_type->mask());
+    put_u32(head + 20, std::uint32_t(size));
+    auto write_failed = [shard] {
+        return LogResult::err(Error(Errc::IO_ERROR).with_context("Write log shard ", shard->path));
+    };
+    char* p = nullptr;
+    if(!shard->reserve(RECORD_HEADER_SIZE + size, p)) { return write_failed(); }
+    if(p == nullptr)
+    {
+        // Larger than the whole buffer, write it through.
+        std::string ctx(ctx_size, '\0');
+        render_log_context(&ctx[0], md.context);
+        std::string payload = std::string(prefix, std::size_t(n)) + md.file +
+                              std::string(line, std::size_t(line_end - line)) + ctx + msg.str();
+        if(!shard->write(head, RECORD_HEADER_SIZE) || !shard->write(payload.data(), payload.size()))
+        {
+            return write_failed();
+        }
+        return LogResult::ok();
+    }
+    std::memcpy(p, head, RECORD_HEADER_SIZE);
+    p += RECORD_HEADER_SIZE;
+    std::memcpy(p, prefix, std::size_t(n));
+    p += n;
+    std::memcpy(p, md.file.data(), md.file.size());
+    p += md.file.size();
+    std::memcpy(p, line, std::size_t(line_end - line));
+    p += line_end - line;
+    p = render_log_context(p, md.context);
+    msg.rdbuf()->sgetn(p, std::streamsize(msg_len));
+    shard->used += RECORD_HEADER_SIZE + size;
+    return LogResult::ok();
+}
+
+void ShardedFileLogger::flush() noexcept
+{
+    for(auto& s : _internal0_impl0_log_shard::tls_shards)
+    {
+        if(s->logger_id == m_id) { s->flush(); }
+    }
+}
+
+ShardReader::ShardReader(MappedFile&& file, std::uint32_t shard) noexcept
+    : m_file(std::move(file)), m_shard(shard), m_pos(ShardedFileLogger::HEADER_SIZE)
+{
+}
+
+nstd::Result<ShardReader, nstd::Error> ShardReader::open(const std::string& path) noexcept
+{
+    using R = nstd::Result<ShardReader, nstd::Error>;
+    NSTD_TRY(mapped, MappedFile::map(path));
+    MappedFile file = std::move(mapped);
+    if(file.size() < ShardedFileLogger::HEADER_SIZE ||
+       std::memcmp(file.data(), ShardedFileLogger::MAGIC, 8) != 0)
+    {
+        return R::err(Error(Errc::INVALID_FORMAT).with_context("Read log shard ", path));
+    }
+    if(_internal0_impl0_log_shard::get_u32(file.data() + 8) != ShardedFileLogger::VERSION)
+    {
+        return R::err(Error(Errc::UNSUPPORTED_VERSION).with_context("Read log shard ", path));
+    }
+    std::uint32_t shard = _internal0_impl0_log_shard::get_u32(file.data() + 12);
+    return R::ok(ShardReader(std::move(file), shard));
+}
+
+bool ShardReader::next(ShardRecord& rec) noexcept
+{
+    using namespace _internal0_impl0_log_shard;
+    const std::size_t total = m_file.size();
+    if(total - m_pos < ShardedFileLogger::RECORD_HEADER_SIZE) { return false; }
+    const char* p      = m_file.data() + m_pos;
+    std::uint32_t size = get_u32(p + 20);
+    if(total - m_pos - ShardedFileLogger::RECORD_HEADER_SIZE < size) { return false; }
+    rec.timestamp = get_u64(p);
+    rec.seq       = get_u64(p + 8);
+    rec.level     = get_u32(p + 16);
+    rec.shard     = m_shard;
+    rec.payload   = std::string_view(p + ShardedFileLogger::RECORD_HEADER_SIZE, size);
+    m_pos += ShardedFileLogger::RECORD_HEADER_SIZE + size;
+    return true;
+}
+
+nstd::Result<ShardMerger, nstd::Error> ShardMerger::open(const std::vector<std::string>& paths)
+{
+    using R = nstd::Result<ShardMerger, nstd::Error>;
+    ShardMerger merger;
+    merger.m_readers.reserve(paths.size());
+    for(const auto& path : paths)
+    {
+        NSTD_TRY(reader, ShardReader::open(path));
+        merger.m_readers.push_back(std::move(reader));
+    }
+    merger.m_heads.resize(merger.m_readers.size());
+    for(std::size_t i = 0; i < merger.m_readers.size(); ++i)
+    {
+        if(merger.m_readers[i].next(merger.m_heads[i])) { merger.m_heap.push_back(i); }
+    }
+    for(std::size_t i = merger.m_heap.size() / 2; i-- > 0;) { merger.sift_down(i); }
+    return R::ok(std::move(merger));
+}
+
+bool ShardMerger::less(std::size_t a, std::size_t b) const noexcept
+{
+    const ShardRecord& x = m_heads[a];
+    const ShardRecord& y = m_heads[b];
+    if(x.timestamp != y.timestamp) { return x.timestamp < y.timestamp; }
+    if(x.shard != y.shard) { return x.shard < y.shard; }
+    return x.seq < y.seq;
+}
+
+void ShardMerger::sift_down(std::size_t i) noexcept
+{
+    const std::size_t n = m_heap.size();
+    for(;;)
+    {
+        std::size_t l = 2 * i + 1, r = l + 1, m = i;
+        if(l < n && less(m_heap[l], m_heap[m])) { m = l; }
+        if(r < n && less(m_heap[r], m_heap[m])) { m = r; }
+        if(m == i) { return; }
+        std::swap(m_heap[i], m_heap[m]);
+        i = m;
+    }
+}
+
+bool ShardMerger::next(ShardRecord& rec) noexcept
+{
+    if(m_heap.empty()) { return false; }
+    std::size_t top = m_heap.front();
+    rec             = m_heads[top];
+    if(!m_readers[top].next(m_heads[top]))
+    {
+        m_heap.front() = m_heap.back();
+        m_heap.pop_back();
+    }
+    if(!m_heap.empty()) { sift_down(0); }
+    return true;
+}
+
+std::vector<std::string> list_shards(const std::string& dir, const std::string& prefix)
+{
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for(const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        std::string name = entry.path().filename().string();
+        if(name.size() > prefix.size() + 6 &&
+           name.compare(0, prefix.size() + 1, prefix + ".") == 0 &&
+           name.compare(name.size() - 5, 5, ".nlog") == 0)
+        {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+}  // namespace nstd
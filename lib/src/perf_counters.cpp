@@ -0,0 +1,190 @@
+#include "perf_counters.hpp"
+
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace nstd {
+
+namespace _internal0_impl0_perf_counters {
+#ifdef __linux__
+    struct EventConfig {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    constexpr std::uint64_t cache_miss(std::uint64_t cache) noexcept
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    constexpr EventConfig EVENTS[PERF_EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+
+    inline int open_event(const EventConfig& ev, int group_fd, bool exclude_kernel) noexcept
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = ev.type;
+        attr.config         = ev.config;
+        attr.disabled       = group_fd < 0 ? 1 : 0;
+        attr.exclude_kernel = exclude_kernel ? 1 : 0;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+#endif
+}  // namespace _internal0_impl0_perf_counters
+
+const char* perf_event_name(PerfEvent e) noexcept
+{
+    switch(e)
+    {
+    case PerfEvent::CYCLES: return "cycles";
+    case PerfEvent::INSTRUCTIONS: return "instructions";
+    case PerfEvent::BRANCH_MISSES: return "branch_misses";
+    case PerfEvent::L1D_MISSES: return "l1d_misses";
+    case PerfEvent::LLC_MISSES: return "llc_misses";
+    case PerfEvent::CONTEXT_SWITCHES: return "context_switches";
+    case PerfEvent::COUNT: break;
+    }
+    return "";
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) noexcept
+{
+    for(std::size_t i = 0; i < PERF_EVENT_COUNT; ++i) { value[i] += other.value[i]; }
+    valid &= other.valid;
+    return *this;
+}
+
+PerfCounters::PerfCounters() noexcept
+{
+    for(int& fd : m_fds) { fd = -1; }
+}
+
+PerfCounters::PerfCounters(PerfCounters&& other) noexcept : m_leader(other.m_leader)
+{
+    for(std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+    {
+        m_fds[i]       = other.m_fds[i];
+        m_ids[i]       = other.m_ids[i];
+        other.m_fds[i] = -1;
+    }
+    other.m_leader = -1;
+}
+
+PerfCounters& PerfCounters::operator=(PerfCounters&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        for(std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            m_fds[i]       = other.m_fds[i];
+            m_ids[i]       = other.m_ids[i];
+            other.m_fds[i] = -1;
+        }
+        m_leader       = other.m_leader;
+        other.m_leader = -1;
+    }
+    return *this;
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+void PerfCounters::close() noexcept
+{
+#ifdef __linux__
+    for(int& fd : m_fds)
+    {
+        if(fd >= 0) { ::close(fd); }
+        fd = -1;
+    }
+#endif
+    m_leader = -1;
+}
+
+bool PerfCounters::open() noexcept
+{
+    close();
+#ifdef __linux__
+    using namespace _internal0_impl0_perf_counters;
+    for(std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+    {
+        // Context switches happen in the kernel, count them there if it's allowed.
+        bool sw = EVENTS[i].type == PERF_TYPE_SOFTWARE;
+        int fd  = open_event(EVENTS[i], m_leader, !sw);
+        if(fd < 0 && sw) { fd = open_event(EVENTS[i], m_leader, true); }
+        if(fd < 0) { continue; }
+        if(::ioctl(fd, PERF_EVENT_IOC_ID, &m_ids[i]) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        m_fds[i] = fd;
+        if(m_leader < 0) { m_leader = fd; }
+    }
+#endif
+    return is_open();
+}
+
+void PerfCounters::start() noexcept
+{
+#ifdef __linux__
+    if(m_leader < 0) { return; }
+    ::ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void PerfCounters::stop() noexcept
+{
+#ifdef __linux__
+    if(m_leader < 0) { return; }
+    ::ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfCounts PerfCounters::read() const noexcept
+{
+    PerfCounts counts;
+#ifdef __linux__
+    if(m_leader < 0) { return counts; }
+    // nr, time_enabled, time_running, then a {value, id} pair per event.
+    std::uint64_t buf[3 + 2 * PERF_EVENT_COUNT];
+    ssize_t n = ::read(m_leader, buf, sizeof(buf));
+    if(n < ssize_t(3 * sizeof(std::uint64_t))) { return counts; }
+    std::uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+    // Never scheduled on the PMU, e.g. the group doesn't fit or the PMU is virtualized away.
+    if(running == 0) { return counts; }
+    double scale = enabled > running ? double(enabled) / double(running) : 1.0;
+    for(std::uint64_t k = 0; k < nr && k < PERF_EVENT_COUNT; ++k)
+    {
+        std::uint64_t value = buf[3 + 2 * k], id = buf[4 + 2 * k];
+        for(std::size_t i = 0; i < PERF_EVENT_COUNT; ++i)
+        {
+            if(m_fds[i] >= 0 && m_ids[i] == id)
+            {
+                counts.value[i] = std::uint64_t(double(value) * scale);
+                counts.valid |= 1u << i;
+            }
+        }
+    }
+#endif
+    return counts;
+}
+
+}  // namespace nstd
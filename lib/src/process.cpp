@@ -0,0 +1,142 @@
+#include "process.hpp"
+
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#define __NSTD_PROCESS_HAS_SPAWN
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+namespace nstd {
+
+namespace _internal0_impl0_process {
+    using clock = std::chrono::steady_clock;
+
+    // How long the output of a killed process is still read, its children may hold the pipe.
+    constexpr std::chrono::seconds KILL_GRACE{1};
+
+#ifdef __NSTD_PROCESS_HAS_SPAWN
+    inline int cloexec_pipe(int fds[2]) noexcept
+    {
+#ifdef __APPLE__
+        // No pipe2. Another thread may spawn between the two calls, the window is small.
+        if(::pipe(fds) != 0) { return -1; }
+        ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return 0;
+#else
+        return ::pipe2(fds, O_CLOEXEC);
+#endif
+    }
+
+    // Milliseconds until deadline for poll(), at least 0.
+    inline int poll_ms(clock::time_point deadline) noexcept
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now());
+        if(ms.count() <= 0) { return 0; }
+        return ms.count() > INT_MAX ? INT_MAX : int(ms.count()) + 1;
+    }
+#endif
+}  // namespace _internal0_impl0_process
+
+ProcessResult run_process(const std::vector<std::string>& argv, double timeout_seconds)
+{
+    using namespace _internal0_impl0_process;
+    ProcessResult result;
+    if(argv.empty())
+    {
+        result.output = "No command to run.";
+        return result;
+    }
+#ifdef __NSTD_PROCESS_HAS_SPAWN
+    int fds[2];
+    if(cloexec_pipe(fds) != 0)
+    {
+        result.output = std::string("Create pipe failed: ") + std::strerror(errno);
+        return result;
+    }
+    // dup2 clears close-on-exec on the copies, the originals are closed by the exec.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], 2);
+    std::vector<std::string> args(argv);
+    std::vector<char*> cargs;
+    for(auto& a : args) { cargs.push_back(&a[0]); }
+    cargs.push_back(nullptr);
+    auto start = clock::now();
+    pid_t pid;
+    // posix_spawn rather than fork: forking a process with running threads isn't safe.
+    int err = posix_spawnp(&pid, cargs[0], &actions, nullptr, cargs.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+    if(err != 0)
+    {
+        ::close(fds[0]);
+        result.output = "Start " + argv[0] + " failed: " + std::strerror(err);
+        return result;
+    }
+    result.started = true;
+
+    bool has_deadline = timeout_seconds > 0;
+    clock::time_point deadline =
+        has_deadline ? start + std::chrono::duration_cast<clock::duration>(
+                                   std::chrono::duration<double>(timeout_seconds))
+                     : start;
+    char buf[4096];
+    pollfd pfd{fds[0], POLLIN, 0};
+    for(;;)
+    {
+        int ready = ::poll(&pfd, 1, has_deadline ? poll_ms(deadline) : -1);
+        if(ready < 0 && errno != EINTR) { break; }
+        if(ready == 0)
+        {
+            if(result.timed_out) { break; }  // killed, but the pipe is still held
+            ::kill(pid, SIGKILL);
+            result.timed_out = true;
+            deadline         = clock::now() + KILL_GRACE;
+            continue;
+        }
+        if(ready < 0) { continue; }
+        ssize_t n = ::read(fds[0], buf, sizeof(buf));
+        if(n > 0) { result.output.append(buf, std::size_t(n)); }
+        else if(n == 0 || errno != EINTR) { break; }
+    }
+    ::close(fds[0]);
+    int status = 0;
+    rusage ru{};
+    while(::wait4(pid, &status, 0, &ru) < 0 && errno == EINTR) {}
+    result.seconds     = std::chrono::duration<double>(clock::now() - start).count();
+    result.exit_code   = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result.signal      = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    result.cpu_seconds = double(ru.ru_utime.tv_sec) + double(ru.ru_utime.tv_usec) / 1e6 +
+                         double(ru.ru_stime.tv_sec) + double(ru.ru_stime.tv_usec) / 1e6;
+#ifdef __APPLE__
+    result.max_rss_kb = long(ru.ru_maxrss / 1024);  // bytes on macOS
+#else
+    result.max_rss_kb = long(ru.ru_maxrss);
+#endif
+#else
+    (void)timeout_seconds;
+    std::string cmd;
+    for(const auto& a : argv) { cmd += "\"" + a + "\" "; }
+    auto start         = clock::now();
+    result.exit_code   = std::system(cmd.c_str());
+    result.started     = result.exit_code != -1;
+    result.seconds     = std::chrono::duration<double>(clock::now() - start).count();
+    result.cpu_seconds = result.seconds;  // the wall time stands for it
+#endif
+    return result;
+}
+
+}  // namespace nstd
@@ -0,0 +1,298 @@
+#include "stress.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "bench.hpp"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nstd {
+
+namespace _internal0_impl0_stress {
+    // One cache line per thread, so the counters don't add contention of their own.
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> ops{0};
+    };
+
+    // The CPUs this process may run on.
+    inline std::vector<int> allowed_cpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for(int i = 0; i < CPU_SETSIZE; ++i)
+            {
+                if(CPU_ISSET(i, &set)) { cpus.push_back(i); }
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    inline void pin(std::thread& t, int cpu) noexcept
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        (void)t;
+        (void)cpu;
+#endif
+    }
+}  // namespace _internal0_impl0_stress
+
+double jain_fairness(const std::vector<std::uint64_t>& values) noexcept
+{
+    double sum = 0, sum_sq = 0;
+    for(std::uint64_t v : values)
+    {
+        sum += double(v);
+        sum_sq += double(v) * double(v);
+    }
+    if(sum_sq == 0) { return 1; }
+    return sum * sum / (double(values.size()) * sum_sq);
+}
+
+StressRunner::StressRunner(StressOptions options) : m_options(std::move(options))
+{
+    if(m_options.max_threads == 0) { m_options.max_threads = std::thread::hardware_concurrency(); }
+    if(m_options.max_threads == 0) { m_options.max_threads = 1; }
+    if(m_options.interval_seconds <= 0) { m_options.interval_seconds = m_options.seconds; }
+}
+
+StressStep StressRunner::run_step(const StressFunc& func, unsigned int threads) const
+{
+    using namespace _internal0_impl0_stress;
+    using clock = std::chrono::steady_clock;
+    std::unique_ptr<Slot[]> slots(new Slot[threads]);
+    std::atomic<unsigned int> ready{0};
+    std::atomic<bool> go{false}, stop{false};
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    std::vector<int> cpus = m_options.pin ? allowed_cpus() : std::vector<int>();
+    for(unsigned int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&, i]() {
+            ready.fetch_add(1);
+            while(!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            std::uint64_t n = 0;
+            while(!stop.load(std::memory_order_relaxed))
+            {
+                func();
+                slots[i].ops.store(++n, std::memory_order_relaxed);
+            }
+        });
+        if(!cpus.empty()) { pin(workers.back(), cpus[i % cpus.size()]); }
+    }
+    while(ready.load() != threads) { std::this_thread::yield(); }
+
+    StressStep step;
+    step.threads = threads;
+    auto total   = [&]() {
+        std::uint64_t sum = 0;
+        for(unsigned int i = 0; i < threads; ++i)
+        {
+            sum += slots[i].ops.load(std::memory_order_relaxed);
+        }
+        return sum;
+    };
+    auto interval = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(m_options.interval_seconds));
+    auto start = clock::now();
+    auto end   = start + std::chrono::duration_cast<clock::duration>(
+                               std::chrono::duration<double>(m_options.seconds));
+    go.store(true, std::memory_order_release);
+    std::uint64_t prev_ops = 0;
+    auto prev              = start;
+    while(prev < end)
+    {
+        auto next = prev + interval < end ? prev + interval : end;
+        std::this_thread::sleep_until(next);
+        auto now          = clock::now();
+        std::uint64_t ops = total();
+        double dt         = std::chrono::duration<double>(now - prev).count();
+        step.timeline.push_back(dt > 0 ? double(ops - prev_ops) / dt : 0);
+        prev_ops = ops;
+        prev     = now;
+    }
+    stop.store(true, std::memory_order_relaxed);
+    for(auto& w : workers) { w.join(); }
+
+    // The counters are read after the join, so are the ops done since the last sample: the time
+    // runs up to the join too.
+    step.seconds = std::chrono::duration<double>(clock::now() - start).count();
+    for(unsigned int i = 0; i < threads; ++i) { step.thread_ops.push_back(slots[i].ops.load()); }
+    for(std::uint64_t ops : step.thread_ops) { step.ops += ops; }
+    step.ops_per_sec = step.seconds > 0 ? double(step.ops) / step.seconds : 0;
+    step.fairness    = jain_fairness(step.thread_ops);
+    return step;
+}
+
+StressResult StressRunner::run_case(const StressFunc& func, std::string id) const
+{
+    StressResult result{std::move(id), {}};
+    std::vector<unsigned int> counts;
+    for(unsigned int n = 1; n < m_options.max_threads; n *= 2) { counts.push_back(n); }
+    counts.push_back(m_options.max_threads);
+    for(unsigned int n : counts)
+    {
+        result.steps.push_back(run_step(func, n));
+        StressStep& step = result.steps.back();
+        double base      = result.steps.front().ops_per_sec;
+        step.efficiency  = base > 0 ? step.ops_per_sec / (base * double(n)) : 0;
+    }
+    return result;
+}
+
+std::vector<StressResult> StressRunner::run(std::ostream& out) const
+{
+    std::vector<StressResult> results;
+    for(const auto& group : TestGroupManager::get_obj().get_groups())
+    {
+        for(const auto& info : group.get_cases())
+        {
+            if(info.kind != TestKind::STRESS_TEST) { continue; }
+            std::string id = group.get_group_name() + "::" + info.name;
+            if(!m_options.filter.empty() && id.find(m_options.filter) == std::string::npos)
+            {
+                continue;
+            }
+            StressFunc func = nullptr;
+            if(info.stress != nullptr) { info.stress(func); }
+            if(func == nullptr)
+            {
+                out << "[ SKIPPED ] " << id << " (no stress function)\n";
+                continue;
+            }
+            results.push_back(run_case(func, std::move(id)));
+            out << "[ STRESSED] " << results.back().id << " (up to " << m_options.max_threads
+                << " threads)\n"
+                << std::flush;
+        }
+    }
+    return results;
+}
+
+void write_stress_table(std::ostream& out, const std::vector<StressResult>& results)
+{
+    char buf[256];
+    for(const auto& r : results)
+    {
+        out << r.id << '\n';
+        std::snprintf(buf, sizeof(buf), "%8s %14s %8s %10s %9s %14s %14s\n", "threads", "ops/s",
+                      "speedup", "efficiency", "fairness", "min ops/s", "max ops/s");
+        out << buf;
+        for(std::size_t i = 0; i < r.steps.size(); ++i)
+        {
+            const StressStep& s = r.steps[i];
+            double lo = 0, hi = 0;
+            for(std::size_t k = 0; k < s.timeline.size(); ++k)
+            {
+                lo = k == 0 || s.timeline[k] < lo ? s.timeline[k] : lo;
+                hi = k == 0 || s.timeline[k] > hi ? s.timeline[k] : hi;
+            }
+            double base = r.steps.front().ops_per_sec;
+            // More threads doing less work in total: a contention cliff.
+            bool drop = i > 0 && s.ops_per_sec < r.steps[i - 1].ops_per_sec;
+            std::snprintf(buf, sizeof(buf), "%8u %14.0f %8.2f %10.2f %9.3f %14.0f %14.0f%s\n",
+                          s.threads, s.ops_per_sec, base > 0 ? s.ops_per_sec / base : 0,
+                          s.efficiency, s.fairness, lo, hi, drop ? "  <- throughput drops" : "");
+            out << buf;
+        }
+    }
+}
+
+void write_stress_json(std::ostream& out, const std::vector<StressResult>& results)
+{
+    using _internal0_impl0_bench::json_string;
+    auto flags = out.flags();
+    auto prec  = out.precision(10);
+    out << "{\"stress\": [";
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        out << (i == 0 ? "\n" : ",\n") << "  {\"name\": ";
+        json_string(out, results[i].id);
+        out << ", \"steps\": [";
+        for(std::size_t j = 0; j < results[i].steps.size(); ++j)
+        {
+            const StressStep& s = results[i].steps[j];
+            out << (j == 0 ? "\n" : ",\n") << "    {\"threads\": " << s.threads
+                << ", \"seconds\": " << s.seconds << ", \"ops\": " << s.ops
+                << ", \"ops_per_sec\": " << s.ops_per_sec << ", \"efficiency\": " << s.efficiency
+                << ", \"fairness\": " << s.fairness << ", \"thread_ops\": [";
+            for(std::size_t k = 0; k < s.thread_ops.size(); ++k)
+            {
+                out << (k == 0 ? "" : ", ") << s.thread_ops[k];
+            }
+            out << "], \"timeline\": [";
+            for(std::size_t k = 0; k < s.timeline.size(); ++k)
+            {
+                out << (k == 0 ? "" : ", ") << s.timeline[k];
+            }
+            out << "]}";
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+    out.precision(prec);
+    out.flags(flags);
+}
+
+int stress_main(int argc, char** argv)
+{
+    StressOptions options;
+    std::string json;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+        else if(arg == "--seconds" && i + 1 < argc)
+        {
+            options.seconds = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "--max-threads" && i + 1 < argc)
+        {
+            options.max_threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--interval-ms" && i + 1 < argc)
+        {
+            options.interval_seconds = std::strtod(argv[++i], nullptr) / 1000;
+        }
+        else if(arg == "--no-pin") { options.pin = false; }
+        else if(arg == "--json" && i + 1 < argc) { json = argv[++i]; }
+        else
+        {
+            std::cerr << "Unknown option " << arg << ".\n";
+            return 2;
+        }
+    }
+    StressRunner runner(std::move(options));
+    std::vector<StressResult> results = runner.run(std::cerr);
+    write_stress_table(std::cout, results);
+    if(!json.empty())
+    {
+        std::ofstream out(json, std::ios::trunc);
+        if(!out)
+        {
+            std::cerr << "Open " << json << " failed.\n";
+            return 1;
+        }
+        write_stress_json(out, results);
+    }
+    return 0;
+}
+
+}  // namespace nstd
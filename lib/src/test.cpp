@@ -1,5 +1,20 @@
 #include "test.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <iostream>
+
+#ifdef __NSTD_TEST_SECTIONS
+// Defined by the linker for the sections, null if no descriptor is linked in.
+extern "C" {
+extern const nstd::TestCaseDesc* const __start_nstd_test_cases[] __attribute__((weak));
+extern const nstd::TestCaseDesc* const __stop_nstd_test_cases[] __attribute__((weak));
+extern const nstd::TestTextDesc* const __start_nstd_test_texts[] __attribute__((weak));
+extern const nstd::TestTextDesc* const __stop_nstd_test_texts[] __attribute__((weak));
+}
+#endif
+
 namespace nstd {
 
 TestGroup::TestGroup(std::string&& n, std::string&& f)
@@ -8,9 +23,9 @@ TestGroup::TestGroup(std::string&& n, std::string&& f)
 }
 TestGroup::TestGroup(const std::string& n, const std::string& f) : group(n), file(f) {}
 
-void TestGroup::add_case(TestKind kind, std::string&& case_name) noexcept;
+void TestGroup::add_case(TestKind kind, std::string&& case_name, TestFunc func) noexcept
 {
-    cases.emplace_back(kind, std::forward<std::string>(case_name));
+    cases.push_back(TestCaseInfo{kind, std::forward<std::string>(case_name), func});
 }
 
 void TestGroup::set_code(std::string&& tests_code) noexcept
@@ -18,81 +33,365 @@ void TestGroup::set_code(std::string&& tests_code) noexcept
     code = std::forward<std::string>(tests_code);
 }
 
+void TestGroup::add_case(TestKind kind,
+                         std::string&& case_name,
+                         BenchSetup setup,
+                         const BenchRange* ranges,
+                         std::size_t range_count) noexcept
+{
+    TestCaseInfo info{kind, std::forward<std::string>(case_name)};
+    if(kind == TestKind::STRESS_TEST) { info.stress = setup; }
+    else { info.bench = setup; }
+    info.ranges      = ranges;
+    info.range_count = range_count;
+    cases.push_back(std::move(info));
+}
+
 const std::string& TestGroup::get_group_name() const noexcept { return group; }
 
+const std::string& TestGroup::get_file() const noexcept { return file; }
+
+const std::string& TestGroup::get_code() const noexcept { return code; }
+
 const std::vector<TestCaseInfo>& TestGroup::get_cases() const noexcept { return cases; }
 
+namespace _internal0_impl0_test {
+#ifndef __NSTD_TEST_SECTIONS
+    const TestCaseNode* case_head = nullptr;
+    const TestTextNode* text_head = nullptr;
+#endif
+
+    constexpr const char* ATTRS[]  = {"utest", "itest", "bench", "stress"};
+    constexpr TestKind ATTR_KINDS[] = {TestKind::UNIT_TEST,
+                                       TestKind::INTEGRATION_TEST,
+                                       TestKind::BENCHMARK,
+                                       TestKind::STRESS_TEST};
+
+    inline bool is_ident(char c) noexcept
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+    inline std::size_t skip_space(const std::string& s, std::size_t i) noexcept
+    {
+        while(i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) { ++i; }
+        return i;
+    }
+
+    // Parse a test attribute "kind(name)" at i. Return the end of it and its trailing comma, or i.
+    inline std::size_t test_attr(const std::string& s, std::size_t i, TestGroup& tg)
+    {
+        std::size_t b = skip_space(s, i), e = b;
+        while(e < s.size() && is_ident(s[e])) { ++e; }
+        for(std::size_t k = 0; k < 4; ++k)
+        {
+            if(s.compare(b, e - b, ATTRS[k]) != 0) { continue; }
+            std::size_t p = skip_space(s, e);
+            if(p >= s.size() || s[p] != '(') { return i; }
+            std::size_t nb = skip_space(s, p + 1), ne = nb;
+            while(ne < s.size() && is_ident(s[ne])) { ++ne; }
+            std::size_t q = skip_space(s, ne);
+            if(ne == nb || q >= s.size() || s[q] != ')') { return i; }
+            tg.add_case(ATTR_KINDS[k], s.substr(nb, ne - nb));
+            q = skip_space(s, q + 1);
+            return q < s.size() && s[q] == ',' ? q + 1 : q;
+        }
+        return i;
+    }
+
+    template <typename... Args>
+    void add_test_case_unchecked(std::vector<nstd::TestGroup>& groups,
+                                 const char* group,
+                                 const char* file,
+                                 TestKind kind,
+                                 const char* name,
+                                 Args... args)
+    {
+        for(auto& g : groups)
+        {
+            if(g.get_group_name() == group)
+            {
+                g.add_case(kind, name, args...);
+                return;
+            }
+        }
+        groups.emplace_back(std::string(group), std::string(file));
+        groups.back().add_case(kind, name, args...);
+    }
+
+    // load() has no error to return, a failure to add the case aborts.
+    template <typename... Args>
+    void add_test_case(std::vector<nstd::TestGroup>& groups,
+                       const char* group,
+                       const char* file,
+                       TestKind kind,
+                       const char* name,
+                       Args... args)
+    {
+#ifdef NSTD_NO_EXCEPTIONS
+        add_test_case_unchecked(groups, group, file, kind, name, args...);
+#else
+        try
+        {
+            add_test_case_unchecked(groups, group, file, kind, name, args...);
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+            std::abort();
+        }
+#endif
+    }
+}  // namespace _internal0_impl0_test
+
+#ifndef __NSTD_TEST_SECTIONS
+TestCaseNode::TestCaseNode(const TestCaseDesc* d) noexcept
+    : desc(d), next(_internal0_impl0_test::case_head)
+{
+    _internal0_impl0_test::case_head = this;
+}
+TestTextNode::TestTextNode(const TestTextDesc* d) noexcept
+    : desc(d), next(_internal0_impl0_test::text_head)
+{
+    _internal0_impl0_test::text_head = this;
+}
+#endif
+
+std::vector<const TestCaseDesc*> test_case_descs()
+{
+    std::vector<const TestCaseDesc*> descs;
+#ifdef __NSTD_TEST_SECTIONS
+    for(auto p = __start_nstd_test_cases; p != __stop_nstd_test_cases; ++p) { descs.push_back(*p); }
+#else
+    for(auto n = _internal0_impl0_test::case_head; n != nullptr; n = n->next)
+    {
+        descs.push_back(n->desc);
+    }
+    // The list is in reverse order of construction.
+    std::reverse(descs.begin(), descs.end());
+#endif
+    return descs;
+}
+
+std::vector<const TestTextDesc*> test_text_descs()
+{
+    std::vector<const TestTextDesc*> descs;
+#ifdef __NSTD_TEST_SECTIONS
+    for(auto p = __start_nstd_test_texts; p != __stop_nstd_test_texts; ++p) { descs.push_back(*p); }
+#else
+    for(auto n = _internal0_impl0_test::text_head; n != nullptr; n = n->next)
+    {
+        descs.push_back(n->desc);
+    }
+    std::reverse(descs.begin(), descs.end());
+#endif
+    return descs;
+}
+
+TestGroup parse_test_text(const TestTextDesc& desc)
+{
+    using namespace _internal0_impl0_test;
+    TestGroup tg(desc.group, desc.file);
+    const std::string text(desc.text);
+    std::string code;
+    code.reserve(text.size());
+    std::size_t i = 0;
+    while(i < text.size())
+    {
+        std::size_t b = text.find("[[", i);
+        if(b == std::string::npos)
+        {
+            code.append(text, i, std::string::npos);
+            break;
+        }
+        std::size_t e = text.find("]]", b + 2);
+        if(e == std::string::npos)
+        {
+            code.append(text, i, std::string::npos);
+            break;
+        }
+        code.append(text, i, b - i);
+        // Drop the test attributes, keep the others.
+        std::string rest;
+        for(std::size_t p = b + 2; p < e;)
+        {
+            std::size_t q = test_attr(text, p, tg);
+            if(q != p)
+            {
+                p = q;
+                continue;
+            }
+            std::size_t comma = text.find(',', p);
+            q                 = comma == std::string::npos || comma > e ? e : comma + 1;
+            rest.append(text, p, q - p);
+            p = q;
+        }
+        while(!rest.empty() &&
+              (rest.back() == ',' || std::isspace(static_cast<unsigned char>(rest.back()))))
+        {
+            rest.pop_back();
+        }
+        if(skip_space(rest, 0) != rest.size()) { code += "[[" + rest + "]]"; }
+        i = e + 2;
+    }
+    tg.set_code(std::move(code));
+    return tg;
+}
+
+std::mutex TestGroupManager::tgm_mutex;
+
 TestGroupManager& TestGroupManager::get_obj()
 {
     static TestGroupManager tgm{};
     return tgm;
 }
 
-void TestGroupManager::add_test_group(TestGroup&& test_group)
+void TestGroupManager::load()
 {
-    try
+    if(loaded) { return; }
+    loaded = true;
+    for(const TestCaseDesc* d : test_case_descs())
+    {
+        using _internal0_impl0_test::add_test_case;
+        if(d->func != nullptr)
+        {
+            add_test_case(groups, d->group, d->file, d->kind, d->name, d->func);
+        }
+        else
+        {
+            add_test_case(
+                groups, d->group, d->file, d->kind, d->name, d->setup, d->ranges, d->range_count);
+        }
+    }
+    for(const TestTextDesc* d : test_text_descs())
     {
+        if(d->doc) { continue; }
+        auto same = [d](const TestGroup& g) { return g.get_group_name() == d->group; };
+        if(std::find_if(groups.begin(), groups.end(), same) != groups.end())
+        {
+            // As add_test_group() does, the group first added stays.
+            std::cerr << "Test group " << d->group << " of " << d->file
+                      << " is already registered, ignored.\n";
+            continue;
+        }
+        groups.push_back(parse_test_text(*d));
+    }
+}
+
+nstd::ResultOmitOk<nstd::Error> TestGroupManager::add_test_group(TestGroup&& test_group)
+{
+    using R  = nstd::ResultOmitOk<nstd::Error>;
+    auto add = [this, &test_group]() {
         std::lock_guard<std::mutex> guard(tgm_mutex);
-        groups.emplace_back(std::forward<TestGroup>(test_group));
+        load();
+        for(const auto& g : groups)
+        {
+            if(g.get_group_name() == test_group.get_group_name())
+            {
+                return R::err(nstd::Error(nstd::Errc::ALREADY_EXISTS)
+                                  .with_context("Add test group ", g.get_group_name()));
+            }
+        }
+        groups.emplace_back(std::move(test_group));
+        return R::ok();
+    };
+#ifdef NSTD_NO_EXCEPTIONS
+    return add();
+#else
+    try
+    {
+        return add();
     }
     catch(const std::exception& e)
     {
-        // todo: Make the output error msg follow the log format.(Currently we don't have log
-        // module.)
-        std::cerr << e.what() + '\n';
-        std::abort();
+        return R::err(nstd::Error(nstd::Errc::EXCEPTION).with_context(e.what()));
     }
+#endif
+}
+
+void TestGroupManager::add_test_case(
+    const char* group, const char* file, TestKind kind, const char* name, TestFunc func)
+{
+    std::lock_guard<std::mutex> guard(tgm_mutex);
+    load();
+    _internal0_impl0_test::add_test_case(groups, group, file, kind, name, func);
+}
+
+void TestGroupManager::add_test_case(
+    const char* group, const char* file, TestKind kind, const char* name, BenchSetup setup)
+{
+    std::lock_guard<std::mutex> guard(tgm_mutex);
+    load();
+    _internal0_impl0_test::add_test_case(groups, group, file, kind, name, setup);
+}
+
+std::vector<nstd::TestGroup> TestGroupManager::get_groups()
+{
+    std::lock_guard<std::mutex> guard(tgm_mutex);
+    load();
+    return groups;
 }
 
 }  // namespace nstd
 
-// clang-format off
-TEST(test_framwork_test,
-#include <string>
-#include <test.hpp>
-[[utest(test_utest)]]
-void test_utest()
+UTEST(test_framwork_test, test_utest)
 {
     nstd::TestGroup tg0("test_framwork_test", __FILE__);
-    assert("test_framwork_test" == tg0.get_group_name().c_str());
+    assert(tg0.get_group_name() == "test_framwork_test");
     nstd::TestGroup tg1(std::string("test_framwork_test"), std::string(__FILE__));
-    assert("test_framwork_test" == tg1.get_group_name().c_str());
-    tg0.add_case(nstd::TestKind::UNIT_TEST, std::string("test_utest"));
-    assert("test_utest" == tg0.get_cases().front().c_str());
+    assert(tg1.get_group_name() == "test_framwork_test");
+    tg0.add_case(nstd::TestKind::UNIT_TEST, std::string("test_utest"), &test_utest);
+    assert(tg0.get_cases().front().name == "test_utest");
+    assert(tg0.get_cases().front().func == &test_utest);
 }
-[[itest(test_itest)]]
-void test_itest()
+
+UTEST(test_framwork_test, test_parse_text)
 {
-    nstd::TestGroup tg0("test_framwork_test", __FILE__);
-    assert("test_framwork_test" == tg0.get_group_name().c_str());
-    nstd::TestGroup tg1(std::string("test_framwork_test"), std::string(__FILE__));
-    assert("test_framwork_test" == tg1.get_group_name().c_str());
-    tg0.add_case(nstd::TestKind::INTEGRATION_TEST, std::string("test_itest"));
-    assert("test_itest" == tg0.get_cases().front().c_str());
-}
-[[bench(test_bench)]]
-void test_bench(nstd::BenchFunc& b)
-{
-    b = []{
-        nstd::TestGroup tg0("test_framwork_test", __FILE__);
-        assert("test_framwork_test" == tg0.get_group_name().c_str());
-        nstd::TestGroup tg1(std::string("test_framwork_test"), std::string(__FILE__));
-        assert("test_framwork_test" == tg1.get_group_name().c_str());
-        tg0.add_case(nstd::TestKind::BENCHMARK, std::string("test_bench"));
-        assert("test_bench" == tg0.get_cases().front().c_str());
+    const nstd::TestTextDesc desc{
+        false,
+        "parsed",
+        __FILE__,
+        "[[utest(a), nodiscard]] int a() { return 1; } [[ itest( b ) ]] void b() {} "
+        "[[bench(c)]] void c(nstd::BenchFunc&) {}",
+        ""};
+    nstd::TestGroup tg = nstd::parse_test_text(desc);
+    assert(tg.get_group_name() == "parsed");
+    assert(tg.get_cases().size() == 3);
+    assert(tg.get_cases()[0].name == "a" && tg.get_cases()[0].kind == nstd::UNIT_TEST);
+    assert(tg.get_cases()[1].name == "b" && tg.get_cases()[1].kind == nstd::INTEGRATION_TEST);
+    assert(tg.get_cases()[2].name == "c" && tg.get_cases()[2].kind == nstd::BENCHMARK);
+    assert(tg.get_code() ==
+           "[[ nodiscard]] int a() { return 1; }  void b() {}  void c(nstd::BenchFunc&) {}");
+}
+
+ITEST(test_framwork_test, test_itest)
+{
+    auto& tgm = nstd::TestGroupManager::get_obj();
+    assert(tgm.add_test_group(nstd::TestGroup("test_framwork_test", __FILE__)).is_err());
+    tgm.add_test_case(
+        "test_framwork_test_added", __FILE__, nstd::INTEGRATION_TEST, "added", &test_itest);
+    bool found = false;
+    for(const auto& g : tgm.get_groups())
+    {
+        found = found || (g.get_group_name() == "test_framwork_test_added" &&
+                          g.get_cases().front().func == &test_itest);
+    }
+    assert(found);
+}
+
+BENCH(test_framwork_test, test_bench)
+{
+    b = [] {
+        nstd::TestGroup tg("test_framwork_test", __FILE__);
+        tg.add_case(nstd::TestKind::BENCHMARK, std::string("test_bench"));
+        assert(tg.get_cases().front().name == "test_bench");
     };
 }
-[[stress(test_stress)]]
-void test_stress(nstd::StressFunc& s)
+
+STRESS(test_framwork_test, test_stress)
 {
-    s = []{
-        nstd::TestGroup tg0("test_framwork_test", __FILE__);
-        assert("test_framwork_test" == tg0.get_group_name().c_str());
-        nstd::TestGroup tg1(std::string("test_framwork_test"), std::string(__FILE__));
-        assert("test_framwork_test" == tg1.get_group_name().c_str());
-        tg0.add_case(nstd::TestKind::STRESS_TEST, std::string("test_stress"));
-        assert("test_stress" == tg0.get_cases().front().c_str());
+    s = [] {
+        nstd::TestGroup tg("test_framwork_test", __FILE__);
+        tg.add_case(nstd::TestKind::STRESS_TEST, std::string("test_stress"));
+        assert(tg.get_cases().front().name == "test_stress");
     };
 }
-)
-// clang-format on
@@ -0,0 +1,531 @@
+#include "test_runner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include "process.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+#define __NSTD_TEST_HAS_SPAWN
+#include <unistd.h>
+#endif
+
+namespace nstd {
+
+namespace _internal0_impl0_test_runner {
+    constexpr const char* RUN_CASE_FLAG = "--nstd-run-case";
+
+    struct Job {
+        const TestCaseInfo* info;
+        std::string id;
+        double expected;  // seconds, negative if unknown
+    };
+
+    inline const char* outcome_str(TestOutcome o) noexcept
+    {
+        switch(o)
+        {
+        case TestOutcome::PASSED: return "[ PASSED  ]";
+        case TestOutcome::FAILED: return "[ FAILED  ]";
+        case TestOutcome::SKIPPED: return "[ SKIPPED ]";
+        }
+        return "";
+    }
+
+    inline std::string self_exe()
+    {
+#ifdef __linux__
+        char buf[4096];
+        ssize_t n = ::readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+        if(n > 0) { return std::string(buf, std::size_t(n)); }
+#endif
+        return std::string();
+    }
+
+    inline std::uint64_t fnv1a(const std::string& data, std::uint64_t h = 0xcbf29ce484222325ull)
+    {
+        for(unsigned char c : data)
+        {
+            h ^= c;
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    inline bool read_file(const std::filesystem::path& path, std::string& content)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if(!in) { return false; }
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        content = ss.str();
+        return true;
+    }
+
+    // The targets of the #include directives in text, with '"' or '<' in front.
+    // The TEST text is stringified into a single line, so directives aren't looked for per line.
+    inline std::vector<std::string> includes_of(const std::string& text)
+    {
+        std::vector<std::string> incs;
+        for(std::size_t i = text.find('#'); i != std::string::npos; i = text.find('#', i + 1))
+        {
+            std::size_t p = i + 1;
+            while(p < text.size() && (text[p] == ' ' || text[p] == '\t')) { ++p; }
+            if(text.compare(p, 7, "include") != 0) { continue; }
+            p += 7;
+            while(p < text.size() && (text[p] == ' ' || text[p] == '\t')) { ++p; }
+            if(p >= text.size() || (text[p] != '"' && text[p] != '<')) { continue; }
+            std::size_t e = text.find(text[p] == '"' ? '"' : '>', p + 1);
+            if(e == std::string::npos) { continue; }
+            incs.push_back(text.substr(p, e - p));
+        }
+        return incs;
+    }
+
+    /* Hashes groups with their dependencies. The files are read and hashed once, however many
+     * groups include them.
+     */
+    class GroupHasher {
+        struct File {
+            std::uint64_t hash;
+            std::vector<std::string> deps;  // the resolved includes
+        };
+        std::vector<std::filesystem::path> m_dirs;
+        std::unordered_map<std::string, File> m_files;
+
+        std::string resolve(const std::string& inc, const std::filesystem::path& dir) const
+        {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            std::vector<fs::path> candidates;
+            if(inc[0] == '"') { candidates.push_back(dir / inc.substr(1)); }
+            for(const auto& d : m_dirs) { candidates.push_back(d / inc.substr(1)); }
+            for(const auto& c : candidates)
+            {
+                if(fs::is_regular_file(c, ec)) { return fs::weakly_canonical(c, ec).string(); }
+            }
+            return std::string();
+        }
+
+        std::vector<std::string> resolve_all(const std::string& text,
+                                             const std::filesystem::path& dir) const
+        {
+            std::vector<std::string> deps;
+            for(const auto& inc : includes_of(text))
+            {
+                std::string path = resolve(inc, dir);
+                if(!path.empty()) { deps.push_back(std::move(path)); }
+            }
+            return deps;
+        }
+
+        const File& file(const std::string& path)
+        {
+            auto it = m_files.find(path);
+            if(it != m_files.end()) { return it->second; }
+            File f{0, {}};
+            std::string content;
+            if(read_file(path, content))
+            {
+                f.hash = fnv1a(content);
+                f.deps = resolve_all(content, std::filesystem::path(path).parent_path());
+            }
+            return m_files.emplace(path, std::move(f)).first->second;
+        }
+
+    public:
+        explicit GroupHasher(const std::vector<std::string>& dirs)
+            : m_dirs(dirs.begin(), dirs.end())
+        {
+        }
+
+        std::uint64_t hash(const TestGroup& group)
+        {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            const fs::path src = fs::weakly_canonical(group.get_file(), ec);
+            std::uint64_t h    = fnv1a(group.get_group_name());
+            // The code of a TEST group is a macro argument, it can't hold an #include: the
+            // includes of the group are the ones of its file.
+            if(!group.get_code().empty()) { h = fnv1a(group.get_code(), h); }
+            // Unknown dependencies, the group always runs.
+            if(!fs::is_regular_file(src, ec)) { return 0; }
+            std::vector<std::string> pending{src.string()};
+            // Walk the include graph, then combine in path order so the hash is stable.
+            std::unordered_set<std::string> seen(pending.begin(), pending.end());
+            std::vector<std::string> deps;
+            while(!pending.empty())
+            {
+                std::string path = std::move(pending.back());
+                pending.pop_back();
+                for(const auto& d : file(path).deps)
+                {
+                    if(seen.insert(d).second) { pending.push_back(d); }
+                }
+                deps.push_back(std::move(path));
+            }
+            std::sort(deps.begin(), deps.end());
+            for(const auto& d : deps) { h = fnv1a(d + '\0' + std::to_string(file(d).hash), h); }
+            return h == 0 ? 1 : h;
+        }
+    };
+}  // namespace _internal0_impl0_test_runner
+
+std::uint64_t test_group_hash(const TestGroup& group, const std::vector<std::string>& include_dirs)
+{
+    return _internal0_impl0_test_runner::GroupHasher(include_dirs).hash(group);
+}
+
+TestRunner::TestRunner(TestRunOptions options) : m_options(std::move(options))
+{
+    if(m_options.jobs == 0) { m_options.jobs = std::thread::hardware_concurrency(); }
+    if(m_options.jobs == 0) { m_options.jobs = 1; }
+    if(m_options.self_exe.empty())
+    {
+        m_options.self_exe = _internal0_impl0_test_runner::self_exe();
+    }
+#ifndef __NSTD_TEST_HAS_SPAWN
+    m_options.isolate = false;
+#endif
+    if(m_options.self_exe.empty()) { m_options.isolate = false; }
+}
+
+void TestRunner::load_timings()
+{
+    if(m_options.timing_db.empty()) { return; }
+    std::ifstream in(m_options.timing_db);
+    double seconds;
+    std::string id;
+    while(in >> seconds >> std::ws && std::getline(in, id)) { m_timings[id] = seconds; }
+}
+
+void TestRunner::save_timings(const TestRunSummary& summary) const
+{
+    if(m_options.timing_db.empty()) { return; }
+    std::unordered_map<std::string, double> timings = m_timings;
+    for(const auto& r : summary.results)
+    {
+        if(r.outcome != TestOutcome::SKIPPED) { timings[r.id] = r.seconds; }
+    }
+    std::vector<std::pair<std::string, double>> sorted(timings.begin(), timings.end());
+    std::sort(sorted.begin(), sorted.end());
+    std::ofstream out(m_options.timing_db, std::ios::trunc);
+    out << std::setprecision(9);
+    for(const auto& t : sorted) { out << t.second << ' ' << t.first << '\n'; }
+}
+
+void TestRunner::load_states()
+{
+    if(m_options.state_file.empty()) { return; }
+    std::ifstream in(m_options.state_file);
+    std::uint64_t hash;
+    int passed;
+    std::string group;
+    while(in >> std::hex >> hash >> std::dec >> passed >> std::ws && std::getline(in, group))
+    {
+        m_states[group] = GroupState{hash, passed != 0};
+    }
+}
+
+void TestRunner::save_states() const
+{
+    if(m_options.state_file.empty()) { return; }
+    std::vector<std::pair<std::string, GroupState>> sorted(m_states.begin(), m_states.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    // Write aside then rename, so an interrupted run doesn't lose the states.
+    std::string tmp = m_options.state_file + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for(const auto& s : sorted)
+        {
+            out << std::hex << std::setw(16) << std::setfill('0') << s.second.hash << std::dec
+                << ' ' << (s.second.passed ? 1 : 0) << ' ' << s.first << '\n';
+        }
+        if(!out.flush()) { return; }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, m_options.state_file, ec);
+}
+
+TestCaseResult TestRunner::run_case(const TestCaseInfo& info, const std::string& id) const
+{
+    TestCaseResult result{id, info.kind, TestOutcome::SKIPPED, 0, {}};
+    if(info.func == nullptr)
+    {
+        result.message = "No body registered for this case.";
+        return result;
+    }
+    auto start = std::chrono::steady_clock::now();
+#ifdef NSTD_NO_EXCEPTIONS
+    // A failing case aborts the run, isolate the cases to report it.
+    info.func();
+    result.outcome = TestOutcome::PASSED;
+#else
+    try
+    {
+        info.func();
+        result.outcome = TestOutcome::PASSED;
+    }
+    catch(const std::exception& e)
+    {
+        result.outcome = TestOutcome::FAILED;
+        result.message = e.what();
+    }
+    catch(...)
+    {
+        result.outcome = TestOutcome::FAILED;
+        result.message = "Unknown exception.";
+    }
+#endif
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+TestCaseResult TestRunner::run_isolated(const TestCaseInfo& info, const std::string& id) const
+{
+    TestCaseResult result{id, info.kind, TestOutcome::SKIPPED, 0, {}};
+    if(info.func == nullptr)
+    {
+        result.message = "No body registered for this case.";
+        return result;
+    }
+#ifdef __NSTD_TEST_HAS_SPAWN
+    ProcessResult proc = run_process(
+        {m_options.self_exe, _internal0_impl0_test_runner::RUN_CASE_FLAG, id}, m_options.timeout);
+    result.seconds = proc.seconds;
+    if(proc.exit_code == 0) { result.outcome = TestOutcome::PASSED; }
+    else
+    {
+        result.outcome = TestOutcome::FAILED;
+        std::ostringstream msg;
+        if(!proc.started) { msg << "Spawn failed."; }
+        else if(proc.timed_out) { msg << "Timed out after " << m_options.timeout << "s."; }
+        else if(proc.signal != 0) { msg << "Killed by signal " << proc.signal << "."; }
+        else { msg << "Exit with code " << proc.exit_code << "."; }
+        result.message = msg.str();
+    }
+    if(!proc.output.empty()) { result.message += "\n" + proc.output; }
+#endif
+    return result;
+}
+
+TestRunSummary TestRunner::run(std::ostream& out)
+{
+    using namespace _internal0_impl0_test_runner;
+    load_timings();
+    load_states();
+    GroupHasher hasher(m_options.include_dirs);
+    // The hashes of the groups run, and whether all their cases were selected.
+    std::unordered_map<std::string, std::pair<std::uint64_t, bool>> run_groups;
+    std::size_t unchanged = 0;
+    // The jobs point into the groups.
+    const std::vector<TestGroup> groups = TestGroupManager::get_obj().get_groups();
+    std::vector<Job> jobs;
+    for(const auto& group : groups)
+    {
+        const std::string& name = group.get_group_name();
+        std::uint64_t hash      = 0;
+        bool changed            = true;
+        if(!m_options.state_file.empty())
+        {
+            hash    = hasher.hash(group);
+            auto st = m_states.find(name);
+            changed = m_options.all || hash == 0 || st == m_states.end() ||
+                      st->second.hash != hash || !st->second.passed;
+        }
+        bool complete = true;
+        std::size_t selected = 0;
+        for(const auto& info : group.get_cases())
+        {
+            bool runnable = info.kind == TestKind::UNIT_TEST ||
+                            info.kind == TestKind::INTEGRATION_TEST;
+            bool wanted = (info.kind == TestKind::UNIT_TEST && m_options.unit_test) ||
+                          (info.kind == TestKind::INTEGRATION_TEST && m_options.integration_test);
+            std::string id = name + "::" + info.name;
+            if(wanted && !m_options.filter.empty())
+            {
+                wanted = id.find(m_options.filter) != std::string::npos;
+            }
+            if(!wanted)
+            {
+                complete = complete && !runnable;
+                continue;
+            }
+            ++selected;
+            if(!changed)
+            {
+                ++unchanged;
+                continue;
+            }
+            auto t = m_timings.find(id);
+            jobs.push_back(Job{&info, std::move(id), t == m_timings.end() ? -1.0 : t->second});
+        }
+        if(changed && selected != 0) { run_groups.emplace(name, std::make_pair(hash, complete)); }
+    }
+    // Longest processing time first. Unknown cases go first, they may be the long ones.
+    std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        bool ua = a.expected < 0, ub = b.expected < 0;
+        if(ua != ub) { return ua; }
+        return a.expected > b.expected;
+    });
+
+    TestRunSummary summary;
+    summary.results.resize(jobs.size());
+    std::atomic<std::size_t> next{0};
+    std::mutex out_mutex;
+    auto start  = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        for(std::size_t i; (i = next.fetch_add(1)) < jobs.size();)
+        {
+            const Job& job = jobs[i];
+            TestCaseResult r =
+                m_options.isolate ? run_isolated(*job.info, job.id) : run_case(*job.info, job.id);
+            std::ostringstream line;
+            line << outcome_str(r.outcome) << ' ' << r.id << " (" << std::fixed
+                 << std::setprecision(3) << r.seconds * 1000 << " ms)\n";
+            if(r.outcome != TestOutcome::PASSED && !r.message.empty())
+            {
+                line << r.message << (r.message.back() == '\n' ? "" : "\n");
+            }
+            {
+                std::lock_guard<std::mutex> guard(out_mutex);
+                out << line.str() << std::flush;
+            }
+            summary.results[i] = std::move(r);
+        }
+    };
+    std::size_t nworkers = std::min<std::size_t>(m_options.jobs, jobs.size());
+    std::vector<std::thread> workers;
+    for(std::size_t i = 1; i < nworkers; ++i) { workers.emplace_back(worker); }
+    worker();
+    for(auto& w : workers) { w.join(); }
+    summary.wall_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    summary.unchanged = unchanged;
+    std::unordered_set<std::string> failed_groups;
+    for(const auto& r : summary.results)
+    {
+        summary.case_seconds += r.seconds;
+        if(r.outcome == TestOutcome::FAILED)
+        {
+            failed_groups.insert(r.id.substr(0, r.id.find("::")));
+        }
+        switch(r.outcome)
+        {
+        case TestOutcome::PASSED: ++summary.passed; break;
+        case TestOutcome::FAILED: ++summary.failed; break;
+        case TestOutcome::SKIPPED: ++summary.skipped; break;
+        }
+    }
+    out << summary.passed << " passed, " << summary.failed << " failed, " << summary.skipped
+        << " skipped, " << summary.unchanged << " unchanged in " << std::fixed
+        << std::setprecision(3) << summary.wall_seconds << " s (case time " << summary.case_seconds
+        << " s, " << nworkers << " jobs)\n";
+    save_timings(summary);
+    // A group passes when all its cases ran and none failed. A partial run only records failures.
+    for(const auto& g : run_groups)
+    {
+        if(g.second.first == 0) { continue; }
+        bool failed = failed_groups.count(g.first) != 0;
+        if(failed || g.second.second) { m_states[g.first] = GroupState{g.second.first, !failed}; }
+    }
+    save_states();
+    return summary;
+}
+
+int run_single_test_case(const std::string& id)
+{
+    for(const auto& group : TestGroupManager::get_obj().get_groups())
+    {
+        for(const auto& info : group.get_cases())
+        {
+            if(info.func == nullptr || group.get_group_name() + "::" + info.name != id)
+            {
+                continue;
+            }
+#ifdef NSTD_NO_EXCEPTIONS
+            info.func();
+            return 0;
+#else
+            try
+            {
+                info.func();
+                return 0;
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << '\n';
+            }
+            catch(...)
+            {
+                std::cerr << "Unknown exception.\n";
+            }
+            return 1;
+#endif
+        }
+    }
+    std::cerr << "No test case " << id << ".\n";
+    return 3;
+}
+
+int test_main(int argc, char** argv)
+{
+    TestRunOptions options;
+    bool kind_given = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == _internal0_impl0_test_runner::RUN_CASE_FLAG && i + 1 < argc)
+        {
+            return run_single_test_case(argv[i + 1]);
+        }
+        else if(arg == "-j" && i + 1 < argc)
+        {
+            options.jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(arg == "--isolate") { options.isolate = true; }
+        else if(arg == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+        else if(arg == "--timing-db" && i + 1 < argc) { options.timing_db = argv[++i]; }
+        else if(arg == "--state" && i + 1 < argc) { options.state_file = argv[++i]; }
+        else if(arg == "--all") { options.all = true; }
+        else if(arg == "--timeout" && i + 1 < argc)
+        {
+            options.timeout = std::strtod(argv[++i], nullptr);
+        }
+        else if(arg == "-I" && i + 1 < argc) { options.include_dirs.push_back(argv[++i]); }
+        else if(arg == "--unit" || arg == "--integration")
+        {
+            if(!kind_given) { options.unit_test = options.integration_test = false; }
+            kind_given = true;
+            (arg == "--unit" ? options.unit_test : options.integration_test) = true;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << arg << ".\n";
+            return 2;
+        }
+    }
+    if(options.self_exe.empty() && argc > 0 && std::strchr(argv[0], '/') != nullptr)
+    {
+        options.self_exe = argv[0];
+    }
+    TestRunner runner(std::move(options));
+    TestRunSummary summary = runner.run(std::cout);
+    return summary.failed == 0 ? 0 : 1;
+}
+
+}  // namespace nstd
@@ -0,0 +1,69 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "../lib/include/alloc_tracker.hpp"
+
+// Counts with alloc_tracker.cpp built with -DNSTD_ALLOC_TRACKER, without a sanitizer: it brings
+// its own malloc. Otherwise only checks that nothing fails.
+
+void* volatile sink;  // the allocations aren't optimized out
+
+int main()
+{
+    const bool on = nstd::alloc_tracking_enabled();
+    nstd::expect_allocations(0, [] {});
+    nstd::expect_allocations(1, [] { delete static_cast<int*>(sink = new int(1)); });
+    nstd::expect_allocations(2, [] { std::vector<int> v(10); });
+
+    std::string message;
+    try
+    {
+        nstd::expect_allocations(0, [] { std::free(sink = std::malloc(40)); });
+    }
+    catch(const std::runtime_error& e)
+    {
+        message = e.what();
+    }
+    assert(message == (on ? "Expected at most 0 allocations, got 1 (40 bytes)." : ""));
+
+    nstd::AllocScope scope;
+    sink = new int[4];
+    delete[] static_cast<int*>(sink);
+    nstd::AllocStats d = scope.delta();
+    assert(on ? d.allocs == 1 && d.frees == 1 && d.bytes == 4 * sizeof(int) : d.allocs == 0);
+
+#if defined(__GLIBC__)
+    auto counted = [on](std::uint64_t bytes, void* (*alloc)()) {
+        nstd::AllocScope s;
+        sink = alloc();
+        assert(sink != nullptr);
+        std::free(sink);
+        nstd::AllocStats c = s.delta();
+        assert(!on || (c.allocs == 1 && c.frees == 1 && c.bytes == bytes));
+    };
+    counted(24, [] { return std::calloc(3, 8); });
+    counted(64, [] { return std::aligned_alloc(64, 64); });
+    counted(100, [] { return memalign(64, 100); });
+    counted(100, [] { return valloc(100); });
+    counted(100, [] { return pvalloc(100); });
+    counted(100, [] {
+        void* p = nullptr;
+        return posix_memalign(&p, 64, 100) == 0 ? p : nullptr;
+    });
+
+    // An overflowing calloc fails, and isn't counted as a huge allocation.
+    volatile std::size_t huge = SIZE_MAX / 2;  // not known to the compiler
+    nstd::AllocScope over;
+    sink = std::calloc(huge, 4);
+    assert(sink == nullptr && over.delta().allocs == 0 && over.delta().bytes == 0);
+#endif
+    std::cout << (on ? "counted" : "not counted") << std::endl;
+}
@@ -0,0 +1,52 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/bench.hpp"
+
+std::vector<nstd::BenchInstance> instances(std::vector<nstd::BenchRange> ranges)
+{
+    nstd::TestCaseInfo info{nstd::TestKind::BENCHMARK, "c"};
+    info.ranges      = ranges.data();
+    info.range_count = ranges.size();
+    return nstd::bench_instances(info, "g::c");
+}
+
+std::vector<std::int64_t> values(const nstd::BenchRange& range)
+{
+    std::vector<std::int64_t> v;
+    for(const auto& inst : instances({range}))
+    {
+        assert(inst.args.size() == 1 && inst.id == "g::c/" + std::to_string(inst.args[0]));
+        v.push_back(inst.args[0]);
+    }
+    return v;
+}
+
+int main()
+{
+    std::vector<nstd::BenchInstance> plain = instances({});
+    assert(plain.size() == 1 && plain[0].id == "g::c" && plain[0].args.empty());
+
+    assert(values({8, 64}) == (std::vector<std::int64_t>{8, 16, 32, 64}));
+    assert(values({1, 100, 10}) == (std::vector<std::int64_t>{1, 10, 100}));
+    assert(values({3, 20, 4}) == (std::vector<std::int64_t>{3, 12, 20}));
+    assert(values({5, 5}) == (std::vector<std::int64_t>{5}));
+    assert(values({-3, 4}) == (std::vector<std::int64_t>{-3, 1, 2, 4}));
+    // A mult below 2 doesn't step by 1.
+    assert(values({1, 1 << 20, 1}).size() == 21);
+    assert(values({1, 1 << 20, 0}).size() == 21);
+    // Doesn't overflow near the top.
+    std::vector<std::int64_t> top = values({1, INT64_MAX});
+    assert(top.size() == 64 && top[62] == std::int64_t(1) << 62 && top[63] == INT64_MAX);
+
+    // The last argument varies slowest.
+    std::vector<nstd::BenchInstance> both = instances({{1, 2}, {10, 20, 10}});
+    assert(both.size() == 4);
+    assert(both[0].id == "g::c/1/10" && both[1].id == "g::c/2/10");
+    assert(both[2].id == "g::c/1/20" && both[3].id == "g::c/2/20");
+    assert((both[3].args == std::vector<std::int64_t>{2, 20}));
+    std::cout << top.size() << std::endl;
+}
@@ -0,0 +1,50 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/bench_baseline.hpp"
+
+bool near(double a, double b) { return std::fabs(a - b) < 1e-6; }
+
+nstd::BenchResult result(const std::string& id, std::vector<double> samples)
+{
+    nstd::BenchResult r;
+    r.id      = id;
+    r.stats   = nstd::compute_bench_stats(samples);
+    r.samples = std::move(samples);
+    return r;
+}
+
+int main()
+{
+    // No overlap: U = 0, z = (12.5 - 0.5) / sqrt(25 / 12 * 11).
+    const std::vector<double> low{1, 2, 3, 4, 5}, high{6, 7, 8, 9, 10};
+    assert(near(nstd::mann_whitney_p(low, high), 0.0121857804));
+    assert(near(nstd::mann_whitney_p(high, low), 0.0121857804));
+    // Ties get their mean rank, and shrink the variance.
+    assert(near(nstd::mann_whitney_p({1, 2, 2, 3}, {2, 3, 4, 5}), 0.1366582477));
+    assert(nstd::mann_whitney_p({1, 2, 3}, {3, 2, 1}) == 1);
+    assert(nstd::mann_whitney_p({1, 1}, {1, 1}) == 1);
+    assert(nstd::mann_whitney_p({}, high) == 1);
+
+    // At a confidence of 0.99, 20 samples apart are significant, the 5 above are not.
+    std::vector<double> fast, slow;
+    for(int i = 0; i < 20; ++i)
+    {
+        fast.push_back(100 + i);
+        slow.push_back(130 + i);
+    }
+    nstd::BenchCompareOptions options;
+    auto c = nstd::compare_bench({result("g::a", fast), result("g::b", low), result("g::c", fast)},
+                                 {result("g::a", slow), result("g::b", high), result("g::d", fast)},
+                                 options);
+    assert(c.size() == 4);
+    assert(c[0].id == "g::a" && c[0].verdict == nstd::BenchVerdict::SLOWER && c[0].ratio > 1.2);
+    assert(c[1].id == "g::b" && c[1].verdict == nstd::BenchVerdict::SAME);
+    assert(c[2].id == "g::d" && c[2].verdict == nstd::BenchVerdict::NEW);
+    assert(c[3].id == "g::c" && c[3].verdict == nstd::BenchVerdict::MISSING);
+    assert(nstd::has_regression(c));
+    std::cout << c[0].p_value << std::endl;
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/doc_test.hpp"
+
+namespace fs = std::filesystem;
+
+void write(const fs::path& path, const std::string& text)
+{
+    std::ofstream out(path, std::ios::trunc);
+    out << text;
+}
+
+std::vector<nstd::DocTestResult> run(const std::vector<nstd::DocSnippet>& snippets,
+                                     const fs::path& dir)
+{
+    nstd::DocTestOptions options;
+    options.compiler  = "c++";
+    options.cache_dir = (dir / "cache").string();
+    options.flags.push_back("-I" + dir.string());
+    options.jobs = 2;
+    std::ostringstream out;
+    return nstd::DocTestDriver(options).run(snippets, out);
+}
+
+int main()
+{
+    const fs::path dir = fs::temp_directory_path() / "nstd_test_doc_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string file = (dir / "sample.hpp").string();
+    write(file,
+          "#include \"test.hpp\"\n"
+          "DOC_TEST(sample, (<cassert>, \"value.hpp\"),\n"
+          "/// ```\n"
+          "/// assert(VALUE == 1);\n"
+          "/// ```\n"
+          "/* Not code.\n"
+          " * ```\n"
+          " * int x = \"no\";\n"
+          " * ```\n"
+          " */\n"
+          "int f();\n"
+          ")\n"
+          "DOC_TEST(other, (),\n"
+          "/// ```\n"
+          "/// return;\n"
+          ")\n");
+    write(dir / "value.hpp", "#define VALUE 1\n");
+
+    const nstd::TestTextDesc sample{true, "sample", file.c_str(), "", "<cassert>, \"value.hpp\""};
+    auto extracted = nstd::extract_doc_tests(sample);
+    assert(extracted.is_ok());
+    std::vector<nstd::DocSnippet> snippets = std::move(extracted).unwrap();
+    assert(snippets.size() == 2);
+    assert(snippets[0].name == "sample_0" && snippets[0].line == 3);
+    assert(snippets[1].name == "sample_1" && snippets[1].line == 7);
+    const std::string& code = snippets[0].code;
+    assert(code.find("#include <cassert>\n#include \"value.hpp\"\nvoid sample_0()\n{\n") == 0);
+    assert(code.find("#line 4 \"" + file + "\"\nassert(VALUE == 1);\n}\n") != std::string::npos);
+    assert(code.find("int main()\n{\n    sample_0();") != std::string::npos);
+
+    const nstd::TestTextDesc other{true, "other", file.c_str(), "", ""};
+    nstd::Error unterminated = nstd::extract_doc_tests(other).unwrap_err();
+    assert(unterminated == nstd::Errc::INVALID_FORMAT);
+    const nstd::TestTextDesc missing{true, "missing", file.c_str(), "", ""};
+    assert(nstd::extract_doc_tests(missing).unwrap_err() == nstd::Errc::NOT_FOUND);
+
+    // The first snippet passes, the second doesn't compile.
+    std::vector<nstd::DocTestResult> results = run(snippets, dir);
+    assert(results[0].outcome == nstd::DocTestOutcome::PASSED && !results[0].cached);
+    assert(results[1].outcome == nstd::DocTestOutcome::COMPILE_FAILED);
+    assert(results[1].output.find("sample.hpp:8") != std::string::npos);
+
+    snippets.pop_back();
+    results = run(snippets, dir);
+    assert(results[0].outcome == nstd::DocTestOutcome::PASSED && results[0].cached);
+
+    // A change to an included header builds the snippet again, the source is unchanged.
+    write(dir / "value.hpp", "#define VALUE 2\n");
+    results = run(snippets, dir);
+    assert(results[0].outcome == nstd::DocTestOutcome::RUN_FAILED && !results[0].cached);
+    results = run(snippets, dir);
+    assert(results[0].outcome == nstd::DocTestOutcome::RUN_FAILED && results[0].cached);
+    write(dir / "value.hpp", "#define VALUE 1\n");
+    results = run(snippets, dir);
+    assert(results[0].outcome == nstd::DocTestOutcome::PASSED && results[0].cached);
+
+    for(const auto& entry : fs::directory_iterator(dir / "cache"))
+    {
+        assert(entry.path().string().find(".tmp") == std::string::npos);
+    }
+    fs::remove_all(dir);
+    std::cout << code.size() << std::endl;
+}
@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../lib/include/error.hpp"
+#include "../lib/include/result.hpp"
+
+class HttpCategory final : public nstd::ErrorCategory {
+public:
+    const char* name() const noexcept override { return "http"; }
+    std::string message(int code) const override { return "HTTP " + std::to_string(code); }
+};
+
+const HttpCategory& http_category()
+{
+    static const HttpCategory category;
+    return category;
+}
+
+nstd::Result<int, nstd::Error> open_port(int port)
+{
+    using R = nstd::Result<int, nstd::Error>;
+    if(port < 0) { return R::err(nstd::Errc::INVALID_ARGUMENT); }
+    if(port == 80) { return R::err(nstd::Error(403, http_category()).with_context("Port ", 80)); }
+    return R::ok(port);
+}
+
+int main()
+{
+    static_assert(sizeof(nstd::Error) <= sizeof(void*));
+    static_assert(std::is_trivially_copyable_v<nstd::Error>);
+    static_assert(std::is_trivially_copyable_v<nstd::ResultOmitOk<nstd::Error>>);
+    static_assert(nstd::Error(nstd::Errc::NOT_FOUND).code() == int(nstd::Errc::NOT_FOUND));
+
+    nstd::Error e = nstd::Errc::TIMED_OUT;
+    assert(&e.category() == &nstd::generic_category() && !e.has_context());
+    assert(e.message() == "Timed out.");
+
+    nstd::Error ctx = nstd::Error::from_errno(ENOENT).with_context("Open ", std::string("a.txt"));
+    assert(ctx == nstd::Error::from_errno(ENOENT) && ctx != e);
+    assert(ctx.context() == "Open a.txt");
+    assert(ctx.message() == "Open a.txt: " + std::generic_category().message(ENOENT) + ".");
+
+    auto r = open_port(80);
+    assert(r.is_err() && r.unwrap_err().category().name() == std::string("http"));
+    std::ostringstream os;
+    os << r.unwrap_err();
+    assert(os.str() == "Port 80: HTTP 403.");
+    assert(open_port(-1).unwrap_err() == nstd::Errc::INVALID_ARGUMENT);
+    assert(open_port(8080).unwrap() == 8080);
+
+    // The context lives in the thread which attached it.
+    std::thread([ctx] { assert(ctx.context().empty()); }).join();
+    // And is dropped once the ring has gone around.
+    for(int i = 0; i < __NSTD_ERROR_CTX_SLOTS; ++i) { (void)e.with_context(i); }
+    assert(ctx.context().empty() && ctx.message() == ctx.category().message(ENOENT) + ".");
+
+    // After the 16 bit ids wrap, a slot reused for an error of another code isn't taken as ours.
+    nstd::Error mine = nstd::Error(nstd::Errc::NOT_FOUND).with_context("mine");
+    for(int i = 0; i < 65535; ++i) { (void)e.with_context(i); }
+    assert(mine.has_context() && mine.context().empty());
+
+    // Other threads attaching at the same time don't shorten the ring of a thread.
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t] {
+            std::vector<nstd::Error> ring;
+            for(int i = 0; i < 2000; ++i)
+            {
+                ring.push_back(nstd::Error(nstd::Errc::NOT_FOUND).with_context(t, "/", i));
+                if(ring.size() > __NSTD_ERROR_CTX_SLOTS) { ring.erase(ring.begin()); }
+                for(std::size_t k = 0; k < ring.size(); ++k)
+                {
+                    int n = i + 1 - int(ring.size() - k);
+                    assert(ring[k].context() == std::to_string(t) + "/" + std::to_string(n));
+                }
+            }
+        });
+    }
+    for(auto& th : threads) { th.join(); }
+
+    std::string long_ctx(300, 'x');
+    assert(e.with_context(long_ctx).context().size() == __NSTD_ERROR_CTX_SIZE);
+    std::cout << sizeof(nstd::Error) << " " << sizeof(nstd::ResultOmitOk<nstd::Error>) << std::endl;
+}
@@ -0,0 +1,30 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "../lib/include/format.hpp"
+
+int main()
+{
+    char buf[nstd::FLOAT_BUF_SIZE];
+    assert(std::string(buf, nstd::u64_to_dec(buf, 0)) == "0");
+    assert(std::string(buf, nstd::u64_to_dec(buf, 18446744073709551615ull)) ==
+           "18446744073709551615");
+    assert(std::string(buf, nstd::i64_to_dec(buf, -9223372036854775807ll - 1)) ==
+           "-9223372036854775808");
+    assert(std::string(buf, nstd::u64_to_hex(buf, 0xbeef)) == "beef");
+    assert(std::string(buf, nstd::f64_to_str(buf, 0.1)) == "0.1");
+    std::chrono::system_clock::time_point tp{std::chrono::microseconds(1760877560123456ll)};
+    assert(std::string(buf, nstd::render_timestamp(buf, tp)) == "2025-10-19 12:39:20.123456");
+    assert(std::string(buf, nstd::render_duration(buf, std::chrono::microseconds(12345))) ==
+           "12.345ms");
+    auto duration = [&buf](std::int64_t ns) {
+        return std::string(buf, nstd::render_duration(buf, std::chrono::nanoseconds(ns)));
+    };
+    assert(duration(0) == "0ns" && duration(-999) == "-999ns");
+    assert(duration(1000) == "1.000us" && duration(999999) == "999.999us");
+    // Rounded up to 1000 of a unit, it's the next one.
+    assert(duration(999999500) == "1.000s" && duration(999999499) == "999.999ms");
+    assert(duration(-9223372036854775807ll - 1) == "-9223372036.855s");
+    std::cout << nstd::hex(255) << " " << nstd::shortest(1.5) << std::endl;
+}
@@ -0,0 +1,39 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+#include "../lib/include/function.hpp"
+
+static int twice(int x) { return x * 2; }
+
+static int apply(nstd::FunctionRef<int(int)> f, int x) { return f(x); }
+
+int main()
+{
+    int k = 3;
+    assert(apply([&](int x) { return x * k; }, 2) == 6);
+    assert(apply(twice, 4) == 8);
+
+    nstd::InplaceFunction<int(int), 16> f;
+    assert(f == nullptr);
+    f = [k](int x) { return x + k; };
+    assert(f != nullptr && f(1) == 4);
+    auto g = f;
+    assert(g(2) == 5);
+    auto h = std::move(g);
+    assert(h(3) == 6 && !g);
+    f = &twice;
+    assert(f(5) == 10);
+    f = static_cast<int (*)(int)>(nullptr);
+    assert(!f);
+
+    auto counter = std::make_shared<int>(0);
+    {
+        nstd::InplaceFunction<void()> inc = [counter] { ++*counter; };
+        inc();
+        assert(counter.use_count() == 2);
+    }
+    assert(*counter == 1 && counter.use_count() == 1);
+    std::cout << sizeof(nstd::FunctionRef<void()>) << " " << sizeof(nstd::InplaceFunction<void()>)
+              << std::endl;
+}
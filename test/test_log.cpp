@@ -0,0 +1,83 @@
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../lib/include/log.hpp"
+
+// Keeps "<Level> <line>: <message>" of the records of the enabled levels.
+class CaptureLogger : public nstd::Logger {
+    unsigned int m_levels;
+
+public:
+    std::vector<std::string> lines;
+    bool fail   = false;  // log() returns an error
+    bool throw_ = false;  // log() throws
+
+    explicit CaptureLogger(unsigned int levels) : m_levels(levels) {}
+    bool enabled(const nstd::LogMetaData& md) override
+    {
+        return (md.log_type->mask() & m_levels) != 0;
+    }
+    nstd::LogResult log(nstd::LogMetaData&& md) override
+    {
+        if(fail)
+        {
+            return nstd::LogResult::err(nstd::Error(nstd::Errc::IO_ERROR).with_context("Sink"));
+        }
+#ifndef NSTD_NO_EXCEPTIONS
+        if(throw_) { throw std::runtime_error("sink exploded"); }
+#endif
+        lines.push_back(std::string(md.log_type->c_str()) + " " + std::to_string(md.line) + ": " +
+                        get_buf().str());
+        return nstd::LogResult::ok();
+    }
+    void flush() noexcept override {}
+};
+
+int main()
+{
+    auto all  = std::make_shared<CaptureLogger>(~0u);
+    auto warn = std::make_shared<CaptureLogger>(nstd::LogType::LOG_WARN | nstd::LogType::LOG_ERROR);
+    assert(nstd::GlobalLogger::add_logger(all).is_ok());
+    assert(nstd::GlobalLogger::add_logger(warn).is_ok());
+    assert(nstd::GlobalLogger::add_logger(all).unwrap_err() == nstd::Errc::ALREADY_EXISTS);
+    assert(nstd::GlobalLogger::add_logger(nullptr).is_ok());
+
+    const unsigned int line = __LINE__ + 1;
+    NSTD_LOG_INFO("value " << 42);
+    NSTD_LOG_WARN("disk " << 93 << "%");
+    assert(all->lines.size() == 2 && warn->lines.size() == 1);
+    assert(all->lines[0] == "Info " + std::to_string(line) + ": value 42\n");
+    // Every logger gets the whole metadata, not one moved out by the previous logger.
+    assert(all->lines[1] == "Warn " + std::to_string(line + 1) + ": disk 93%\n");
+    assert(warn->lines[0] == all->lines[1]);
+
+    // The errors of a logger are reported to stderr, the macro doesn't fail.
+    std::ostringstream err;
+    std::streambuf* cerr_buf = std::cerr.rdbuf(err.rdbuf());
+    warn->fail = true;
+    NSTD_LOG_ERROR("lost");
+    assert(err.str().find("Sink: I/O error.") != std::string::npos);
+    assert(all->lines.back() == "Error " + std::to_string(__LINE__ - 2) + ": lost\n");
+#ifndef NSTD_NO_EXCEPTIONS
+    warn->fail   = false;
+    warn->throw_ = true;
+    NSTD_LOGGER_WARN((*warn), "thrown");
+    assert(err.str().find("sink exploded") != std::string::npos);
+#endif
+    std::cerr.rdbuf(cerr_buf);
+
+    NSTD_LOGGER_DEBUG((*all), "direct");
+    assert(all->lines.back() == "Debug " + std::to_string(__LINE__ - 1) + ": direct\n");
+
+    assert(nstd::GlobalLogger::remove_logger(all).is_ok());
+    assert(nstd::GlobalLogger::remove_logger(warn).is_ok());
+    std::size_t before = all->lines.size();
+    NSTD_LOG_FATAL("nobody listens");
+    assert(all->lines.size() == before && nstd::GlobalLogger::global_logger().empty());
+    std::cout << all->lines.size() << std::endl;
+}
@@ -0,0 +1,100 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../lib/include/log.hpp"
+#include "../lib/include/log_context.hpp"
+
+// Keeps the records as the built-in sinks render the context and the message.
+class CaptureLogger : public nstd::Logger {
+public:
+    std::vector<std::string> records;
+
+    bool enabled(const nstd::LogMetaData&) override { return true; }
+    nstd::LogResult log(nstd::LogMetaData&& md) override
+    {
+        std::string ctx(nstd::log_context_size(md.context), '\0');
+        nstd::render_log_context(&ctx[0], md.context);
+        records.push_back(ctx + get_buf().str());
+        return nstd::LogResult::ok();
+    }
+    void flush() noexcept override {}
+};
+
+std::string render(nstd::LogContextView view)
+{
+    std::string s;
+    for(const auto& e : view)
+    {
+        s += e.key;
+        s += '=';
+        s += e.get_value();
+        s += ' ';
+    }
+    return s;
+}
+
+int main()
+{
+    nstd::LogContext& ctx = nstd::LogContext::current();
+    assert(ctx.view().empty());
+    {
+        NSTD_LOG_SCOPE_CTX("req", 42);
+        NSTD_LOG_SCOPE_CTX("user", "alice");
+        assert(render(ctx.view()) == "req=42 user=alice ");
+        {
+            NSTD_LOG_SCOPE_CTX("neg", -7);
+            assert(ctx.view().size() == 3 && render(ctx.view()) == "req=42 user=alice neg=-7 ");
+        }
+        assert(ctx.view().size() == 2);
+    }
+    assert(ctx.view().empty());
+
+    // A logged record carries the entries of its scopes.
+    CaptureLogger capture;
+    {
+        NSTD_LOG_SCOPE_CTX("req", 42);
+        NSTD_LOG_SCOPE_CTX("user", "alice");
+        NSTD_LOGGER_INFO(capture, "in");
+    }
+    NSTD_LOGGER_INFO(capture, "out");
+    assert(capture.records.size() == 2);
+    assert(capture.records[0] == "[req=42 user=alice] in\n" && capture.records[1] == "out\n");
+
+    // Long values are truncated.
+    ctx.push("long", std::string(100, 'v'));
+    assert(ctx.view().begin()->get_value().size() == __NSTD_LOG_CTX_VALUE_SIZE);
+    ctx.pop();
+
+    // The pushes past the capacity are dropped, and their pops don't take the kept entries.
+    for(int i = 0; i < __NSTD_LOG_CTX_CAPACITY + 3; ++i) { ctx.push("i", i); }
+    assert(ctx.view().size() == __NSTD_LOG_CTX_CAPACITY);
+    assert((ctx.view().end() - 1)->get_value() == std::to_string(__NSTD_LOG_CTX_CAPACITY - 1));
+    for(int i = 0; i < 3; ++i) { ctx.pop(); }
+    assert(ctx.view().size() == __NSTD_LOG_CTX_CAPACITY);
+    ctx.pop();
+    assert(ctx.view().size() == __NSTD_LOG_CTX_CAPACITY - 1);
+    for(int i = 0; i < __NSTD_LOG_CTX_CAPACITY - 1; ++i) { ctx.pop(); }
+    assert(ctx.view().empty());
+    ctx.pop();  // An extra pop is ignored.
+    assert(ctx.view().empty());
+
+    // A snapshot carries the context to another thread, which gets its own back afterwards.
+    NSTD_LOG_SCOPE_CTX("trace", "t-1");
+    nstd::LogContextSnapshot snapshot = nstd::LogContextSnapshot::capture();
+    std::thread([snapshot] {
+        nstd::LogContext& worker = nstd::LogContext::current();
+        NSTD_LOG_SCOPE_CTX("worker", 1);
+        {
+            nstd::LogContextRestore restore(snapshot);
+            assert(render(worker.view()) == "trace=t-1 ");
+            NSTD_LOG_SCOPE_CTX("job", 9);
+            assert(render(worker.view()) == "trace=t-1 job=9 ");
+        }
+        assert(render(worker.view()) == "worker=1 ");
+    }).join();
+    assert(render(ctx.view()) == "trace=t-1 " && render(snapshot.view()) == "trace=t-1 ");
+    std::cout << sizeof(nstd::LogContextEntry) << std::endl;
+}
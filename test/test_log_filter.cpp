@@ -0,0 +1,80 @@
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "../lib/include/log_filter.hpp"
+
+using nstd::LogType;
+
+nstd::LogFilter compile(const std::string& expr)
+{
+    auto r = nstd::LogFilter::compile(expr);
+    assert(r.is_ok());
+    return std::move(r).unwrap();
+}
+
+nstd::Error reject(const std::string& expr)
+{
+    auto r = nstd::LogFilter::compile(expr);
+    assert(r.is_err());
+    return r.unwrap_err();
+}
+
+int main()
+{
+    assert(nstd::glob_match("net.*", "net.http") && nstd::glob_match("a?c*", "abcd"));
+    assert(!nstd::glob_match("net.*", "netty") && nstd::glob_match("*", ""));
+
+    nstd::LogFilter f = compile(R"(level>=WARN || (module=net.* && file~"http"))");
+    assert(f.predicates().size() == 2);
+    assert(f.evaluate(LogType::LOG_ERROR, "db", "db.cpp", "query"));
+    assert(f.evaluate(LogType::LOG_DEBUG, "net.tcp", "src/http.cpp", "send"));
+    assert(!f.evaluate(LogType::LOG_DEBUG, "net.tcp", "src/tcp.cpp", "send"));
+    assert(!f.evaluate(LogType::LOG_INFO, "db", "src/http.cpp", "send"));
+    assert(!f.evaluate(LogType::LOG_PERF, "db", "db.cpp", "query"));
+
+    nstd::LogFilter g = compile("!(level<INFO) && level!=FATAL && func!=\"noisy*\"");
+    assert(g.evaluate(LogType::LOG_INFO, "", "", "run"));
+    assert(!g.evaluate(LogType::LOG_DEBUG, "", "", "run"));
+    assert(!g.evaluate(LogType::LOG_FATAL, "", "", "run"));
+    assert(!g.evaluate(LogType::LOG_WARN, "", "", "noisy_loop"));
+    assert(compile("level=PERF").evaluate(LogType::LOG_PERF, "", "", ""));
+    assert(!compile("false || !true").evaluate(LogType::LOG_FATAL, "", "", ""));
+
+    // Past MAX_TABLE_PREDS the bytecode is run instead of the table, with the same results.
+    std::string many = "level=ERROR";
+    for(std::size_t i = 0; i <= nstd::LogFilter::MAX_TABLE_PREDS; ++i)
+    {
+        many += " || module=m" + std::to_string(i);
+    }
+    nstd::LogFilter h = compile(many);
+    assert(h.predicates().size() == nstd::LogFilter::MAX_TABLE_PREDS + 1);
+    assert(h.evaluate(LogType::LOG_DEBUG, "m6", "", ""));
+    assert(h.evaluate(LogType::LOG_ERROR, "x", "", ""));
+    assert(!h.evaluate(LogType::LOG_DEBUG, "m7", "", ""));
+
+    // Through a call site, the string predicates are resolved once and cached in the site.
+    nstd::LogSite site;
+    nstd::LogMetaData md(LogType(LogType::LOG_DEBUG), "src/http.cpp", 1, "send", "net.udp");
+    md.site = &site;
+    assert(f.enabled(md));
+    std::uint64_t cached = 0;
+    for(const auto& slot : site.cache) { cached |= slot.load(); }
+    assert(cached != 0 && f.enabled(md));
+    nstd::LogMetaData other(LogType(LogType::LOG_DEBUG), "src/tcp.cpp", 2, "send", "net.udp");
+    assert(!f.enabled(other));
+
+    nstd::Error unknown = reject("level>=LOUD");
+    assert(unknown == nstd::Errc::INVALID_ARGUMENT);
+    assert(unknown.context() == "Unknown level at column 12");
+    assert(reject("(level=INFO").context() == "Expect ')' at column 12");
+    assert(reject("module~\"open").context().substr(0, 20) == "Unterminated string ");
+    assert(reject("level<PERF") == nstd::Errc::INVALID_ARGUMENT);
+    assert(reject("level=INFO level=WARN").context().substr(0, 16) == "Unexpected token");
+    std::string deep;
+    for(int i = 0; i < 70; ++i) { deep += "true || ("; }
+    deep += "true" + std::string(70, ')');
+    assert(reject(deep) == nstd::Errc::LIMIT_EXCEEDED);
+    std::cout << f.code().size() << " " << h.code().size() << std::endl;
+}
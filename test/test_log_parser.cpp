@@ -0,0 +1,73 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/log_parser.hpp"
+
+int main()
+{
+    // Write a log through the macros the parser reads, with foreign lines in between.
+    std::filesystem::path tmp     = std::filesystem::temp_directory_path();
+    std::string path              = (tmp / "nstd_test_log_parser.log").string();
+    const unsigned int first_line = __LINE__ + 9;  // the line of __NSTD_WARNING below
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::streambuf* cerr_buf = std::cerr.rdbuf(out.rdbuf());
+        for(int i = 0; i < 1000; ++i)
+        {
+            if(i % 10 == 9) { std::cerr << "plain line " << i << "\n"; }
+            else if(i % 2 == 0)
+            {
+                __NSTD_WARNING("warn " << i);
+            }
+            else { __NSTD_ERROR("error " << i); }
+        }
+        out << "[nstd(Info)] dir:a/b.cpp:12:7. with a column\r\n";
+        out << "[nstd(Info)] b.cpp:x. not a location\n";
+        std::cerr.rdbuf(cerr_buf);
+    }
+
+    auto mapped = nstd::MappedFile::map(path);
+    assert(mapped.is_ok());
+    const nstd::MappedFile& file = mapped.unwrap();
+    std::vector<nstd::LogRecord> records = nstd::LogParser(4).parse(file.view());
+    assert(records.size() == 1002);
+    for(int i = 0; i < 1000; ++i)
+    {
+        const nstd::LogRecord& rec = records[std::size_t(i)];
+        if(i % 10 == 9)
+        {
+            assert(rec.level == nstd::LogType::LOG_NON && rec.file.empty());
+            assert(rec.message == "plain line " + std::to_string(i));
+            continue;
+        }
+        bool warn = i % 2 == 0;
+        assert(rec.level == (warn ? nstd::LogType::LOG_WARN : nstd::LogType::LOG_ERROR));
+        assert(rec.file == __FILE__ && rec.column == 0);
+        assert(rec.line == (warn ? first_line : first_line + 2));
+        assert(rec.message == (warn ? "warn " : "error ") + std::to_string(i));
+    }
+    const nstd::LogRecord& col = records[1000];
+    assert(col.level == nstd::LogType::LOG_INFO && col.file == "dir:a/b.cpp");
+    assert(col.line == 12 && col.column == 7 && col.message == "with a column");
+    assert(records[1001].level == nstd::LogType::LOG_NON);
+
+    // The chunked parse sees the same records, every chunk in the order of the text.
+    std::vector<std::vector<nstd::LogRecord>> chunks(4);
+    nstd::LogParser(4).parse_chunks(file.view(),
+                                    [&](std::size_t i, const std::vector<nstd::LogRecord>& recs) {
+                                        chunks[i] = recs;
+                                    });
+    std::size_t n = 0;
+    for(const auto& chunk : chunks)
+    {
+        for(const auto& rec : chunk) { assert(rec.message == records[n++].message); }
+    }
+    assert(n == records.size());
+    std::remove(path.c_str());
+    std::cout << records.size() << std::endl;
+}
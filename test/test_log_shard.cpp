@@ -0,0 +1,117 @@
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+#include "../lib/include/log_shard.hpp"
+
+int main()
+{
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "nstd_test_log_shard";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    constexpr int THREADS = 4;
+    constexpr int RECORDS = 2000;
+    {
+        // Two loggers on the same dir and prefix, each with its own shards.
+        nstd::ShardedFileLogger logger(dir.string(), "app", ~0u, 4096);
+        nstd::ShardedFileLogger other(dir.string(), "app");
+        std::vector<std::thread> threads;
+        for(int t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for(int i = 0; i < RECORDS; ++i)
+                {
+                    NSTD_LOGGER_INFO(logger, "t" << t << " r" << i);
+                    if(i % 100 == 0)
+                    {
+                        NSTD_LOG_SCOPE_CTX("t", t);
+                        NSTD_LOGGER_WARN(other, "other");
+                    }
+                }
+                // A record larger than the buffer is written through.
+                NSTD_LOGGER_ERROR(logger, "t" << t << " " << std::string(5000, 'x'));
+            });
+        }
+        for(auto& th : threads) { th.join(); }  // The shards are flushed at thread exit.
+    }
+
+    std::vector<std::string> paths = nstd::list_shards(dir.string(), "app");
+    assert(paths.size() == 2 * THREADS);
+    auto merger = nstd::ShardMerger::open(paths);
+    assert(merger.is_ok());
+    nstd::ShardRecord rec;
+    std::uint64_t last = 0;
+    std::map<std::uint32_t, std::uint64_t> next_seq;
+    std::set<std::uint32_t> shards;
+    std::map<std::string, int> next_record;  // per thread of the first logger
+    int others = 0, large = 0;
+    while(merger.unwrap().next(rec))
+    {
+        assert(rec.timestamp >= last);
+        last = rec.timestamp;
+        shards.insert(rec.shard);
+        nstd::LogRecord line = nstd::parse_log_line(rec.payload.substr(0, rec.payload.size() - 1));
+        assert(line.level == rec.level && line.file == __FILE__ && line.line > 0);
+        if(line.level == nstd::LogType::LOG_WARN)
+        {
+            // The context is rendered before the message.
+            assert(line.message.size() == 11 && line.message.substr(0, 3) == "[t=");
+            assert(line.message.substr(4) == "] other");
+            ++others;
+            continue;
+        }
+        // In a shard, the sequence numbers follow the time order.
+        assert(rec.seq == next_seq[rec.shard]++);
+        std::string thread(line.message.substr(0, line.message.find(' ')));
+        if(line.level == nstd::LogType::LOG_ERROR)
+        {
+            assert(line.message.size() == thread.size() + 1 + 5000);
+            ++large;
+            continue;
+        }
+        int expected = next_record[thread]++;
+        assert(line.message.substr(thread.size() + 1) == "r" + std::to_string(expected));
+    }
+    assert(others == THREADS * RECORDS / 100 && large == THREADS);
+    assert(next_record.size() == std::size_t(THREADS));
+    // The shards of both loggers are told apart.
+    assert(shards.size() == paths.size());
+    for(const auto& [thread, n] : next_record) { assert(n == RECORDS); }
+
+    assert(nstd::ShardReader::open((dir / "missing.nlog").string()).is_err());
+
+#if defined(__linux__)
+    // A shard which can't be written fails the log, as a full disk would.
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit old_limit;
+    getrlimit(RLIMIT_FSIZE, &old_limit);
+    rlimit small   = old_limit;
+    small.rlim_cur = 1 << 16;
+    setrlimit(RLIMIT_FSIZE, &small);
+    nstd::ShardedFileLogger full(dir.string(), "full", ~0u, 4096);
+    nstd::LogResult result = nstd::LogResult::ok();
+    for(int i = 0; i < 100 && result.is_ok(); ++i)
+    {
+        nstd::LogMetaData md(NSTD_INFO, __FILE__, __LINE__, "main");
+        std::stringstream().swap(full.get_buf());
+        full.get_buf() << std::string(1000, 'x') << '\n';
+        result = full.log(std::move(md));
+    }
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    assert(result.is_err() && result.unwrap_err() == nstd::Errc::IO_ERROR);
+#endif
+    fs::remove_all(dir);
+    std::cout << paths.size() << std::endl;
+}
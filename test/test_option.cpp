@@ -0,0 +1,46 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "../lib/include/option.hpp"
+
+enum class Handle : unsigned int
+{
+    INVALID = ~0u,
+};
+
+template <>
+struct nstd::niche_traits<Handle> : nstd::niche_value<Handle, Handle::INVALID> {};
+
+int main()
+{
+    static_assert(sizeof(nstd::Option<nstd::NotNull<int*>>) == sizeof(int*));
+    static_assert(sizeof(nstd::Option<int&>) == sizeof(int*));
+    static_assert(sizeof(nstd::Option<Handle>) == sizeof(Handle));
+    static_assert(std::is_trivially_copyable_v<nstd::Option<int>>);
+    static_assert(std::is_trivially_copyable_v<nstd::Option<nstd::NotNull<int*>>>);
+    static_assert(nstd::Option<int>::some(3).unwrap() == 3);
+    static_assert(nstd::Option<int>().is_none());
+
+    int x = 1;
+    nstd::Option<nstd::NotNull<int*>> p;
+    assert(p.is_none() && p.status() == nstd::OptionStatus::NONE);
+    p = nstd::Option<nstd::NotNull<int*>>::some(&x);
+    assert(p.is_some() && *p.unwrap() == 1);
+
+    nstd::Option<int&> r = nstd::Some<int&>(x);
+    r.unwrap() = 2;
+    assert(x == 2);
+    assert(nstd::Option<int&>(nstd::None{}).is_none());
+
+    nstd::Option<Handle> h = nstd::Some<Handle>(Handle(7));
+    assert(h.is_some() && h.unwrap() == Handle(7));
+    assert(nstd::Option<Handle>::none().is_none());
+
+    auto s = nstd::Option<std::string>::some(3, 'a');
+    std::string moved = std::move(s).unwrap();
+    assert(moved == "aaa");
+    std::cout << sizeof(nstd::Option<int*>) << " " << sizeof(nstd::Option<nstd::NotNull<int*>>)
+              << std::endl;
+}
@@ -0,0 +1,79 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/option_vec.hpp"
+
+int main()
+{
+    nstd::OptionVec<int> v;
+    std::vector<nstd::Option<int>> rows;
+    // 200 elements, every third None, so some words are full and some are partial.
+    for(int i = 0; i < 200; ++i)
+    {
+        if(i % 3 == 0 && i < 128) { v.push_back(nstd::None{}); }
+        else { v.push_back(i); }
+        rows.push_back(v[std::size_t(i)].map([](const int& x) { return x; }));
+    }
+    assert(v.size() == 200 && v.count_some() + v.count_none() == 200);
+    std::size_t some = 0;
+    for(const auto& row : rows) { some += row.is_some() ? 1 : 0; }
+    assert(v.count_some() == some && v.count_none() == 43);
+    assert(v.is_none(0) && v[1].unwrap() == 1 && v[150].unwrap() == 150 && v.values()[0] == 0);
+    nstd::OptionVec<int> from_rows;
+    for(const auto& row : rows) { from_rows.push_back(row); }
+    assert(from_rows.count_some() == some && from_rows[150].unwrap() == 150);
+
+    // The views refer to the column.
+    v[1].unwrap() = 11;
+    assert(v.values()[1] == 11);
+    v.set(0, 7);
+    v.set(1, nstd::None{});
+    assert(v[0].unwrap() == 7 && v[1].is_none() && v.values()[1] == 0);
+
+    int calls = 0;
+    auto squared = v.map([&](int x) {
+        ++calls;
+        return std::to_string(x * x);
+    });
+    assert(calls == int(v.count_some()) && squared.count_some() == v.count_some());
+    assert(squared[0].unwrap() == "49" && squared[1].is_none() && squared[199].unwrap() == "39601");
+
+    auto even = v.filter([](int x) { return x % 2 == 0; });
+    assert(even.count_some() == even.size());
+    int expected = 0;
+    v.for_each_some([&](std::size_t i, int x) {
+        assert(v.is_some(i));
+        if(x % 2 == 0) { assert(even[std::size_t(expected++)].unwrap() == x); }
+    });
+    assert(std::size_t(expected) == even.size());
+    auto large = squared.filter([](const std::string& s) { return s.size() > 4; });
+    assert(large.size() == 91 && large[0].unwrap() == "10000");
+
+    auto picked = v.gather({199, 1, 3, 0, 64});
+    assert(picked.size() == 5 && picked.count_some() == 3);
+    assert(picked[0].unwrap() == 199 && picked[1].is_none() && picked[2].is_none());
+    assert(picked[3].unwrap() == 7 && picked[4].unwrap() == 64);
+
+    // Bools are held a byte each, their elements can be referred to.
+    nstd::OptionVec<bool> flags;
+    for(int i = 0; i < 70; ++i)
+    {
+        if(i % 5 == 0) { flags.push_back(nstd::None{}); }
+        else { flags.push_back(i % 2 == 0); }
+    }
+    assert(flags.count_some() == 56 && flags[2].unwrap() && !flags[3].unwrap());
+    flags[3].unwrap() = true;
+    assert(flags.values()[3] && flags[0].is_none() && !flags.values()[0]);
+    auto set_flags = flags.filter([](bool b) { return b; });
+    assert(set_flags.size() == 29 && set_flags.count_some() == 29);
+    auto negated = flags.map([](bool b) { return !b; });
+    assert(negated[2].unwrap() == false && negated[5].is_none());
+    assert(flags.gather({3, 5})[0].unwrap() && flags.memory_bytes() < 70 * sizeof(int));
+
+    nstd::OptionVec<int> none(70);
+    assert(none.count_some() == 0 && none.map([](int x) { return x; }).count_some() == 0);
+    std::cout << v.memory_bytes() << " " << rows.capacity() * sizeof(nstd::Option<int>)
+              << std::endl;
+}
@@ -0,0 +1,34 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "../lib/include/process.hpp"
+
+int main()
+{
+    nstd::ProcessResult ok = nstd::run_process({"sh", "-c", "echo out; echo err >&2"});
+    assert(ok.started && ok.exit_code == 0 && ok.signal == 0 && !ok.timed_out);
+    assert(ok.output == "out\nerr\n");
+
+    nstd::ProcessResult failed = nstd::run_process({"sh", "-c", "exit 3"});
+    assert(failed.started && failed.exit_code == 3);
+
+    nstd::ProcessResult killed = nstd::run_process({"sh", "-c", "kill -9 $$"});
+    assert(killed.exit_code == -1 && killed.signal == 9 && !killed.timed_out);
+
+    nstd::ProcessResult missing = nstd::run_process({"/nonexistent/nstd_process"});
+    assert(!missing.started && missing.output.find("Start /nonexistent/nstd_process") == 0);
+    assert(!nstd::run_process({}).started);
+
+    // Killed at the deadline, with the grandchild still holding the pipe for a while.
+    nstd::ProcessResult hung = nstd::run_process({"sh", "-c", "sleep 30 & sleep 30"}, 0.5);
+    assert(hung.timed_out && hung.signal == 9 && hung.exit_code == -1);
+    assert(hung.seconds >= 0.5 && hung.seconds < 5);
+
+#ifdef __linux__
+    // The child has its stdio and the directory ls reads, the capture pipe isn't inherited.
+    nstd::ProcessResult fds = nstd::run_process({"ls", "/proc/self/fd"});
+    assert(fds.exit_code == 0 && fds.output == "0\n1\n2\n3\n");
+#endif
+    std::cout << hung.seconds << std::endl;
+}
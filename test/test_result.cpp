@@ -0,0 +1,129 @@
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "../lib/include/result.hpp"
+
+enum class ErrCode
+{
+    NOT_FOUND = 1,
+    DENIED,
+};
+
+using R = nstd::Result<int, ErrCode>;
+
+// Counts its copies, a payload going through a chain must only be moved.
+struct Payload {
+    static inline int copies = 0;
+    std::string data;
+    explicit Payload(std::string d) : data(std::move(d)) {}
+    Payload(const Payload& o) : data(o.data) { ++copies; }
+    Payload(Payload&&) noexcept = default;
+    Payload& operator=(const Payload& o)
+    {
+        ++copies;
+        data = o.data;
+        return *this;
+    }
+    Payload& operator=(Payload&&) noexcept = default;
+};
+
+using PR = nstd::Result<Payload, std::string>;
+
+PR load(bool fail)
+{
+    if(fail) { return PR::err("load failed"); }
+    return PR::ok(std::string(64, 'p'));
+}
+
+PR check(bool fail)
+{
+    NSTD_TRY(payload, load(fail));
+    payload.data += '!';
+    return PR::ok(std::move(payload));
+}
+
+nstd::Result<std::size_t, std::string> measure(bool fail)
+{
+    NSTD_TRY(payload, check(fail));
+    return nstd::Result<std::size_t, std::string>::ok(payload.data.size());
+}
+
+nstd::Option<int> half(int x)
+{
+    if(x % 2 != 0) { return nstd::None{}; }
+    return nstd::Option<int>::some(x / 2);
+}
+
+nstd::Option<int> quarter(int x)
+{
+    NSTD_TRY(h, half(x));
+    return half(h);
+}
+
+constexpr R parse_digit(char c)
+{
+    if(c < '0' || c > '9') { return R::err(ErrCode::NOT_FOUND); }
+    return R::ok(c - '0');
+}
+
+int main()
+{
+    static_assert(sizeof(R) == sizeof(std::pair<int, ErrCode>));
+    static_assert(std::is_trivially_copyable_v<R>);
+    static_assert(std::is_trivially_destructible_v<R>);
+    static_assert(std::is_trivially_copyable_v<nstd::ResultOmitOk<ErrCode>>);
+    static_assert(!std::is_trivially_copyable_v<nstd::Result<std::string, int>>);
+    static_assert(parse_digit('7').unwrap() == 7);
+    static_assert(parse_digit('x').unwrap_err() == ErrCode::NOT_FOUND);
+    static_assert(parse_digit('x').status() == nstd::ResultStatus::ERR);
+
+    R r = R::err(ErrCode::DENIED);
+    assert(r.is_err() && r.unwrap_err() == ErrCode::DENIED);
+    r = R::ok(3);
+    assert(r.is_ok() && r.unwrap() == 3);
+    R copy = r;
+    assert(copy.status() == nstd::ResultStatus::OK && copy.unwrap() == 3);
+
+    // A copy of a non-const Ok is a copy, not an Ok of an Ok.
+    nstd::Ok<int> ok(5);
+    nstd::Ok<int> ok_copy(ok);
+    assert(*ok_copy == 5);
+
+    auto s = nstd::Result<std::string, int>::ok(3, 'a');
+    std::string moved = std::move(s).unwrap();
+    assert(moved == "aaa");
+    assert(nstd::ResultOmitOk<std::string>::ok().is_ok());
+
+    static_assert(parse_digit('4').map([](int d) { return d * 2; }).unwrap() == 8);
+    static_assert(parse_digit('x').unwrap_or(-1) == -1);
+    static_assert(parse_digit('x').value_or_else([](ErrCode e) { return -int(e); }) == -1);
+    static_assert(parse_digit('x')
+                      .or_else([](ErrCode) { return R::ok(0); })
+                      .and_then([](int d) { return parse_digit(char('1' + d)); })
+                      .unwrap() == 1);
+    static_assert(parse_digit('x').map_err([](ErrCode e) { return int(e); }).unwrap_err() == 1);
+
+    assert(measure(false).unwrap() == 65);
+    assert(measure(true).unwrap_err() == "load failed");
+    std::size_t size = load(false)
+                           .map([](Payload&& p) { return Payload(std::move(p.data) + "?"); })
+                           .and_then([](Payload&& p) { return PR::ok(std::move(p)); })
+                           .map([](Payload&& p) { return p.data.size(); })
+                           .unwrap_or(std::size_t(0));
+    assert(size == 65);
+    assert(Payload::copies == 0);
+    PR kept = load(false);
+    assert(kept.map([](const Payload& p) { return p.data.size(); }).unwrap() == 64);
+    assert(kept.is_ok() && Payload::copies == 0);
+
+    assert(quarter(8).unwrap() == 2);
+    assert(quarter(6).is_none() && quarter(3).is_none());
+    assert(half(4).map([](int h) { return h + 1; }).unwrap() == 3);
+    assert(half(3).or_else([] { return nstd::Option<int>::some(0); }).unwrap() == 0);
+    assert(half(3).value_or_else([] { return -1; }) == -1);
+    assert(half(4).and_then(half).unwrap_or(-1) == 1);
+    std::cout << sizeof(R) << " " << sizeof(nstd::Result<std::string, int>) << std::endl;
+}
@@ -0,0 +1,31 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../lib/include/stress.hpp"
+
+int main()
+{
+    assert(nstd::jain_fairness({5, 5, 5, 5}) == 1);
+    assert(nstd::jain_fairness({8, 0, 0, 0}) == 0.25);
+
+    nstd::StressOptions options;
+    options.seconds          = 0.1;
+    options.interval_seconds = 0.05;
+    options.pin              = false;
+    nstd::StressRunner runner(options);
+    // The op is long against the step: the one still running at the end is in the ops, and must
+    // be in the time as well.
+    const double op       = 0.03;
+    nstd::StressFunc func = [] { std::this_thread::sleep_for(std::chrono::milliseconds(30)); };
+    for(unsigned int threads : {1u, 2u})
+    {
+        nstd::StressStep step = runner.run_step(func, threads);
+        assert(step.threads == threads && step.thread_ops.size() == threads);
+        assert(step.timeline.size() == 2);
+        assert(step.seconds >= options.seconds);
+        assert(step.ops_per_sec <= threads / op);
+        std::cout << step.ops << " ops in " << step.seconds << " s" << std::endl;
+    }
+}
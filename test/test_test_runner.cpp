@@ -0,0 +1,147 @@
+#define NSTD_TEST
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../lib/include/test_runner.hpp"
+
+UTEST(runner, passes) {}
+
+UTEST(runner, throws) { throw std::runtime_error("boom"); }
+
+ITEST(runner, integration) {}
+
+// The name of a group already registered, it's ignored.
+TEST(runner, [[utest(from_text)]] void from_text() {})
+
+// Only run isolated: they take the whole process down.
+UTEST(isolated, slow) { std::this_thread::sleep_for(std::chrono::milliseconds(300)); }
+
+UTEST(isolated, hangs) { std::this_thread::sleep_for(std::chrono::seconds(60)); }
+
+UTEST(isolated, aborts) { std::abort(); }
+
+namespace fs = std::filesystem;
+
+void write(const fs::path& path, const std::string& text)
+{
+    std::ofstream out(path, std::ios::trunc);
+    out << text;
+}
+
+// The "state" group is hashed by a file of its own, so a test can change it.
+bool flaky_fails = true;
+
+void flaky()
+{
+    if(flaky_fails) { throw std::runtime_error("flaky"); }
+}
+
+const nstd::TestCaseResult& result_of(const nstd::TestRunSummary& s, const std::string& id)
+{
+    for(const auto& r : s.results)
+    {
+        if(r.id == id) { return r; }
+    }
+    assert(false);
+    std::abort();
+}
+
+nstd::TestRunOptions options(const std::string& filter)
+{
+    nstd::TestRunOptions o;
+    o.jobs       = 2;
+    o.filter     = filter;
+    o.timing_db  = "";
+    o.state_file = "";
+    return o;
+}
+
+int main(int argc, char** argv)
+{
+    // The isolated cases are run by this executable again.
+    if(argc > 1) { return nstd::test_main(argc, argv); }
+
+    std::ostringstream out;
+    nstd::TestRunSummary s = nstd::TestRunner(options("runner::")).run(out);
+    assert(s.passed == 2 && s.failed == 1 && s.skipped == 0);
+    assert(result_of(s, "runner::passes").outcome == nstd::TestOutcome::PASSED);
+    assert(result_of(s, "runner::throws").message == "boom");
+    assert(out.str().find("[ FAILED  ] runner::throws") != std::string::npos);
+
+    nstd::TestRunOptions unit = options("runner::");
+    unit.integration_test     = false;
+    s                         = nstd::TestRunner(unit).run(out);
+    assert(s.results.size() == 2 && s.failed == 1);
+
+    nstd::TestRunOptions iso = options("");
+    iso.isolate              = true;
+    iso.timeout              = 2;
+    s                        = nstd::TestRunner(iso).run(out);
+    assert(s.passed == 3 && s.failed == 3);
+    const auto& thrown = result_of(s, "runner::throws");
+    assert(thrown.message.find("Exit with code 1.") == 0);
+    assert(thrown.message.find("boom") != std::string::npos);
+    assert(result_of(s, "isolated::aborts").message.find("Killed by signal") == 0);
+    const auto& hung = result_of(s, "isolated::hangs");
+    assert(hung.outcome == nstd::TestOutcome::FAILED);
+    assert(hung.message.find("Timed out after 2s.") == 0);
+    assert(hung.seconds < 10);
+    // Run next to the hanging case, it isn't held up by it.
+    const auto& slow = result_of(s, "isolated::slow");
+    assert(slow.outcome == nstd::TestOutcome::PASSED && slow.seconds < 1.5);
+
+    // Only the groups which changed or failed last time run again.
+    const fs::path dir = fs::temp_directory_path() / "nstd_test_test_runner";
+    const fs::path src = dir / "state.cpp";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    write(src, "1");
+    nstd::TestGroup group("state", src.string());
+    group.add_case(nstd::TestKind::UNIT_TEST, "ok", [] {});
+    group.add_case(nstd::TestKind::UNIT_TEST, "flaky", &flaky);
+    assert(nstd::TestGroupManager::get_obj().add_test_group(std::move(group)).is_ok());
+    nstd::TestRunOptions inc = options("state::");
+    inc.state_file           = (dir / "state").string();
+    s                        = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 1 && s.failed == 1 && s.unchanged == 0);
+    flaky_fails = false;
+    s           = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 2 && s.unchanged == 0);
+    s = nstd::TestRunner(inc).run(out);
+    assert(s.results.empty() && s.unchanged == 2);
+    write(src, "2");
+    s = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 2 && s.unchanged == 0);
+    inc.all = true;
+    s       = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 2 && s.unchanged == 0);
+    inc.all = false;
+    s       = nstd::TestRunner(inc).run(out);
+    assert(s.results.empty() && s.unchanged == 2);
+
+    // A TEST group depends on the headers its file includes, not only on its code.
+    write(dir / "tested.hpp", "int f();");
+    write(dir / "text.cpp", "#include \"tested.hpp\"\nTEST(text, [[utest(ok)]] void ok() {})\n");
+    nstd::TestGroup text("text", (dir / "text.cpp").string());
+    text.add_case(nstd::TestKind::UNIT_TEST, "ok", [] {});
+    text.set_code("[[utest(ok)]] void ok() {}");
+    assert(nstd::TestGroupManager::get_obj().add_test_group(std::move(text)).is_ok());
+    inc.filter = "text::";
+    s          = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 1 && s.unchanged == 0);
+    s = nstd::TestRunner(inc).run(out);
+    assert(s.results.empty() && s.unchanged == 1);
+    write(dir / "tested.hpp", "int f(int);");
+    s = nstd::TestRunner(inc).run(out);
+    assert(s.passed == 1 && s.unchanged == 0);
+    fs::remove_all(dir);
+    std::cout << s.wall_seconds << std::endl;
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <type_traits>
+#include <variant>
+
+#include "../lib/include/type_list.hpp"
+
+using nstd::type_list;
+
+struct Abstract {
+    virtual void f() = 0;
+};
+
+using L = type_list<int, char, int, double, char, float>;
+static_assert(nstd::type_list_size_v<L> == 6);
+static_assert(std::is_same_v<nstd::type_list_at_t<L, 3>, double>);
+static_assert(nstd::type_list_find_v<L, double> == 3);
+static_assert(nstd::type_list_find_v<L, char> == 1);  // repeated
+static_assert(nstd::type_list_find_v<L, long> == 6);  // missing
+static_assert(nstd::type_list_contains_v<L, float> && !nstd::type_list_contains_v<L, long>);
+static_assert(std::is_same_v<nstd::type_list_unique_t<L>, type_list<int, char, double, float>>);
+static_assert(std::is_same_v<nstd::type_list_unique_t<type_list<>>, type_list<>>);
+static_assert(std::is_same_v<nstd::type_list_concat_t<>, type_list<>>);
+static_assert(std::is_same_v<nstd::type_list_concat_t<type_list<int>,
+                                                      type_list<>,
+                                                      type_list<char>,
+                                                      type_list<long>,
+                                                      type_list<int, float>>,
+                             type_list<int, char, long, int, float>>);
+static_assert(std::is_same_v<nstd::type_list_apply_t<std::variant, nstd::type_list_unique_t<L>>,
+                             std::variant<int, char, double, float>>);
+
+using M = type_list<void(), int[3], Abstract, int, void()>;
+static_assert(std::is_same_v<nstd::type_list_at_t<M, 0>, void()>);
+static_assert(std::is_same_v<nstd::type_list_at_t<M, 2>, Abstract>);
+static_assert(nstd::type_list_find_v<M, void()> == 0 && nstd::type_list_find_v<M, int> == 3);
+static_assert(
+    std::is_same_v<nstd::type_list_unique_t<M>, type_list<void(), int[3], Abstract, int>>);
+
+int main() { std::cout << nstd::type_list_size_v<nstd::type_list_unique_t<L>> << std::endl; }
@@ -0,0 +1,61 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../lib/include/log_shard.hpp"
+
+// Usage: nstd_log_merge [--stamp] <dir> <prefix>
+//        nstd_log_merge [--stamp] --files <shard>...
+// Merge the shards written by ShardedFileLogger into one time ordered log on stdout. With --stamp,
+// every line is prefixed with "<timestamp ns> <shard> <seq> ".
+
+namespace {
+void usage()
+{
+    std::cerr << "Usage: nstd_log_merge [--stamp] <dir> <prefix>\n"
+                 "       nstd_log_merge [--stamp] --files <shard>...\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    bool stamp = false;
+    bool files = false;
+    std::vector<std::string> args;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--stamp") == 0) { stamp = true; }
+        else if(std::strcmp(argv[i], "--files") == 0) { files = true; }
+        else { args.emplace_back(argv[i]); }
+    }
+    std::vector<std::string> paths;
+    if(files) { paths = args; }
+    else if(args.size() == 2) { paths = nstd::list_shards(args[0], args[1]); }
+    else
+    {
+        usage();
+        return 2;
+    }
+    if(paths.empty())
+    {
+        std::cerr << "No log shard found.\n";
+        return 1;
+    }
+
+    auto merger = nstd::ShardMerger::open(paths);
+    if(merger.is_err())
+    {
+        std::cerr << merger.unwrap_err() << "\n";
+        return 1;
+    }
+    nstd::ShardMerger& m = merger.unwrap();
+    std::ios::sync_with_stdio(false);
+    nstd::ShardRecord rec;
+    while(m.next(rec))
+    {
+        if(stamp) { std::cout << rec.timestamp << ' ' << rec.shard << ' ' << rec.seq << ' '; }
+        std::cout << rec.payload;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "../lib/include/log_parser.hpp"
+
+// Usage: nstd_log_parse [-j jobs] [--print] [--level Warn] <file>
+// Without --print, only the count of records per level and the parse speed are reported.
+
+namespace {
+void usage()
+{
+    std::cerr << "Usage: nstd_log_parse [-j jobs] [--print] [--level <Level>] <file>\n";
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned int jobs = 0;
+    bool print        = false;
+    std::string level_name;
+    std::string path;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            jobs = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(std::strcmp(argv[i], "--print") == 0) { print = true; }
+        else if(std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) { level_name = argv[++i]; }
+        else if(argv[i][0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else { path = argv[i]; }
+    }
+    if(path.empty())
+    {
+        usage();
+        return 2;
+    }
+    unsigned int level = nstd::LogType::LOG_NON;
+    if(!level_name.empty())
+    {
+        level = nstd::parse_log_line("[nstd(" + level_name + ")] x:1. ").level;
+        if(level == nstd::LogType::LOG_NON)
+        {
+            std::cerr << "Unknown level " << level_name << ".\n";
+            return 2;
+        }
+    }
+
+    auto mapped = nstd::MappedFile::map(path);
+    if(mapped.is_err())
+    {
+        std::cerr << mapped.unwrap_err() << "\n";
+        return 1;
+    }
+    const nstd::MappedFile& file = mapped.unwrap();
+    nstd::LogParser parser(jobs);
+    auto start   = std::chrono::steady_clock::now();
+    auto records = parser.parse(file.view());
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t counts[9] = {};
+    for(const auto& r : records)
+    {
+        if(level != nstd::LogType::LOG_NON && r.level != level) { continue; }
+        std::size_t idx = 0;
+        for(unsigned int m = r.level; m != 0; m >>= 1) { ++idx; }
+        ++counts[idx < 9 ? idx : 0];
+        if(print)
+        {
+            std::cout << r.level << '\t' << r.file << '\t' << r.line << '\t' << r.message << '\n';
+        }
+    }
+    const char* names[9] = {
+        "Non", "Trace", "Debug", "Info", "Warn", "Error", "Fatal", "Perf", "Func"};
+    for(std::size_t i = 0; i < 9; ++i)
+    {
+        if(counts[i] != 0) { std::cerr << names[i] << ": " << counts[i] << "\n"; }
+    }
+    std::cerr << records.size() << " lines, " << file.size() << " bytes in " << elapsed << "s ("
+              << (elapsed > 0 ? double(file.size()) / elapsed / 1e9 : 0.0) << " GB/s, "
+              << parser.jobs() << " jobs)\n";
+    return 0;
+}